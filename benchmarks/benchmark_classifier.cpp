@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include "decision_tree/algorithm/decision_tree_classifier.hpp"
+#include "synthetic_data.hpp"
+
+namespace {
+
+const std::vector<std::string> split_policies = {"best", "hist"};
+
+// arguments of the end-to-end benchmarks: number of samples, number of 
+// features, number of classes, number of outputs, percent of missing 
+// values, index of the split policy
+void fit_predict_arguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"rows", "features", "classes", "outputs", "missing", "policy"});
+    benchmark->ArgsProduct({{1 << 14, 1 << 17}, {10, 50}, {2}, {1}, {0}, {0, 1}});
+    benchmark->ArgsProduct({{1 << 17}, {10}, {10}, {1, 4}, {0, 10}, {0, 1}});
+    benchmark->Unit(benchmark::kMillisecond);
+    benchmark->UseRealTime();
+}
+
+decisiontree::DecisionTreeClassifier make_classifier(const benchmarks::SyntheticData& data, 
+                                                     const std::string& split_policy) {
+    return decisiontree::DecisionTreeClassifier(data.feature_names, data.class_labels, 
+                                                0, 10, -1, 2, 1, 0.0, true, 
+                                                "gini", split_policy);
+}
+
+benchmarks::SyntheticData make_data(const benchmark::State& state) {
+    return benchmarks::make_synthetic_data(state.range(0), state.range(1), 
+                                           state.range(2), state.range(3), 
+                                           state.range(4) / 100.0);
+}
+
+void BM_Fit(benchmark::State& state) {
+    benchmarks::SyntheticData data = make_data(state);
+    const std::string& split_policy = split_policies[state.range(5)];
+    for (auto _ : state) {
+        decisiontree::DecisionTreeClassifier clf = make_classifier(data, split_policy);
+        clf.fit(data.X, data.y);
+        benchmark::DoNotOptimize(clf.get_tree().get_node_count());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Fit)->Apply(fit_predict_arguments);
+
+void BM_Predict(benchmark::State& state) {
+    benchmarks::SyntheticData data = make_data(state);
+    decisiontree::DecisionTreeClassifier clf = make_classifier(data, split_policies[state.range(5)]);
+    clf.fit(data.X, data.y);
+    unsigned long num_samples = state.range(0);
+    std::vector<long> y(num_samples * state.range(3));
+    for (auto _ : state) {
+        clf.predict(data.X.data(), num_samples, y.data());
+        benchmark::DoNotOptimize(y.data());
+    }
+    state.SetItemsProcessed(state.iterations() * num_samples);
+}
+BENCHMARK(BM_Predict)->Apply(fit_predict_arguments);
+
+} // namespace
@@ -0,0 +1,63 @@
+#include <random>
+#include <benchmark/benchmark.h>
+
+#include "decision_tree/core/criterion/gini.hpp"
+#include "decision_tree/core/criterion/entropy.hpp"
+
+namespace {
+
+std::vector<double> make_histogram(unsigned long num_classes) {
+    std::mt19937 engine(0);
+    std::uniform_real_distribution<double> uniform(0.0, 100.0);
+    std::vector<double> histogram(num_classes);
+    for (double& count : histogram) {
+        count = uniform(engine);
+    }
+    return histogram;
+}
+
+template<typename CriterionType>
+void BM_ComputeImpurity(benchmark::State& state) {
+    unsigned long num_classes = state.range(0);
+    std::vector<double> histogram = make_histogram(num_classes);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CriterionType::compute_impurity(histogram.data(), num_classes));
+    }
+}
+BENCHMARK_TEMPLATE(BM_ComputeImpurity, decisiontree::Gini)->RangeMultiplier(4)->Range(2, 256);
+BENCHMARK_TEMPLATE(BM_ComputeImpurity, decisiontree::Entropy)->RangeMultiplier(4)->Range(2, 256);
+
+// scan all the thresholds of a node of num_samples samples, one sample 
+// moves from the right child to the left child at each threshold
+template<typename CriterionType>
+void BM_UpdateChildrenHistogram(benchmark::State& state) {
+    unsigned long num_samples = state.range(0);
+    unsigned long num_classes = state.range(1);
+    std::mt19937 engine(0);
+    std::uniform_int_distribution<long> uniform(0, num_classes - 1);
+    std::vector<long> y(num_samples);
+    for (long& label : y) {
+        label = uniform(engine);
+    }
+    std::vector<unsigned long> sample_indices(num_samples);
+    std::iota(sample_indices.begin(), sample_indices.end(), 0);
+
+    CriterionType criterion(1, num_samples, num_classes, {num_classes}, std::vector<double>(num_classes, 1.0));
+    criterion.compute_node_histogram(y, sample_indices, 0, num_samples);
+    criterion.compute_node_impurity();
+    for (auto _ : state) {
+        criterion.init_children_histogram();
+        for (unsigned long i = 1; i < num_samples; ++i) {
+            criterion.update_children_histogram(y, sample_indices, i);
+            criterion.compute_children_impurity();
+            benchmark::DoNotOptimize(criterion.compute_impurity_improvement());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (num_samples - 1));
+}
+BENCHMARK_TEMPLATE(BM_UpdateChildrenHistogram, decisiontree::Gini)
+    ->ArgsProduct({{1 << 10, 1 << 16}, {2, 10, 100}});
+BENCHMARK_TEMPLATE(BM_UpdateChildrenHistogram, decisiontree::Entropy)
+    ->ArgsProduct({{1 << 10, 1 << 16}, {2, 10, 100}});
+
+} // namespace
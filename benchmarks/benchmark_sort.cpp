@@ -0,0 +1,54 @@
+#include <random>
+#include <benchmark/benchmark.h>
+
+#include "decision_tree/utility/sort.hpp"
+
+namespace {
+
+// sort a feature column of num_samples values with its sample indices, 
+// the unsorted column is copied back at each iteration
+void BM_Sort(benchmark::State& state) {
+    std::size_t num_samples = state.range(0);
+    std::mt19937 engine(0);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<double> values(num_samples);
+    for (double& value : values) {
+        value = normal(engine);
+    }
+
+    std::vector<double> x(num_samples);
+    std::vector<unsigned long> indices(num_samples);
+    decisiontree::SortBuffer<double, unsigned long> buffer;
+    for (auto _ : state) {
+        std::copy(values.begin(), values.end(), x.begin());
+        std::iota(indices.begin(), indices.end(), 0);
+        decisiontree::sort(x, indices, 0, num_samples, buffer);
+        benchmark::DoNotOptimize(x.data());
+    }
+    state.SetItemsProcessed(state.iterations() * num_samples);
+}
+BENCHMARK(BM_Sort)->RangeMultiplier(8)->Range(16, 1 << 20);
+
+// the same column with std::sort on pairs, the baseline of BM_Sort
+void BM_SortPairs(benchmark::State& state) {
+    std::size_t num_samples = state.range(0);
+    std::mt19937 engine(0);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<double> values(num_samples);
+    for (double& value : values) {
+        value = normal(engine);
+    }
+
+    std::vector<double> x(num_samples);
+    std::vector<unsigned long> indices(num_samples);
+    for (auto _ : state) {
+        std::copy(values.begin(), values.end(), x.begin());
+        std::iota(indices.begin(), indices.end(), 0);
+        decisiontree::sort(x, indices, 0, num_samples);
+        benchmark::DoNotOptimize(x.data());
+    }
+    state.SetItemsProcessed(state.iterations() * num_samples);
+}
+BENCHMARK(BM_SortPairs)->RangeMultiplier(8)->Range(16, 1 << 20);
+
+} // namespace
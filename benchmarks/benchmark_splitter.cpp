@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include "decision_tree/core/splitter.hpp"
+#include "synthetic_data.hpp"
+
+namespace {
+
+const std::vector<std::string> split_policies = {"best", "random", "hist"};
+
+// split the root node of num_samples samples on all the features, 
+// the lookup tables of init_features are built once outside the loop
+void BM_SplitNode(benchmark::State& state) {
+    unsigned long num_samples = state.range(0);
+    unsigned long num_features = state.range(1);
+    unsigned long num_classes = state.range(2);
+    const std::string& split_policy = split_policies[state.range(3)];
+    benchmarks::SyntheticData data = benchmarks::make_synthetic_data(num_samples, num_features, num_classes, 1);
+    decisiontree::Dataset dataset(data.X, num_features);
+
+    decisiontree::RandomState random_state(0);
+    decisiontree::Splitter splitter(1, num_samples, 
+                                    num_features, num_features, 
+                                    num_classes, std::vector<double>(num_classes, 1.0), 
+                                    {num_classes}, "gini", 
+                                    split_policy, random_state);
+    splitter.init_features(dataset.get_view());
+
+    unsigned long feature_index = 0, partition_index = 0;
+    double partition_threshold = 0.0, improvement = 0.0;
+    int has_missing_value = -1;
+    for (auto _ : state) {
+        splitter.init_node(data.y, 0, num_samples);
+        improvement = 0.0;
+        splitter.split_node(dataset.get_view(), data.y, 
+                            feature_index, 
+                            partition_index, 
+                            partition_threshold, 
+                            improvement, 
+                            has_missing_value);
+        benchmark::DoNotOptimize(partition_index);
+    }
+    state.SetItemsProcessed(state.iterations() * num_samples * num_features);
+    state.SetLabel(split_policy);
+}
+BENCHMARK(BM_SplitNode)
+    ->ArgNames({"rows", "features", "classes", "policy"})
+    ->ArgsProduct({{1 << 10, 1 << 14, 1 << 17}, {10, 100}, {2}, {0, 1, 2}})
+    ->ArgsProduct({{1 << 14}, {10}, {10}, {0, 1, 2}})
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+
+#include "decision_tree/algorithm/decision_tree_classifier.hpp"
+#include "synthetic_data.hpp"
+
+namespace {
+
+// predict the class probabilities of num_samples samples with a tree of 
+// depth max_depth, the tree is fitted once outside the loop
+void BM_PredictProba(benchmark::State& state) {
+    unsigned long num_samples = state.range(0);
+    int max_depth = state.range(1);
+    unsigned long num_threads = state.range(2);
+    unsigned long num_features = 20, num_classes = 3;
+    benchmarks::SyntheticData data = benchmarks::make_synthetic_data(num_samples, num_features, num_classes, 1);
+    decisiontree::DecisionTreeClassifier clf(data.feature_names, data.class_labels, 0, max_depth);
+    clf.fit(data.X, data.y);
+    decisiontree::TreeView tree = clf.get_tree();
+
+    // the pool is started once, as a model keeps it across predictions
+    decisiontree::ThreadPool thread_pool(num_threads);
+    std::vector<double> proba(num_samples * num_classes);
+    for (auto _ : state) {
+        tree.predict_proba(data.X.data(), num_samples, proba.data(), &thread_pool);
+        benchmark::DoNotOptimize(proba.data());
+    }
+    state.SetItemsProcessed(state.iterations() * num_samples);
+    state.counters["num_nodes"] = tree.get_node_count();
+}
+BENCHMARK(BM_PredictProba)
+    ->ArgNames({"rows", "depth", "threads"})
+    ->ArgsProduct({{1 << 12, 1 << 16}, {4, 8, 16}, {1}})
+    ->ArgsProduct({{1 << 16}, {16}, {4}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+} // namespace
@@ -0,0 +1,42 @@
+#ifndef BENCHMARKS_SYNTHETIC_DATA_HPP_
+#define BENCHMARKS_SYNTHETIC_DATA_HPP_
+
+#include "decision_tree/utility/synthetic_data.hpp"
+
+namespace benchmarks {
+
+/**
+ * @brief classification data of shape (num_samples, num_features) with 
+ * labels of shape (num_samples, num_outputs), X is row-major
+*/
+struct SyntheticData {
+    std::vector<std::string> feature_names;
+    std::vector<std::vector<std::string>> class_labels;
+    std::vector<double> X;
+    std::vector<long> y;
+};
+
+/**
+ * @brief noisy hyperplane data of SyntheticDataGenerator, labels are 
+ * quantized into num_classes classes of about the same size and a 
+ * missing_rate fraction of the values of X is NaN
+*/
+inline SyntheticData make_synthetic_data(unsigned long num_samples, 
+                                         unsigned long num_features, 
+                                         unsigned long num_classes, 
+                                         unsigned long num_outputs, 
+                                         double missing_rate = 0.0, 
+                                         unsigned long seed = 0) {
+    decisiontree::SyntheticDataGenerator generator(num_samples, num_features, 
+                                                   num_classes, num_outputs, 
+                                                   "hyperplane", missing_rate, 0.0, seed);
+    SyntheticData data;
+    data.feature_names = generator.get_feature_names();
+    data.class_labels = generator.get_class_labels();
+    generator.generate(data.X, data.y);
+    return data;
+}
+
+} // namespace
+
+#endif // BENCHMARKS_SYNTHETIC_DATA_HPP_
@@ -1,11 +1,15 @@
 #ifndef ALGORITHM_DECISION_TREE_CLASSIFIER_HPP_
 #define ALGORITHM_DECISION_TREE_CLASSIFIER_HPP_
 
+#include "algorithm/fit_params.hpp"
 #include "common/prereqs.hpp"
 #include "core/builder.hpp"
+#include "core/dataset.hpp"
 #include "core/splitter.hpp"
 #include "core/tree.hpp"
+#include "utility/binary_io.hpp"
 #include "utility/math.hpp"
+#include "utility/profiler.hpp"
 #include "utility/random.hpp"
 
 namespace decisiontree {
@@ -40,14 +44,47 @@ namespace decisiontree {
  *  a self-defined class weights
  * @param criterion {"gini", "entropy"} default=gini
  *  the criterion to measure the quality of a split
- * @param split_policy {"random", "best"} default=best
- *  the strategy used to choose the split at each node.
+ * @param split_policy {"random", "best", "hist"} default=best
+ *  the strategy used to choose the split at each node, "hist" bins
+ *  each feature once into at most 255 bins and scans the per-bin
+ *  class histograms instead of sorting the samples at each node.
  * @param class_weight_ptr_ smart pointer to the class weight
  *  if class_balanced=false, class_weight_ptr_ must be defined to
  *  point to the self-defined class weight in the form {w, w, ..., }
+ * @param presort boolean default=false
+ *  whether to sort each feature column once before building the tree,
+ *  the sorted orders are kept by stable partitioning down to the leaves
+ *  instead of sorting at every node, only used with split_policy=best
+ * @param num_threads int default=1
+ *  the number of threads to search the split features of a node in parallel
+ *  and to predict blocks of samples in parallel, if -1, use all available 
+ *  cores. The split found does not depend on it.
+ * @param max_leaf_nodes int default=-1
+ *  grow the tree in best-first order with at most max_leaf_nodes leaves,
+ *  the node with the highest improvement is split first. If -1, the 
+ *  number of leaves is unlimited and the tree is grown in depth-first order.
+ * @param categorical_features 1d array of boolean default={}
+ *  categorical_features[f] is true if the values of feature f are category 
+ *  codes, integers in [0, MAX_NUM_CATEGORIES), and NaN for missing values. A categorical 
+ *  feature is split by a set of categories going to the left child instead 
+ *  of a threshold, for any split_policy. If empty, all features are numerical.
+ * 
+ * @tparam FeatureType type of the feature values, e.g. float halves the 
+ *  memory and the bandwidth of X, the thresholds of the tree stay double
+ * @tparam ClassType type of the class labels in y
+ * @tparam SampleIndexType type of the sample indices moved around by the 
+ *  split search, 32-bit indices halve its memory traffic
 */
-class DecisionTreeClassifier {
+template<typename FeatureType, typename ClassType, typename SampleIndexType>
+class BasicDecisionTreeClassifier {
 private:
+    using DataView = BasicDataView<FeatureType>;
+    using Dataset = BasicDataset<FeatureType>;
+    using Splitter = BasicSplitter<FeatureType, ClassType, SampleIndexType>;
+    using TreeBuilder = BasicTreeBuilder<FeatureType, ClassType, SampleIndexType>;
+    using DepthFirstTreeBuilder = BasicDepthFirstTreeBuilder<FeatureType, ClassType, SampleIndexType>;
+    using BestFirstTreeBuilder = BasicBestFirstTreeBuilder<FeatureType, ClassType, SampleIndexType>;
+
     std::vector<std::string> feature_names_;
     std::vector<std::vector<std::string>> class_labels_;
     int random_seed_;
@@ -60,6 +97,10 @@ private:
     std::string criterion_;
     std::string split_policy_;
     std::shared_ptr<std::vector<double>> class_weight_ptr_;
+    bool presort_;
+    int num_threads_;
+    int max_leaf_nodes_;
+    std::vector<bool> categorical_features_;
 
     NumFeaturesType num_features_;
     NumOutputsType num_outputs_;
@@ -67,23 +108,40 @@ private:
     std::vector<NumClassesType> num_classes_list_;
 
     decisiontree::RandomState random_state_;
-    decisiontree::Splitter splitter_;
+    Splitter splitter_;
     decisiontree::Tree tree_;
-    std::shared_ptr<decisiontree::DepthFirstTreeBuilder> builder_;
+    std::shared_ptr<TreeBuilder> builder_;
+    decisiontree::TreeView fitted_tree_;
+    decisiontree::TrainingProfile profile_;
+
+    // pool predicting blocks of samples in parallel, started by fit if 
+    // num_threads > 1 and shared by the concurrent calls of predict
+    std::shared_ptr<ThreadPool> thread_pool_;
+
+    const decisiontree::TreeView& get_fitted_tree() const {
+        if (fitted_tree_.get_node_count() == 0) {
+            throw std::runtime_error("The classifier is not fitted yet, call 'fit' or 'load' first.");
+        }
+        return fitted_tree_;
+    };
 
 public:
-    DecisionTreeClassifier(std::vector<std::string> feature_names,
-                           std::vector<std::vector<std::string>> class_labels,
-                           int random_seed = 0,
-                           int max_depth = 4, 
-                           int max_num_features = -1, 
-                           int min_samples_split = 2, 
-                           int min_samples_leaf = 1,
-                           double min_weight_fraction_leaf = 0.0, 
-                           bool class_balanced = true,
-                           std::string criterion = "gini", 
-                           std::string split_policy = "best",
-                           std::shared_ptr<std::vector<double>> class_weight_ptr = nullptr):
+    BasicDecisionTreeClassifier(std::vector<std::string> feature_names,
+                                std::vector<std::vector<std::string>> class_labels,
+                                int random_seed = 0,
+                                int max_depth = 4, 
+                                int max_num_features = -1, 
+                                int min_samples_split = 2, 
+                                int min_samples_leaf = 1,
+                                double min_weight_fraction_leaf = 0.0, 
+                                bool class_balanced = true,
+                                std::string criterion = "gini", 
+                                std::string split_policy = "best",
+                                std::shared_ptr<std::vector<double>> class_weight_ptr = nullptr, 
+                                bool presort = false, 
+                                int num_threads = 1, 
+                                int max_leaf_nodes = -1, 
+                                std::vector<bool> categorical_features = std::vector<bool>()):
                         feature_names_(feature_names),
                         class_labels_(class_labels),
                         random_seed_(random_seed),
@@ -96,6 +154,10 @@ public:
                         criterion_(criterion),
                         split_policy_(split_policy),
                         class_weight_ptr_(class_weight_ptr), 
+                        presort_(presort), 
+                        num_threads_(num_threads), 
+                        max_leaf_nodes_(max_leaf_nodes), 
+                        categorical_features_(categorical_features), 
                         num_features_(feature_names.size()), 
                         num_outputs_(class_labels.size()) {
         
@@ -108,84 +170,72 @@ public:
                                              end(num_classes_list_));
     };
     
-    ~DecisionTreeClassifier() {};
+    ~BasicDecisionTreeClassifier() {};
 
+    /**
+     * @brief fit on the row-major X of shape (num_samples, num_features), 
+     * X is copied into a column-major dataset for the time of the fit, so 
+     * that the split search reads each feature from a contiguous column.
+    */
     void fit(const std::vector<FeatureType>& X, 
              const std::vector<ClassType>& y) {
-        NumSamplesType num_samples = y.size() / num_outputs_;
-
-        // check max_depth
-        if (max_depth_ < 0) {
-            throw std::invalid_argument("max_depth must be positive");
-        }
-        NumSamplesType max_depth = static_cast<NumSamplesType>(max_depth_);
+        Dataset dataset(X, num_features_);
+        fit(dataset.get_view(), y);
+    };
 
-        // check min_samples_leaf
-        if (min_samples_leaf_ < 0) {
-            throw std::invalid_argument("min_samples_leaf must be positive");
+    /**
+     * @brief fit on X of shape (num_samples, num_features) held by the 
+     * caller in any layout, X is read in place, a column-major X gives 
+     * the fastest split search.
+    */
+    void fit(const DataView& X, 
+             const std::vector<ClassType>& y) {
+        NumSamplesType num_samples = y.size() / num_outputs_;
+        if (X.get_num_features() != num_features_ || X.get_num_samples() != num_samples) {
+            throw std::invalid_argument("Shape of X does not match the features and the number of samples of y.");
         }
-        NumSamplesType min_samples_leaf = static_cast<NumSamplesType>(min_samples_leaf_);
 
-        // check min_samples_split
-        if (min_samples_split_ < 0) {
-            throw std::invalid_argument("min_samples_split must be positive");
-        }
-        NumSamplesType min_samples_split = static_cast<NumSamplesType>(min_samples_split_);
+        // check the growth of the tree, the default considers all the features
+        TreeParams tree_params = check_tree_params(max_depth_, 
+                                                   min_samples_split_, 
+                                                   min_samples_leaf_, 
+                                                   max_num_features_, 
+                                                   num_features_, 
+                                                   num_features_);
+        TreeDepthType max_depth = tree_params.max_depth;
+        NumSamplesType min_samples_leaf = tree_params.min_samples_leaf;
+        NumSamplesType min_samples_split = tree_params.min_samples_split;
+        NumFeaturesType max_num_features = tree_params.max_num_features;
         min_samples_split_ = std::max(min_samples_split_, 2 * min_samples_leaf_);
 
-        // check max_num_features
-        NumFeaturesType max_num_features;
-        if (max_num_features_ == -1) {
-            max_num_features = num_features_;
-        }
-        else if (max_num_features_ > 0) {
-            max_num_features = static_cast<NumFeaturesType>(max_num_features_);
-        }
-
-        // check class_weight
-        std::vector<double> class_weight(num_outputs_ * max_num_classes_, 1.0);;
-        if (class_balanced_) {
-            for (unsigned long o = 0; o < num_outputs_; ++o) { // process each output independently
-                std::vector<long> bincount(num_classes_list_[o], 0);
-                for (unsigned long i = 0; i < num_samples; ++i) {
-                    bincount[y[i * num_outputs_ + o]]++;
-                }
-                for (unsigned long c = 0; c < num_classes_list_[o]; ++c) {
-                    class_weight[o * max_num_classes_ + c] =
-                        (static_cast<double>(num_samples) / bincount[c]) / num_classes_list_[o];
-                }
-            }
-        }
-        else {
-            if (class_weight_ptr_ == nullptr) {
-                throw std::invalid_argument(
-                    "If 'class_balanced' is false, must provide a smart pointer to a class weight."
-                    "Weights associated with classes in the form {weight, weight, ..., }."
-                );
-            }
-            class_weight = *class_weight_ptr_;
-        }
-
-        // check min_weight_leaf
-        NumSamplesType min_weight_leaf;
-        if (class_balanced_) {
-            min_weight_leaf = static_cast<NumSamplesType>(min_weight_fraction_leaf_ * num_samples);
-        } 
-        else {
-            double sum_weight = std::accumulate(class_weight.begin(), class_weight.end(), 0.0);
-            min_weight_leaf = static_cast<NumSamplesType>(min_weight_fraction_leaf_ * sum_weight);
-        }
+        // check class_weight and min_weight_leaf
+        ClassWeightParams class_weight_params = compute_class_weight_params(y, 
+                                                                            num_outputs_, 
+                                                                            num_classes_list_, 
+                                                                            max_num_classes_, 
+                                                                            class_balanced_, 
+                                                                            class_weight_ptr_, 
+                                                                            min_weight_fraction_leaf_);
+        const std::vector<double>& class_weight = class_weight_params.class_weight;
+        NumSamplesType min_weight_leaf = class_weight_params.min_weight_leaf;
 
         // init criterion
-        if (CRITERIA_CLF.find(criterion_) == CRITERIA_CLF.end()) {
-            throw std::invalid_argument("Criterion must be either 'gini' or 'entropy'.");
-        }
+        check_criterion_clf(criterion_);
 
         // check split strategy
         if (SPLIT_STRATEGY.find(split_policy_) == SPLIT_STRATEGY.end()) {
             throw std::invalid_argument(
                 "Supported strategies are 'best' to choose the best "
-                "split and 'random' to choose the best random split.");
+                "split, 'random' to choose the best random split and "
+                "'hist' to choose the best split over histogram bins.");
+        }
+
+        // check num_threads
+        NumThreadsType num_threads = check_num_threads(num_threads_);
+
+        // check max_leaf_nodes
+        if (max_leaf_nodes_ != -1 && max_leaf_nodes_ < 2) {
+            throw std::invalid_argument("max_leaf_nodes must be greater than 1 or -1.");
         }
 
         if (random_seed_ == -1) {
@@ -195,68 +245,206 @@ public:
             random_state_ = decisiontree::RandomState(random_seed_);
         }
 
-        splitter_ = decisiontree::Splitter(num_outputs_,  
-                                           num_samples,
-                                           num_features_,
-                                           max_num_features,
-                                           max_num_classes_,
-                                           class_weight,
-                                           num_classes_list_,
-                                           criterion_,
-                                           split_policy_,
-                                           random_state_);
+        splitter_ = Splitter(num_outputs_,  
+                             num_samples,
+                             num_features_,
+                             max_num_features,
+                             max_num_classes_,
+                             class_weight,
+                             num_classes_list_,
+                             criterion_,
+                             split_policy_,
+                             random_state_, 
+                             presort_, 
+                             num_threads);
+        splitter_.set_categorical_features(categorical_features_);
         
         tree_ = decisiontree::Tree(num_outputs_, 
                                    num_features_, 
                                    num_classes_list_);
 
-        builder_ = std::make_shared<decisiontree::DepthFirstTreeBuilder>(max_depth, 
-                                                                        min_samples_split, 
-                                                                        min_samples_leaf, 
-                                                                        min_weight_leaf,
-                                                                        class_weight,
-                                                                        splitter_, 
-                                                                        tree_);
+        if (max_leaf_nodes_ == -1) {
+            builder_ = std::make_shared<DepthFirstTreeBuilder>(max_depth, 
+                                                              min_samples_split, 
+                                                              min_samples_leaf, 
+                                                              min_weight_leaf,
+                                                              class_weight,
+                                                              splitter_, 
+                                                              tree_);
+        }
+        else {
+            builder_ = std::make_shared<BestFirstTreeBuilder>(max_depth, 
+                                                             min_samples_split, 
+                                                             min_samples_leaf, 
+                                                             min_weight_leaf,
+                                                             class_weight,
+                                                             splitter_, 
+                                                             tree_, 
+                                                             static_cast<NumNodesType>(max_leaf_nodes_));
+        }
         builder_->build(X, y, num_samples);
+        profile_ = builder_->get_profile();
+
+        // the fitted tree is immutable, the builder and its splitter are released
+        auto fitted_tree_ptr = std::make_shared<const decisiontree::Tree>(std::move(builder_->tree_));
+        fitted_tree_ = fitted_tree_ptr->get_view(fitted_tree_ptr);
+        builder_.reset();
+        thread_pool_ = (num_threads > 1) ? std::make_shared<ThreadPool>(num_threads) : nullptr;
     };
 
-    const std::vector<double> predict_proba(const std::vector<FeatureType>& X) {
+    /**
+     * @brief a view of the fitted tree, it is never modified once fit returns, 
+     * so it can be shared by threads predicting concurrently, and it keeps 
+     * the tree alive if the classifier is fitted again or destroyed.
+    */
+    decisiontree::TreeView get_tree() const {
+        return get_fitted_tree();
+    };
+
+    /**
+     * @brief where the time of the last fit went: time of each phase of 
+     * the split search, nodes per depth, samples touched and thresholds 
+     * evaluated. It is only recorded if the library is compiled with 
+     * DECISIONTREE_PROFILE defined, otherwise it is empty, see PROFILE_ENABLED.
+    */
+    const decisiontree::TrainingProfile& get_profile() const {
+        return profile_;
+    };
+
+    /**
+     * @brief save the fitted classifier to a binary model file, the file 
+     * holds the header, the feature names, the class labels and the tree: 
+     * [header, num_features, feature_names, num_outputs, 
+     * (num_classes, class_labels) per output, tree], strings are stored 
+     * as [size, chars], see TreeView::serialize for the tree.
+    */
+    void save(const std::string& path) const {
+        const decisiontree::TreeView& tree = get_fitted_tree();
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        if (!os) {
+            throw std::runtime_error("Failed to open '" + path + "'.");
+        }
+        BinaryWriter writer(os);
+        writer.write_header(MODEL_KIND_CLASSIFIER);
+        writer.write<std::uint64_t>(feature_names_.size());
+        for (const auto& feature_name : feature_names_) {
+            writer.write_string(feature_name);
+        }
+        writer.write<std::uint64_t>(class_labels_.size());
+        for (const auto& labels : class_labels_) {
+            writer.write<std::uint64_t>(labels.size());
+            for (const auto& label : labels) {
+                writer.write_string(label);
+            }
+        }
+        tree.serialize(writer);
+    };
+
+    /**
+     * @brief load a classifier saved by save, the file is mapped in memory 
+     * and the tree is read in place from the mapped pages, so processes 
+     * loading the same file share one copy of the tree in the page cache. 
+     * Only the names and labels are copied, the loaded classifier can 
+     * predict but keeps the default hyperparameters.
+    */
+    static BasicDecisionTreeClassifier load(const std::string& path) {
+        auto mapped_file = std::make_shared<const MappedFile>(path);
+        BinaryReader reader(mapped_file->data(), mapped_file->size());
+        reader.read_header(MODEL_KIND_CLASSIFIER);
+
+        std::vector<std::string> feature_names(reader.read_count(sizeof(std::uint64_t)));
+        for (auto& feature_name : feature_names) {
+            feature_name = reader.read_string();
+        }
+        std::vector<std::vector<std::string>> class_labels(reader.read_count(sizeof(std::uint64_t)));
+        for (auto& labels : class_labels) {
+            labels.resize(reader.read_count(sizeof(std::uint64_t)));
+            for (auto& label : labels) {
+                label = reader.read_string();
+            }
+        }
+        for (const auto& labels : class_labels) {
+            if (labels.empty()) {
+                throw std::runtime_error("The binary model has an output without class.");
+            }
+        }
+        if (class_labels.empty()) {
+            throw std::runtime_error("The binary model has no output.");
+        }
+
+        BasicDecisionTreeClassifier clf(feature_names, class_labels);
+        clf.fitted_tree_ = decisiontree::TreeView::deserialize(reader, mapped_file);
+        if (clf.fitted_tree_.get_num_features() != clf.num_features_ || 
+                clf.fitted_tree_.get_num_classes_list() != clf.num_classes_list_) {
+            throw std::runtime_error("The binary model tree does not match its feature names and class labels.");
+        }
+        return clf;
+    };
+
+    /**
+     * @brief predict class probabilities of X of shape (num_samples, num_features) 
+     * into the caller-provided proba of shape (num_samples, num_outputs, max_num_classes). 
+     * It is const and re-entrant, several threads may call it on the same 
+     * classifier, and it does not allocate when there is no missing value.
+    */
+    void predict_proba(const FeatureType* X, 
+                       NumSamplesType num_samples, 
+                       double* proba) const {
+        get_fitted_tree().predict_proba(X, num_samples, proba, thread_pool_.get());
+    };
+
+    /**
+     * @brief predict class labels of X of shape (num_samples, num_features) 
+     * into the caller-provided y of shape (num_samples, num_outputs), 
+     * const and re-entrant as predict_proba.
+    */
+    void predict(const FeatureType* X, 
+                 NumSamplesType num_samples, 
+                 ClassType* y) const {
+        get_fitted_tree().predict(X, num_samples, y, thread_pool_.get());
+    };
+
+    const std::vector<double> predict_proba(const std::vector<FeatureType>& X) const {
         NumSamplesType num_samples = X.size() / num_features_;
-        std::vector<double> proba;
-        builder_->tree_.predict_proba(X, num_samples, proba);
+        std::vector<double> proba(num_samples * num_outputs_ * max_num_classes_);
+        predict_proba(X.data(), num_samples, proba.data());
 
         return proba;
     };
 
-    const std::vector<ClassType> predict(const std::vector<FeatureType>& X) {
-        NumSamplesType num_samples = X.size() / num_features_;
-        std::vector<double> proba;
-        builder_->tree_.predict_proba(X, num_samples, proba);
+    /**
+     * @brief predict_proba and predict on X held by the caller in any layout
+    */
+    void predict_proba(const DataView& X, double* proba) const {
+        get_fitted_tree().predict_proba(X, proba, thread_pool_.get());
+    };
+
+    void predict(const DataView& X, ClassType* y) const {
+        get_fitted_tree().predict(X, y, thread_pool_.get());
+    };
 
+    const std::vector<ClassType> predict(const std::vector<FeatureType>& X) const {
+        NumSamplesType num_samples = X.size() / num_features_;
         std::vector<ClassType> label(num_samples * num_outputs_, 0);
-        for (IndexType i = 0; i < num_samples; ++i) {
-            for (IndexType o = 0; o < num_outputs_; ++o) {
-                label[i*num_outputs_ + o] = decisiontree::argmax<FeatureType, ClassType>(
-                    &proba[i*num_outputs_*max_num_classes_ + o*max_num_classes_], num_classes_list_[o]
-                );
-            }
-        }
+        predict(X.data(), num_samples, label.data());
 
         return label;
     };
 
-    const std::vector<double> compute_feature_importance() {
+    const std::vector<double> compute_feature_importance() const {
         std::vector<double> f_importances;
-        builder_->tree_.compute_feature_importance(f_importances);
+        get_fitted_tree().compute_feature_importance(f_importances);
         return f_importances;
     };
 
-    void print_node_info() {
-        builder_->tree_.print_node_info();
+    void print_node_info() const {
+        get_fitted_tree().print_node_info();
     };  
 
 };
 
+using DecisionTreeClassifier = BasicDecisionTreeClassifier<FeatureType, ClassType, SampleIndexType>;
+
 } // namespace
 
 #endif // ALGORITHM_DECISION_TREE_CLASSIFIER_HPP_
\ No newline at end of file
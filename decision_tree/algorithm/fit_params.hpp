@@ -0,0 +1,156 @@
+#ifndef ALGORITHM_FIT_PARAMS_HPP_
+#define ALGORITHM_FIT_PARAMS_HPP_
+
+#include "common/prereqs.hpp"
+
+namespace decisiontree {
+
+/**
+ * @file fit_params.hpp
+ *
+ * @brief The checks of the parameters shared by the classifiers, run at
+ * the start of a fit. The parameters are given as the user set them and
+ * are converted to the types of the builder and of the splitter, an
+ * invalid parameter throws std::invalid_argument.
+*/
+
+/**
+ * @brief the parameters of the growth of a tree, see check_tree_params.
+*/
+struct TreeParams {
+    TreeDepthType max_depth;
+    NumSamplesType min_samples_split;
+    NumSamplesType min_samples_leaf;
+    NumFeaturesType max_num_features;
+};
+
+/**
+ * @brief check the parameters of the growth of a tree, max_num_features
+ * = -1 considers default_max_num_features features at each split, a
+ * positive max_num_features is capped by num_features.
+*/
+inline TreeParams check_tree_params(int max_depth,
+                                    int min_samples_split,
+                                    int min_samples_leaf,
+                                    int max_num_features,
+                                    NumFeaturesType num_features,
+                                    NumFeaturesType default_max_num_features) {
+    TreeParams params;
+
+    // check max_depth
+    if (max_depth < 0) {
+        throw std::invalid_argument("max_depth must be positive");
+    }
+    params.max_depth = static_cast<TreeDepthType>(max_depth);
+
+    // check min_samples_leaf and min_samples_split
+    if (min_samples_leaf < 0) {
+        throw std::invalid_argument("min_samples_leaf must be positive");
+    }
+    if (min_samples_split < 0) {
+        throw std::invalid_argument("min_samples_split must be positive");
+    }
+    params.min_samples_leaf = static_cast<NumSamplesType>(min_samples_leaf);
+    params.min_samples_split = static_cast<NumSamplesType>(min_samples_split);
+
+    // check max_num_features
+    if (max_num_features == -1) {
+        params.max_num_features = default_max_num_features;
+    }
+    else if (max_num_features > 0) {
+        params.max_num_features = std::min<NumFeaturesType>(max_num_features, num_features);
+    }
+    else {
+        throw std::invalid_argument("max_num_features must be positive or -1.");
+    }
+    return params;
+}
+
+/**
+ * @brief check num_threads, -1 uses all the hardware threads.
+*/
+inline NumThreadsType check_num_threads(int num_threads) {
+    if (num_threads == 0 || num_threads < -1) {
+        throw std::invalid_argument("num_threads must be positive or -1.");
+    }
+    if (num_threads == -1) {
+        return std::max<NumThreadsType>(std::thread::hardware_concurrency(), 1);
+    }
+    return static_cast<NumThreadsType>(num_threads);
+}
+
+/**
+ * @brief check the criterion of a classification tree.
+*/
+inline void check_criterion_clf(const std::string& criterion) {
+    if (CRITERIA_CLF.find(criterion) == CRITERIA_CLF.end()) {
+        throw std::invalid_argument("Criterion must be either 'gini' or 'entropy'.");
+    }
+}
+
+/**
+ * @brief the class weights of a fit and the minimum weight of a leaf
+ * they give, see compute_class_weight_params.
+*/
+struct ClassWeightParams {
+    std::vector<ClassWeightType> class_weight;
+    NumSamplesType min_weight_leaf;
+};
+
+/**
+ * @brief the class weights of shape (num_outputs, max_num_classes), if
+ * class_balanced, the weight of a class is inversely proportional to its
+ * count in y of shape (num_samples, num_outputs), otherwise the weights
+ * are those pointed to by class_weight_ptr. The minimum weight of a leaf
+ * is min_weight_fraction_leaf of the number of samples, or of the sum of
+ * the given weights.
+*/
+template<typename ClassType>
+ClassWeightParams compute_class_weight_params(const std::vector<ClassType>& y,
+                                              NumOutputsType num_outputs,
+                                              const std::vector<NumClassesType>& num_classes_list,
+                                              NumClassesType max_num_classes,
+                                              bool class_balanced,
+                                              const std::shared_ptr<std::vector<double>>& class_weight_ptr,
+                                              double min_weight_fraction_leaf) {
+    NumSamplesType num_samples = y.size() / num_outputs;
+    ClassWeightParams params;
+
+    // check class_weight
+    params.class_weight.assign(num_outputs * max_num_classes, 1.0);
+    if (class_balanced) {
+        for (IndexType o = 0; o < num_outputs; ++o) { // process each output independently
+            std::vector<long> bincount(num_classes_list[o], 0);
+            for (IndexType i = 0; i < num_samples; ++i) {
+                bincount[y[i * num_outputs + o]]++;
+            }
+            for (IndexType c = 0; c < num_classes_list[o]; ++c) {
+                params.class_weight[o * max_num_classes + c] =
+                    (static_cast<double>(num_samples) / bincount[c]) / num_classes_list[o];
+            }
+        }
+    }
+    else {
+        if (class_weight_ptr == nullptr) {
+            throw std::invalid_argument(
+                "If 'class_balanced' is false, must provide a smart pointer to a class weight."
+                "Weights associated with classes in the form {weight, weight, ..., }."
+            );
+        }
+        params.class_weight = *class_weight_ptr;
+    }
+
+    // check min_weight_leaf
+    if (class_balanced) {
+        params.min_weight_leaf = static_cast<NumSamplesType>(min_weight_fraction_leaf * num_samples);
+    }
+    else {
+        double sum_weight = std::accumulate(params.class_weight.begin(), params.class_weight.end(), 0.0);
+        params.min_weight_leaf = static_cast<NumSamplesType>(min_weight_fraction_leaf * sum_weight);
+    }
+    return params;
+};
+
+} // namespace
+
+#endif // ALGORITHM_FIT_PARAMS_HPP_
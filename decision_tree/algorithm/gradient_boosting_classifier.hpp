@@ -0,0 +1,467 @@
+#ifndef ALGORITHM_GRADIENT_BOOSTING_CLASSIFIER_HPP_
+#define ALGORITHM_GRADIENT_BOOSTING_CLASSIFIER_HPP_
+
+#include "algorithm/fit_params.hpp"
+#include "common/prereqs.hpp"
+#include "core/builder.hpp"
+#include "core/criterion/gradient.hpp"
+#include "core/dataset.hpp"
+#include "core/splitter.hpp"
+#include "core/tree.hpp"
+#include "utility/math.hpp"
+#include "utility/random.hpp"
+#include "utility/thread_pool.hpp"
+
+namespace decisiontree {
+
+/**
+ * @file gradient_boosting_classifier.hpp
+ *
+ * @brief A gradient boosting classifier, an additive model of regression
+ * trees fitted one round after the other on the gradients and hessians
+ * of the log-loss at the current scores. A binary problem has a single
+ * score, the log-odds of the second class, with one tree per round, a
+ * problem of K > 2 classes has K scores turned into probabilities by
+ * softmax, with K trees per round.
+ *
+ * The trees are grown in depth-first order by the usual builder and
+ * splitter with the second-order gain of GradientCriterion, the value of
+ * a leaf is learning_rate * -G / (H + l2_regularization). The features
+ * are quantized once for all the rounds with the hist split policy, and
+ * the scores of the training samples are updated from the leaves of the
+ * new tree only, each leaf holds a contiguous range of the sample order
+ * of the builder, so no tree is traversed during training.
+ *
+ * @param feature_names 1d array of string
+ *  which refers names to use for elements of input data given.
+ * @param class_labels 2d array of shape (1, num_classes)
+ *  the class labels of the single output, e.g {{<class1>, <class2>, ...}}
+ * @param num_estimators int default=100
+ *  the number of boosting rounds
+ * @param learning_rate double default=0.1
+ *  the shrinkage of the leaf values of each tree
+ * @param max_depth int default=3,
+ *  the maximum depth of each tree
+ * @param random_seed int default=0
+ *  controls the order in which features are drawn at each split
+ * @param max_num_features int default=-1,
+ *  the number of features to consider when looking for the best split,
+ *  if -1, then all the features are considered.
+ * @param min_samples_split int default=2
+ *  the minimum number of samples required to split an internal node.
+ * @param min_samples_leaf int default=1
+ *  the minimum number of samples required to be at a leaf node.
+ * @param l2_regularization double default=1.0
+ *  the L2 regularization of the leaf values, in the gain and in the values
+ * @param min_split_gain double default=0.0
+ *  the Newton gain a split must exceed, a node is a leaf otherwise
+ * @param split_policy {"random", "best", "hist"} default=hist
+ *  the strategy used to choose the split at each node
+ * @param num_threads int default=1
+ *  the number of threads to search the split features in parallel and to
+ *  predict blocks of samples in parallel, if -1, use all available cores.
+*/
+template<typename FeatureType, typename ClassType, typename SampleIndexType>
+class BasicGradientBoostingClassifier {
+private:
+    using DataView = BasicDataView<FeatureType>;
+    using Dataset = BasicDataset<FeatureType>;
+    using Splitter = BasicSplitter<FeatureType, ClassType, SampleIndexType>;
+    using DepthFirstTreeBuilder = BasicDepthFirstTreeBuilder<FeatureType, ClassType, SampleIndexType>;
+
+    std::vector<std::string> feature_names_;
+    std::vector<std::vector<std::string>> class_labels_;
+    int num_estimators_;
+    double learning_rate_;
+    int max_depth_;
+    int random_seed_;
+    int max_num_features_;
+    int min_samples_split_;
+    int min_samples_leaf_;
+    double l2_regularization_;
+    double min_split_gain_;
+    std::string split_policy_;
+    int num_threads_;
+
+    NumFeaturesType num_features_;
+    NumClassesType num_classes_;
+
+    // number of scores of a sample, 1 for a binary problem, num_classes otherwise,
+    // tree t adds to the score t % num_scores_
+    NumClassesType num_scores_;
+    std::vector<double> init_scores_;
+    std::vector<decisiontree::TreeView> trees_;
+
+    // node_values_[t][i] is the value added to the score by node i of tree t, 
+    // node_hessians_[t][i] the sum of hessians H of node i, the weight of the 
+    // node for the samples going down both children of its parent
+    std::vector<std::vector<double>> node_values_;
+    std::vector<std::vector<double>> node_hessians_;
+
+    // pool predicting blocks of samples in parallel, started by fit if 
+    // num_threads > 1 and shared by the concurrent calls of predict
+    std::shared_ptr<ThreadPool> thread_pool_;
+
+    const std::vector<decisiontree::TreeView>& get_fitted_trees() const {
+        if (trees_.empty()) {
+            throw std::runtime_error("The classifier is not fitted yet, call 'fit' first.");
+        }
+        return trees_;
+    };
+
+    void check_num_features(const DataView& X) const {
+        get_fitted_trees();
+        if (X.get_num_features() != num_features_) {
+            throw std::invalid_argument("Number of features of X does not match the model.");
+        }
+    };
+
+    /**
+     * @brief turn the scores of one sample into the probabilities of the classes,
+     * the sigmoid of the log-odds for a binary problem, the softmax otherwise
+    */
+    void compute_proba(const double* scores, double* proba) const {
+        if (num_scores_ == 1) {
+            proba[1] = 1.0 / (1.0 + std::exp(-scores[0]));
+            proba[0] = 1.0 - proba[1];
+            return ;
+        }
+        double max_score = *std::max_element(scores, scores + num_scores_);
+        double sum_exp = 0.0;
+        for (NumClassesType c = 0; c < num_scores_; ++c) {
+            proba[c] = std::exp(scores[c] - max_score);
+            sum_exp += proba[c];
+        }
+        for (NumClassesType c = 0; c < num_scores_; ++c) {
+            proba[c] /= sum_exp;
+        }
+    };
+
+    /**
+     * @brief scores of samples X[begin:end] of a block into scores of shape
+     * (end - begin, num_scores), the trees are added in the order of the rounds
+    */
+    void compute_block_scores(const DataView& X,
+                              IndexType begin,
+                              IndexType end,
+                              double* scores) const {
+        for (IndexType k = 0; k < end - begin; ++k) {
+            std::copy(init_scores_.begin(), init_scores_.end(), &scores[k * num_scores_]);
+        }
+        for (IndexType t = 0; t < trees_.size(); ++t) {
+            trees_[t].add_block_values(X, begin, end, 
+                                       node_values_[t].data(), 
+                                       &scores[t % num_scores_], 
+                                       num_scores_, 
+                                       node_hessians_[t].data());
+        }
+    };
+
+public:
+    BasicGradientBoostingClassifier(std::vector<std::string> feature_names,
+                                    std::vector<std::vector<std::string>> class_labels,
+                                    int num_estimators = 100,
+                                    double learning_rate = 0.1,
+                                    int max_depth = 3,
+                                    int random_seed = 0,
+                                    int max_num_features = -1,
+                                    int min_samples_split = 2,
+                                    int min_samples_leaf = 1,
+                                    double l2_regularization = 1.0,
+                                    double min_split_gain = 0.0,
+                                    std::string split_policy = "hist",
+                                    int num_threads = 1):
+                        feature_names_(feature_names),
+                        class_labels_(class_labels),
+                        num_estimators_(num_estimators),
+                        learning_rate_(learning_rate),
+                        max_depth_(max_depth),
+                        random_seed_(random_seed),
+                        max_num_features_(max_num_features),
+                        min_samples_split_(min_samples_split),
+                        min_samples_leaf_(min_samples_leaf),
+                        l2_regularization_(l2_regularization),
+                        min_split_gain_(min_split_gain),
+                        split_policy_(split_policy),
+                        num_threads_(num_threads),
+                        num_features_(feature_names.size()),
+                        num_classes_(class_labels.empty() ? 0 : class_labels[0].size()),
+                        num_scores_(num_classes_ == 2 ? 1 : num_classes_) {};
+
+    ~BasicGradientBoostingClassifier() {};
+
+    /**
+     * @brief fit on the row-major X of shape (num_samples, num_features),
+     * X is copied once into a column-major dataset read by all rounds.
+    */
+    void fit(const std::vector<FeatureType>& X,
+             const std::vector<ClassType>& y) {
+        Dataset dataset(X, num_features_);
+        fit(dataset.get_view(), y);
+    };
+
+    /**
+     * @brief fit on X of shape (num_samples, num_features) held by the
+     * caller in any layout, X and y are read in place by all rounds.
+    */
+    void fit(const DataView& X,
+             const std::vector<ClassType>& y) {
+        if (class_labels_.size() != 1 || num_classes_ < 2) {
+            throw std::invalid_argument("Gradient boosting requires a single output of at least 2 classes.");
+        }
+        NumSamplesType num_samples = y.size();
+        if (X.get_num_features() != num_features_ || X.get_num_samples() != num_samples) {
+            throw std::invalid_argument("Shape of X does not match the features and the number of samples of y.");
+        }
+        if (num_samples == 0) {
+            throw std::invalid_argument("Cannot fit on an empty training set.");
+        }
+
+        // check num_estimators and learning_rate
+        if (num_estimators_ < 1) {
+            throw std::invalid_argument("num_estimators must be positive.");
+        }
+        if (!(learning_rate_ > 0.0)) {
+            throw std::invalid_argument("learning_rate must be positive.");
+        }
+
+        // check l2_regularization
+        if (!(l2_regularization_ >= 0.0)) {
+            throw std::invalid_argument("l2_regularization must be non-negative.");
+        }
+
+        // check min_split_gain
+        if (!(min_split_gain_ >= 0.0)) {
+            throw std::invalid_argument("min_split_gain must be non-negative.");
+        }
+
+        // check the growth of the trees, the default considers all the features
+        TreeParams tree_params = check_tree_params(max_depth_,
+                                                   min_samples_split_,
+                                                   min_samples_leaf_,
+                                                   max_num_features_,
+                                                   num_features_,
+                                                   num_features_);
+        NumThreadsType num_threads = check_num_threads(num_threads_);
+
+        // initial scores are the log-odds or the log of the class priors
+        std::vector<double> class_count(num_classes_, 0.0);
+        for (IndexType i = 0; i < num_samples; ++i) {
+            class_count[y[i]]++;
+        }
+        const double min_proba = 1e-15;
+        init_scores_.assign(num_scores_, 0.0);
+        if (num_scores_ == 1) {
+            double proba = std::min(std::max(class_count[1] / num_samples, min_proba), 1.0 - min_proba);
+            init_scores_[0] = std::log(proba / (1.0 - proba));
+        }
+        else {
+            for (NumClassesType c = 0; c < num_classes_; ++c) {
+                init_scores_[c] = std::log(std::max(class_count[c] / num_samples, min_proba));
+            }
+        }
+        std::vector<double> scores(num_samples * num_scores_);
+        for (IndexType i = 0; i < num_samples; ++i) {
+            std::copy(init_scores_.begin(), init_scores_.end(), &scores[i * num_scores_]);
+        }
+
+        // one builder grows all the trees, its splitter reads the gradients
+        // and the hessians in place and keeps the feature bins across rounds
+        std::vector<double> gradients(num_samples), hessians(num_samples);
+        std::vector<double> proba(num_samples * num_classes_);
+        const std::vector<NumClassesType> num_statistics_list = {NUM_GRADIENT_STATISTICS};
+        const std::vector<ClassWeightType> class_weight(NUM_GRADIENT_STATISTICS, 1.0);
+        RandomState random_state = (random_seed_ == -1) ? RandomState() : RandomState(random_seed_);
+        Splitter splitter(1,
+                          num_samples,
+                          num_features_,
+                          tree_params.max_num_features,
+                          NUM_GRADIENT_STATISTICS,
+                          class_weight,
+                          num_statistics_list,
+                          "gradient",
+                          split_policy_,
+                          random_state,
+                          false,
+                          num_threads);
+        splitter.set_gradients(gradients.data(), hessians.data(), l2_regularization_);
+        DepthFirstTreeBuilder builder(tree_params.max_depth,
+                                      tree_params.min_samples_split,
+                                      tree_params.min_samples_leaf,
+                                      0,
+                                      class_weight,
+                                      std::move(splitter),
+                                      decisiontree::Tree(1, num_features_, num_statistics_list));
+        builder.set_min_improvement(min_split_gain_);
+
+        std::vector<decisiontree::TreeView> trees;
+        std::vector<std::vector<double>> node_values, node_hessians;
+        trees.reserve(num_estimators_ * num_scores_);
+        node_values.reserve(num_estimators_ * num_scores_);
+        node_hessians.reserve(num_estimators_ * num_scores_);
+        for (int round = 0; round < num_estimators_; ++round) {
+            // all the trees of a round fit the probabilities before the round
+            for (IndexType i = 0; i < num_samples; ++i) {
+                compute_proba(&scores[i * num_scores_], &proba[i * num_classes_]);
+            }
+
+            for (NumClassesType s = 0; s < num_scores_; ++s) {
+                // log-loss gradient p - 1[y = c] and hessian p * (1 - p) of the class c of score s
+                NumClassesType c = (num_scores_ == 1) ? 1 : s;
+                for (IndexType i = 0; i < num_samples; ++i) {
+                    double p = proba[i * num_classes_ + c];
+                    gradients[i] = p - ((static_cast<NumClassesType>(y[i]) == c) ? 1.0 : 0.0);
+                    hessians[i] = std::max(p * (1.0 - p), min_proba);
+                }
+
+                builder.tree_ = decisiontree::Tree(1, num_features_, num_statistics_list);
+                builder.build(X, y, num_samples);
+                auto tree_ptr = std::make_shared<const decisiontree::Tree>(std::move(builder.tree_));
+
+                std::vector<double> values(tree_ptr->get_node_count()), tree_hessians(values.size());
+                for (NodeIndexType n = 0; n < values.size(); ++n) {
+                    values[n] = learning_rate_ * GradientCriterion::compute_leaf_value(tree_ptr->get_value(n),
+                                                                                      l2_regularization_);
+                    tree_hessians[n] = tree_ptr->get_value(n)[0];
+                }
+
+                // update the scores of the training samples from the leaves of the new tree
+                const std::vector<SampleIndexType>& sample_indices = builder.get_sample_indices();
+                const auto& node_ranges = builder.get_node_ranges();
+                for (NodeIndexType n = 0; n < values.size(); ++n) {
+                    if (tree_ptr->nodes_[n].left_child > 0) {
+                        continue;
+                    }
+                    for (IndexType j = node_ranges[n].first; j < node_ranges[n].second; ++j) {
+                        scores[sample_indices[j] * num_scores_ + s] += values[n];
+                    }
+                }
+
+                trees.push_back(tree_ptr->get_view(tree_ptr));
+                node_values.push_back(std::move(values));
+                node_hessians.push_back(std::move(tree_hessians));
+            }
+        }
+        trees_ = std::move(trees);
+        thread_pool_ = (num_threads > 1) ? std::make_shared<ThreadPool>(num_threads) : nullptr;
+        node_values_ = std::move(node_values);
+        node_hessians_ = std::move(node_hessians);
+    };
+
+    IndexType get_num_trees() const {
+        return trees_.size();
+    };
+
+    /**
+     * @brief a view of the fitted tree of index tree_index, the tree of round r
+     * for score s has index r * num_scores + s, its nodes hold the histograms
+     * [H, G] of GradientCriterion.
+    */
+    decisiontree::TreeView get_tree(IndexType tree_index) const {
+        return get_fitted_trees().at(tree_index);
+    };
+
+    /**
+     * @brief raw scores of X of shape (num_samples, num_features) into the
+     * caller-provided scores of shape (num_samples, num_scores), the log-odds
+     * of the second class for a binary problem, the softmax logits otherwise.
+    */
+    void decision_function(const DataView& X, double* scores) const {
+        check_num_features(X);
+        for_each_block(X.get_num_samples(), NUM_SAMPLES_PER_BLOCK, thread_pool_.get(), [&](IndexType begin, IndexType end) {
+            compute_block_scores(X, begin, end, &scores[begin * num_scores_]);
+        });
+    };
+
+    const std::vector<double> decision_function(const std::vector<FeatureType>& X) const {
+        NumSamplesType num_samples = X.size() / num_features_;
+        std::vector<double> scores(num_samples * num_scores_);
+        decision_function(DataView(X.data(), num_samples, num_features_), scores.data());
+
+        return scores;
+    };
+
+    /**
+     * @brief predict class probabilities of X of shape (num_samples, num_features)
+     * into the caller-provided proba of shape (num_samples, num_classes)
+    */
+    void predict_proba(const DataView& X, double* proba) const {
+        check_num_features(X);
+        for_each_block(X.get_num_samples(), NUM_SAMPLES_PER_BLOCK, thread_pool_.get(), [&](IndexType begin, IndexType end) {
+            double* block_scores = get_thread_buffer<double>(NUM_SAMPLES_PER_BLOCK * num_scores_);
+            compute_block_scores(X, begin, end, block_scores);
+            for (IndexType k = 0; k < end - begin; ++k) {
+                compute_proba(&block_scores[k * num_scores_], &proba[(begin + k) * num_classes_]);
+            }
+        });
+    };
+
+    void predict_proba(const FeatureType* X,
+                       NumSamplesType num_samples,
+                       double* proba) const {
+        predict_proba(DataView(X, num_samples, num_features_), proba);
+    };
+
+    const std::vector<double> predict_proba(const std::vector<FeatureType>& X) const {
+        NumSamplesType num_samples = X.size() / num_features_;
+        std::vector<double> proba(num_samples * num_classes_);
+        predict_proba(X.data(), num_samples, proba.data());
+
+        return proba;
+    };
+
+    /**
+     * @brief predict class labels of X of shape (num_samples, num_features)
+     * into the caller-provided y of shape (num_samples), the label of a
+     * sample is the class with the highest probability.
+    */
+    void predict(const DataView& X, ClassType* y) const {
+        check_num_features(X);
+        for_each_block(X.get_num_samples(), NUM_SAMPLES_PER_BLOCK, thread_pool_.get(), [&](IndexType begin, IndexType end) {
+            // scores of the block, then the probabilities of one sample
+            double* block_scores = get_thread_buffer<double>(NUM_SAMPLES_PER_BLOCK * num_scores_ + num_classes_);
+            double* sample_proba = &block_scores[NUM_SAMPLES_PER_BLOCK * num_scores_];
+            compute_block_scores(X, begin, end, block_scores);
+            for (IndexType k = 0; k < end - begin; ++k) {
+                compute_proba(&block_scores[k * num_scores_], sample_proba);
+                y[begin + k] = argmax<double, ClassType>(sample_proba, num_classes_);
+            }
+        });
+    };
+
+    void predict(const FeatureType* X,
+                 NumSamplesType num_samples,
+                 ClassType* y) const {
+        predict(DataView(X, num_samples, num_features_), y);
+    };
+
+    const std::vector<ClassType> predict(const std::vector<FeatureType>& X) const {
+        NumSamplesType num_samples = X.size() / num_features_;
+        std::vector<ClassType> label(num_samples, 0);
+        predict(X.data(), num_samples, label.data());
+
+        return label;
+    };
+
+    /**
+     * @brief the average of the normalized feature importances of the trees
+    */
+    const std::vector<double> compute_feature_importance() const {
+        const std::vector<decisiontree::TreeView>& trees = get_fitted_trees();
+        std::vector<double> f_importances(num_features_, 0.0);
+        std::vector<double> tree_importances;
+        for (const auto& tree : trees) {
+            tree.compute_feature_importance(tree_importances);
+            for (FeatureIndexType f = 0; f < num_features_; ++f) {
+                f_importances[f] += tree_importances[f] / trees.size();
+            }
+        }
+        return f_importances;
+    };
+};
+
+using GradientBoostingClassifier = BasicGradientBoostingClassifier<FeatureType, ClassType, SampleIndexType>;
+
+} // namespace
+
+#endif // ALGORITHM_GRADIENT_BOOSTING_CLASSIFIER_HPP_
@@ -0,0 +1,390 @@
+#ifndef ALGORITHM_RANDOM_FOREST_CLASSIFIER_HPP_
+#define ALGORITHM_RANDOM_FOREST_CLASSIFIER_HPP_
+
+#include "algorithm/fit_params.hpp"
+#include "common/prereqs.hpp"
+#include "core/builder.hpp"
+#include "core/dataset.hpp"
+#include "core/splitter.hpp"
+#include "core/tree.hpp"
+#include "utility/math.hpp"
+#include "utility/random.hpp"
+#include "utility/thread_pool.hpp"
+
+namespace decisiontree {
+
+/**
+ * @file random_forest_classifier.hpp
+ *
+ * @brief A random forest classifier, an ensemble of decision trees each
+ * grown in depth-first order on a bootstrap sample of the training data,
+ * the predicted probabilities are the average of those of the trees.
+ *
+ * The trees are grown concurrently on a thread pool, each thread claims
+ * the next tree to grow when it is done with the previous one. All trees
+ * read the same X and y, a tree only holds its own draws of sample indices.
+ * The random state of each tree is drawn from random_seed before growing,
+ * so the forest is the same whatever the number of threads.
+ *
+ * @param feature_names 1d array of string
+ *  which refers names to use for elements of input data given.
+ * @param class_labels 2d array of shape (num_outputs, num_classes)
+ *  which is 2d arrays of class labels, e.g {{<class1>, <class2>, ...}}
+ * @param num_estimators int default=100
+ *  the number of trees in the forest
+ * @param random_seed int default=0
+ *  controls the bootstrap samples and the randomness of the trees
+ * @param max_depth int default=4,
+ *  the maximum depth of each tree
+ * @param max_num_features int default=-1,
+ *  the number of features to consider when looking for the best split
+ *  if -1, then max_num_features = sqrt(num_features), else consider value
+ *  given by the user.
+ * @param min_samples_split int default=2
+ *  the minimum number of samples required to split an internal node.
+ * @param min_samples_leaf int default=1
+ *  the minimum number of samples required to be at a leaf node.
+ * @param min_weight_fraction_leaf double default=0.0
+ *  the minimum weighted fraction of the sum total of weights required to be at a leaf node
+ * @param class_balanced boolean default=true
+ *  indicate whether the class is balanced or not, the class weights are
+ *  computed once on the whole training data, see DecisionTreeClassifier
+ * @param criterion {"gini", "entropy"} default=gini
+ *  the criterion to measure the quality of a split
+ * @param split_policy {"random", "best", "hist"} default=best
+ *  the strategy used to choose the split at each node
+ * @param class_weight_ptr_ smart pointer to the class weight
+ *  if class_balanced=false, class_weight_ptr_ must be defined to
+ *  point to the self-defined class weight in the form {w, w, ..., }
+ * @param bootstrap boolean default=true
+ *  whether each tree is grown on num_samples samples drawn with replacement,
+ *  if false, each tree is grown on the whole training data
+ * @param num_threads int default=1
+ *  the number of threads to grow trees in parallel and to predict blocks
+ *  of samples in parallel, if -1, use all available cores.
+*/
+template<typename FeatureType, typename ClassType, typename SampleIndexType>
+class BasicRandomForestClassifier {
+private:
+    using DataView = BasicDataView<FeatureType>;
+    using Dataset = BasicDataset<FeatureType>;
+    using Splitter = BasicSplitter<FeatureType, ClassType, SampleIndexType>;
+    using DepthFirstTreeBuilder = BasicDepthFirstTreeBuilder<FeatureType, ClassType, SampleIndexType>;
+
+    std::vector<std::string> feature_names_;
+    std::vector<std::vector<std::string>> class_labels_;
+    int num_estimators_;
+    int random_seed_;
+    int max_depth_;
+    int max_num_features_;
+    int min_samples_split_;
+    int min_samples_leaf_;
+    double min_weight_fraction_leaf_;
+    bool class_balanced_;
+    std::string criterion_;
+    std::string split_policy_;
+    std::shared_ptr<std::vector<double>> class_weight_ptr_;
+    bool bootstrap_;
+    int num_threads_;
+
+    NumFeaturesType num_features_;
+    NumOutputsType num_outputs_;
+    NumClassesType max_num_classes_;
+    std::vector<NumClassesType> num_classes_list_;
+
+    std::vector<decisiontree::TreeView> trees_;
+
+    // pool growing the trees and predicting blocks of samples in parallel, 
+    // started by fit and shared by the concurrent calls of predict
+    std::shared_ptr<ThreadPool> thread_pool_;
+
+    const std::vector<decisiontree::TreeView>& get_fitted_trees() const {
+        if (trees_.empty()) {
+            throw std::runtime_error("The classifier is not fitted yet, call 'fit' first.");
+        }
+        return trees_;
+    };
+
+    void check_num_features(const DataView& X) const {
+        get_fitted_trees();
+        if (X.get_num_features() != num_features_) {
+            throw std::invalid_argument("Number of features of X does not match the forest.");
+        }
+    };
+
+    /**
+     * @brief sum the probabilities of all trees for samples X[begin:end] into
+     * proba, the trees are visited in the same order for any number of threads
+    */
+    void sum_block_proba(const DataView& X,
+                         IndexType begin,
+                         IndexType end,
+                         double* proba,
+                         double* tree_proba) const {
+        const IndexType proba_size = (end - begin) * num_outputs_ * max_num_classes_;
+        DataView X_block = X.slice(begin, end);
+        std::fill_n(proba, proba_size, 0.0);
+        for (const auto& tree : trees_) {
+            tree.predict_proba(X_block, tree_proba);
+            for (IndexType k = 0; k < proba_size; ++k) {
+                proba[k] += tree_proba[k];
+            }
+        }
+    };
+
+public:
+    BasicRandomForestClassifier(std::vector<std::string> feature_names,
+                                std::vector<std::vector<std::string>> class_labels,
+                                int num_estimators = 100,
+                                int random_seed = 0,
+                                int max_depth = 4,
+                                int max_num_features = -1,
+                                int min_samples_split = 2,
+                                int min_samples_leaf = 1,
+                                double min_weight_fraction_leaf = 0.0,
+                                bool class_balanced = true,
+                                std::string criterion = "gini",
+                                std::string split_policy = "best",
+                                std::shared_ptr<std::vector<double>> class_weight_ptr = nullptr,
+                                bool bootstrap = true,
+                                int num_threads = 1):
+                        feature_names_(feature_names),
+                        class_labels_(class_labels),
+                        num_estimators_(num_estimators),
+                        random_seed_(random_seed),
+                        max_depth_(max_depth),
+                        max_num_features_(max_num_features),
+                        min_samples_split_(min_samples_split),
+                        min_samples_leaf_(min_samples_leaf),
+                        min_weight_fraction_leaf_(min_weight_fraction_leaf),
+                        class_balanced_(class_balanced),
+                        criterion_(criterion),
+                        split_policy_(split_policy),
+                        class_weight_ptr_(class_weight_ptr),
+                        bootstrap_(bootstrap),
+                        num_threads_(num_threads),
+                        num_features_(feature_names.size()),
+                        num_outputs_(class_labels.size()) {
+
+        num_classes_list_.resize(class_labels_.size(), 0);
+        for (std::size_t o=0; o < class_labels_.size(); o++) {
+            num_classes_list_[o] = class_labels_[o].size();
+        }
+
+        max_num_classes_ = *std::max_element(begin(num_classes_list_),
+                                             end(num_classes_list_));
+    };
+
+    ~BasicRandomForestClassifier() {};
+
+    /**
+     * @brief fit on the row-major X of shape (num_samples, num_features),
+     * X is copied once into a column-major dataset shared by all trees.
+    */
+    void fit(const std::vector<FeatureType>& X,
+             const std::vector<ClassType>& y) {
+        Dataset dataset(X, num_features_);
+        fit(dataset.get_view(), y);
+    };
+
+    /**
+     * @brief fit on X of shape (num_samples, num_features) held by the
+     * caller in any layout, X and y are read in place by all trees.
+    */
+    void fit(const DataView& X,
+             const std::vector<ClassType>& y) {
+        NumSamplesType num_samples = y.size() / num_outputs_;
+        if (X.get_num_features() != num_features_ || X.get_num_samples() != num_samples) {
+            throw std::invalid_argument("Shape of X does not match the features and the number of samples of y.");
+        }
+
+        // check num_estimators
+        if (num_estimators_ < 1) {
+            throw std::invalid_argument("num_estimators must be positive.");
+        }
+
+        // check the growth of the trees, the default considers sqrt(num_features) features
+        NumFeaturesType sqrt_num_features = std::max<NumFeaturesType>(
+            static_cast<NumFeaturesType>(std::sqrt(static_cast<double>(num_features_))), 1
+        );
+        TreeParams tree_params = check_tree_params(max_depth_,
+                                                   min_samples_split_,
+                                                   min_samples_leaf_,
+                                                   max_num_features_,
+                                                   num_features_,
+                                                   sqrt_num_features);
+
+        // check class_weight and min_weight_leaf, computed once on the whole training data
+        ClassWeightParams class_weight_params = compute_class_weight_params(y,
+                                                                            num_outputs_,
+                                                                            num_classes_list_,
+                                                                            max_num_classes_,
+                                                                            class_balanced_,
+                                                                            class_weight_ptr_,
+                                                                            min_weight_fraction_leaf_);
+        const std::vector<double>& class_weight = class_weight_params.class_weight;
+
+        // check criterion, the splitter also accepts the gradient criterion of boosting
+        check_criterion_clf(criterion_);
+
+        // check num_threads
+        NumThreadsType num_threads = check_num_threads(num_threads_);
+
+        // the splitter checks the split policy,
+        // each tree grows with a copy of it on a single thread
+        RandomState random_state = (random_seed_ == -1) ? RandomState() : RandomState(random_seed_);
+        Splitter splitter(num_outputs_,
+                          num_samples,
+                          num_features_,
+                          tree_params.max_num_features,
+                          max_num_classes_,
+                          class_weight,
+                          num_classes_list_,
+                          criterion_,
+                          split_policy_,
+                          random_state);
+
+        // seeds of the trees are drawn up front, in the order of the trees
+        std::vector<unsigned long> seeds(num_estimators_);
+        for (auto& seed : seeds) {
+            seed = static_cast<unsigned long>(random_state.uniform_int(0, LONG_MAX));
+        }
+
+        // the trees share the lookup tables of the features, only 
+        // their draws of the samples are their own
+        splitter.init_feature_tables(X);
+
+        std::vector<decisiontree::TreeView> trees(num_estimators_);
+        thread_pool_ = std::make_shared<ThreadPool>(num_threads);
+        thread_pool_->parallel_for(0, num_estimators_, [&](IndexType t) {
+            RandomState tree_random_state(seeds[t]);
+            Splitter tree_splitter(splitter);
+            if (bootstrap_) {
+                std::vector<SampleIndexType> draws(num_samples);
+                for (auto& draw : draws) {
+                    draw = static_cast<SampleIndexType>(tree_random_state.uniform_int(0, num_samples));
+                }
+                tree_splitter.set_sample_indices(draws);
+            }
+            tree_splitter.set_random_state(tree_random_state);
+
+            DepthFirstTreeBuilder builder(tree_params.max_depth,
+                                          tree_params.min_samples_split,
+                                          tree_params.min_samples_leaf,
+                                          class_weight_params.min_weight_leaf,
+                                          class_weight,
+                                          std::move(tree_splitter),
+                                          decisiontree::Tree(num_outputs_, num_features_, num_classes_list_));
+            builder.build(X, y, num_samples);
+
+            auto tree_ptr = std::make_shared<const decisiontree::Tree>(std::move(builder.tree_));
+            trees[t] = tree_ptr->get_view(tree_ptr);
+        });
+        trees_ = std::move(trees);
+    };
+
+    IndexType get_num_trees() const {
+        return trees_.size();
+    };
+
+    /**
+     * @brief a view of the fitted tree of index tree_index, it keeps the
+     * tree alive if the classifier is fitted again or destroyed.
+    */
+    decisiontree::TreeView get_tree(IndexType tree_index) const {
+        return get_fitted_trees().at(tree_index);
+    };
+
+    /**
+     * @brief predict class probabilities of X of shape (num_samples, num_features)
+     * into the caller-provided proba of shape (num_samples, num_outputs, max_num_classes),
+     * the average of the probabilities of the trees. Blocks of samples are
+     * predicted in parallel, each block goes through all the trees.
+    */
+    void predict_proba(const DataView& X, double* proba) const {
+        check_num_features(X);
+        const IndexType proba_size = num_outputs_ * max_num_classes_;
+        const double scale = 1.0 / trees_.size();
+        for_each_block(X.get_num_samples(), NUM_SAMPLES_PER_BLOCK, thread_pool_.get(), [&](IndexType begin, IndexType end) {
+            double* tree_proba = get_thread_buffer<double>((end - begin) * proba_size);
+            double* block_proba = &proba[begin * proba_size];
+            sum_block_proba(X, begin, end, block_proba, tree_proba);
+            for (IndexType k = 0; k < (end - begin) * proba_size; ++k) {
+                block_proba[k] *= scale;
+            }
+        });
+    };
+
+    void predict_proba(const FeatureType* X,
+                       NumSamplesType num_samples,
+                       double* proba) const {
+        predict_proba(DataView(X, num_samples, num_features_), proba);
+    };
+
+    const std::vector<double> predict_proba(const std::vector<FeatureType>& X) const {
+        NumSamplesType num_samples = X.size() / num_features_;
+        std::vector<double> proba(num_samples * num_outputs_ * max_num_classes_);
+        predict_proba(X.data(), num_samples, proba.data());
+
+        return proba;
+    };
+
+    /**
+     * @brief predict class labels of X of shape (num_samples, num_features)
+     * into the caller-provided y of shape (num_samples, num_outputs), the
+     * label of a sample is the class with the highest average probability.
+    */
+    void predict(const DataView& X, ClassType* y) const {
+        check_num_features(X);
+        const IndexType proba_size = num_outputs_ * max_num_classes_;
+        for_each_block(X.get_num_samples(), NUM_SAMPLES_PER_BLOCK, thread_pool_.get(), [&](IndexType begin, IndexType end) {
+            // the sum of the trees, then the probabilities of the current tree
+            double* block_proba = get_thread_buffer<double>(2 * (end - begin) * proba_size);
+            double* tree_proba = block_proba + (end - begin) * proba_size;
+            sum_block_proba(X, begin, end, block_proba, tree_proba);
+            for (IndexType k = 0; k < end - begin; ++k) {
+                for (IndexType o = 0; o < num_outputs_; ++o) {
+                    y[(begin + k) * num_outputs_ + o] = argmax<double, ClassType>(
+                        &block_proba[k * proba_size + o * max_num_classes_], num_classes_list_[o]
+                    );
+                }
+            }
+        });
+    };
+
+    void predict(const FeatureType* X,
+                 NumSamplesType num_samples,
+                 ClassType* y) const {
+        predict(DataView(X, num_samples, num_features_), y);
+    };
+
+    const std::vector<ClassType> predict(const std::vector<FeatureType>& X) const {
+        NumSamplesType num_samples = X.size() / num_features_;
+        std::vector<ClassType> label(num_samples * num_outputs_, 0);
+        predict(X.data(), num_samples, label.data());
+
+        return label;
+    };
+
+    /**
+     * @brief the average of the normalized feature importances of the trees
+    */
+    const std::vector<double> compute_feature_importance() const {
+        const std::vector<decisiontree::TreeView>& trees = get_fitted_trees();
+        std::vector<double> f_importances(num_features_, 0.0);
+        std::vector<double> tree_importances;
+        for (const auto& tree : trees) {
+            tree.compute_feature_importance(tree_importances);
+            for (FeatureIndexType f = 0; f < num_features_; ++f) {
+                f_importances[f] += tree_importances[f] / trees.size();
+            }
+        }
+        return f_importances;
+    };
+};
+
+using RandomForestClassifier = BasicRandomForestClassifier<FeatureType, ClassType, SampleIndexType>;
+
+} // namespace
+
+#endif // ALGORITHM_RANDOM_FOREST_CLASSIFIER_HPP_
@@ -2,17 +2,28 @@
 #define COMMON_PREREQS_HPP_
 
 #include <algorithm>
+#include <atomic>
 #include <climits>
 #include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <numeric>
+#include <queue>
 #include <random>
 #include <sstream>
 #include <stack>
 #include <string>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <unordered_set>
 #include <vector>
@@ -34,11 +45,41 @@ using FeatureIndexType = unsigned long;
 using SampleIndexType = unsigned long;
 
 using TreeDepthType = unsigned long;
+using NumNodesType = unsigned long;
+
+using BinType = std::uint8_t;
+using NumBinsType = unsigned long;
+
+using NumThreadsType = unsigned long;
 
 const double EPSILON = 1e-7;
 
+// histogram split policy keeps at most 255 bins for non-missing values,
+// the last bin value is reserved for missing values
+const NumBinsType MAX_NUM_BINS = 255;
+const BinType MISSING_VALUE_BIN = 255;
+
+// categorical features hold integer category codes in [0, MAX_NUM_CATEGORIES)
+const NumBinsType MAX_NUM_CATEGORIES = 65536;
+
+// minimum number of samples at a node to search the split features in parallel
+const NumSamplesType MIN_PARALLEL_NUM_SAMPLES = 4096;
+
+// number of samples which descend the tree together when predicting
+const NumSamplesType NUM_SAMPLES_PER_BLOCK = 64;
+
+// number of nodes of the first chunk of node records of a tree builder
+const NumNodesType NUM_NODES_PER_CHUNK = 1024;
+
+// size in bytes of a cache line, buffers scanned in hot loops are aligned to it
+const std::size_t CACHE_LINE_SIZE = 64;
+
 const std::unordered_set<std::string> CRITERIA_CLF = {"gini", "entropy"};
 
-const std::unordered_set<std::string> SPLIT_STRATEGY = {"best", "random"};
+const std::unordered_set<std::string> SPLIT_STRATEGY = {"best", "random", "hist"};
+
+// criterion and split policy, selected once from their names
+enum class CriterionKind {gini, entropy, gradient};
+enum class SplitPolicy {best, random, hist};
 
 #endif // COMMON_PREREQS_HPP_
\ No newline at end of file
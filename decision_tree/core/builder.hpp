@@ -2,7 +2,10 @@
 #define CORE_BUILDER_HPP_
 
 #include "common/prereqs.hpp"
+#include "utility/chunked_arena.hpp"
+#include "utility/profiler.hpp"
 #include "utility/random.hpp"
+#include "utility/thread_pool.hpp"
 
 #include "splitter.hpp"
 #include "tree.hpp"
@@ -10,130 +13,634 @@
 namespace decisiontree {
 
 /**
- * @brief build a binary decision tree in depth-first order.
+ * @brief base class of the tree builders, it holds the stopping 
+ * parameters, the splitter and the tree to grow. 
+ * 
+ * Each node is split with a random state seeded by a key of its own, 
+ * derived from a seed drawn from the splitter at construction, from the 
+ * number of trees built before and from the path from the root to the 
+ * node. The tree only depends on the seed, whatever the order the nodes 
+ * are split in, so all builders grow the same nodes for the same seed, 
+ * with any number of threads.
+ * 
+ * The builders record the nodes in a chunked arena while growing the 
+ * tree, the arena grows with the number of nodes up to the most nodes 
+ * a tree on the samples can have, and never copies a record. The nodes 
+ * are added to the tree at the end, whose arrays are allocated once.
 */
-class DepthFirstTreeBuilder {
-private:
+template<typename FeatureType, typename ClassType, typename SampleIndexType>
+class BasicTreeBuilder {
+protected:
+    using DataView = BasicDataView<FeatureType>;
+    using Splitter = BasicSplitter<FeatureType, ClassType, SampleIndexType>;
+    using NodeHistograms = typename Splitter::NodeHistograms;
+
     TreeDepthType max_depth_;
     NumSamplesType min_samples_split_;
     NumSamplesType min_samples_leaf_;
     ClassWeightType min_weight_leaf_;
     std::vector<ClassWeightType> class_weight_;
-    decisiontree::Splitter splitter_;
-    
-    // node information stack
-    // node_info_stk = [start, end, depth, parent_index, is_left]
-    struct NodeInfo {
+    Splitter splitter_;
+
+    // a node is split only if the improvement of its split is larger
+    double min_improvement_;
+
+    // the random keys of the nodes of the tree built k-th derive from 
+    // seed_ and k, num_builds_ is the number of trees built
+    std::uint64_t seed_;
+    std::uint64_t num_builds_;
+
+    // node_ranges_[i] = [start, end] of node i of the tree built last
+    std::vector<std::pair<SampleIndexType, SampleIndexType>> node_ranges_;
+
+    // time and work of the build of the tree built last
+    TrainingProfile profile_;
+
+    // node record = [start, end, depth, is_left, random key, split of the node, 
+    // children], a record holds its histograms derived from its parent, and 
+    // once split the histograms of its children until they are recorded
+    struct NodeRecord {
         SampleIndexType start;
         SampleIndexType end;
         TreeDepthType depth;
-        NodeIndexType parent_index;
         bool is_left;
+        std::uint64_t random_key;
+        bool is_leaf;
+        FeatureIndexType feature_index;
+        SampleIndexType partition_index;
+        FeatureType partition_threshold;
+        double impurity;
+        double improvement;
+        int has_missing_value;
+        std::vector<std::uint64_t> categories;
+        std::vector<std::vector<HistogramType>> histogram;
+        IndexType left_record;
+        IndexType right_record;
+        NodeHistograms histograms;
+        std::unique_ptr<NodeHistograms[]> children_histograms;
 
-        NodeInfo(SampleIndexType start, 
-                 SampleIndexType end, 
-                 TreeDepthType depth, 
-                 NodeIndexType parent_index, 
-                 bool is_left): start(start), 
+        NodeRecord(SampleIndexType start, 
+                   SampleIndexType end, 
+                   TreeDepthType depth, 
+                   bool is_left, 
+                   std::uint64_t random_key): start(start), 
             end(end), 
             depth(depth), 
-            parent_index(parent_index), 
-            is_left(is_left) {};
-        ~NodeInfo() {};
+            is_left(is_left), 
+            random_key(random_key), 
+            is_leaf(true), 
+            feature_index(0), 
+            partition_index(0), 
+            partition_threshold(std::numeric_limits<double>::quiet_NaN()), 
+            impurity(0.0), 
+            improvement(0.0), 
+            has_missing_value(-1), 
+            left_record(0), 
+            right_record(0) {};
+        NodeRecord(NodeRecord&&) = default;
+        NodeRecord& operator=(NodeRecord&&) = default;
+        ~NodeRecord() {};
+
+        /**
+         * @brief turn a split node back into a leaf
+        */
+        void make_leaf() {
+            is_leaf = true;
+            feature_index = 0;
+            partition_index = 0;
+            partition_threshold = std::numeric_limits<double>::quiet_NaN();
+            improvement = 0.0;
+            has_missing_value = -1;
+            categories.clear();
+            children_histograms.reset();
+        };
+    };
+    using NodeRecords = ChunkedArena<NodeRecord>;
+
+    /**
+     * @brief the most nodes a tree on num_samples samples can have, each 
+     * leaf holds at least one sample and at most 2^max_depth leaves fit 
+     * in the depth
+    */
+    NumNodesType compute_max_num_nodes(NumSamplesType num_samples) const {
+        NumNodesType max_leaf_nodes = std::max<NumSamplesType>(num_samples, 1);
+        if (max_depth_ < std::numeric_limits<NumNodesType>::digits - 1) {
+            max_leaf_nodes = std::min<NumNodesType>(max_leaf_nodes, NumNodesType(1) << max_depth_);
+        }
+        return 2 * max_leaf_nodes - 1;
+    };
+
+    /**
+     * @brief compute histogram and impurity of one node, split it if it is not 
+     * a leaf and derive the histograms of its children. 
+     * 
+     * @param with_bin_histograms the children also derive the bins of the hist 
+     *      split policy, e.g. false if the records of a whole depth or frontier 
+     *      are alive at once, each would hold the bins of all features
+    */
+    void split_record(const DataView& X, 
+                      const std::vector<ClassType>& y, 
+                      Splitter& splitter, 
+                      NodeRecord& record, 
+                      bool with_bin_histograms = false) {
+        // init weighted class histogram and inpurity for the current node
+        splitter.set_random_state(RandomState(record.random_key));
+        splitter.init_node(y, record.start, record.end, std::move(record.histograms));
+        record.histogram = splitter.criterion_ptr_->get_node_weighted_histogram();
+        record.impurity = splitter.criterion_ptr_->get_node_impurity();
+
+        // get number of samples at the current node
+        NumSamplesType num_node_samples = record.end - record.start;
+
+        record.is_leaf = (record.depth >= max_depth_) ||
+                         (num_node_samples < min_samples_split_) || 
+                         (num_node_samples < 2 * min_samples_leaf_) || 
+                         (num_node_samples < 2 * min_weight_leaf_) ||
+                         (record.impurity <= EPSILON);
+
+        // if not leaf node, split samples[start:end]
+        if (!record.is_leaf) {
+            splitter.split_node(X, y, 
+                                record.feature_index, 
+                                record.partition_index, 
+                                record.partition_threshold, 
+                                record.improvement, 
+                                record.has_missing_value);
+            if (record.improvement <= min_improvement_) {
+                record.is_leaf = true;
+            }
+            else {
+                record.categories = splitter.get_split_categories();
+                record.children_histograms.reset(new NodeHistograms[2]);
+                splitter.init_children(y, record.partition_index, with_bin_histograms, 
+                                       record.children_histograms[0], 
+                                       record.children_histograms[1]);
+            }
+        }
+    };
+
+    /**
+     * @brief append the root record of the next tree on num_samples samples
+    */
+    void add_root_record(NodeRecords& records, NumSamplesType num_samples) {
+        records.emplace_back(0, num_samples, 0, false, RandomState::derive_seed(seed_, num_builds_++));
+    };
+
+    /**
+     * @brief append the children of the split record r to records, 
+     * each child takes over the histograms derived for it, and its 
+     * random key is the key of r derived for its side
+    */
+    void add_children_records(NodeRecords& records, IndexType r) {
+        NodeRecord& record = records[r];
+        record.left_record = records.size();
+        records.emplace_back(record.start, record.partition_index, record.depth + 1, true, 
+                             RandomState::derive_seed(record.random_key, 0));
+        records.back().histograms = std::move(record.children_histograms[0]);
+        record.right_record = records.size();
+        records.emplace_back(record.partition_index, record.end, record.depth + 1, false, 
+                             RandomState::derive_seed(record.random_key, 1));
+        records.back().histograms = std::move(record.children_histograms[1]);
+        record.children_histograms.reset();
+    };
+
+    /**
+     * @brief presort or bin the feature columns once if required by the 
+     * splitter, the profile of a build starts here
+    */
+    void init_features(const DataView& X) {
+        profile_.clear();
+        splitter_.clear_profile();
+        DECISIONTREE_PROFILE_TIME(profile_.init_features_time);
+        splitter_.init_features(X);
+    };
+
+    /**
+     * @brief add the nodes of records to the tree in depth-first order 
+     * from records[0], the children of a split record are found by 
+     * its left_record and right_record.
+    */
+    void add_records_to_tree(const NodeRecords& records) {
+        // stack = [record index, parent node index]
+        tree_.reserve(records.size());
+        node_ranges_.clear();
+        node_ranges_.reserve(records.size());
+        std::stack<std::pair<IndexType, NodeIndexType>> record_stk;
+        record_stk.push(std::make_pair(0, 0));
+        while (!record_stk.empty()) {
+            const NodeRecord& record = records[record_stk.top().first];
+            NodeIndexType parent_index = record_stk.top().second;
+            record_stk.pop();
+
+            NodeIndexType node_index = tree_.add_node(record.is_left, 
+                                                      record.depth, 
+                                                      parent_index, 
+                                                      record.feature_index, 
+                                                      record.has_missing_value, 
+                                                      record.partition_threshold, 
+                                                      record.impurity, 
+                                                      record.improvement, 
+                                                      record.histogram, 
+                                                      record.categories);
+            node_ranges_.emplace_back(record.start, record.end);
+            DECISIONTREE_PROFILE_RECORD(profile_.add_node(record.depth));
+            if (!record.is_leaf) {
+                record_stk.push(std::make_pair(record.right_record, node_index));
+                record_stk.push(std::make_pair(record.left_record, node_index));
+            }
+        }
     };
 
 public:
     decisiontree::Tree tree_;
-    DepthFirstTreeBuilder() {};
-    DepthFirstTreeBuilder(TreeDepthType max_depth, 
-                          NumSamplesType min_samples_split, 
-                          NumSamplesType min_samples_leaf, 
-                          ClassWeightType min_weight_leaf, 
-                          std::vector<ClassWeightType> class_weight, 
-                          const decisiontree::Splitter& splitter, 
-                          const decisiontree::Tree& tree): max_depth_(max_depth), 
+    BasicTreeBuilder(): min_improvement_(EPSILON), seed_(0), num_builds_(0) {};
+    BasicTreeBuilder(TreeDepthType max_depth, 
+                     NumSamplesType min_samples_split, 
+                     NumSamplesType min_samples_leaf, 
+                     ClassWeightType min_weight_leaf, 
+                     std::vector<ClassWeightType> class_weight, 
+                     Splitter splitter, 
+                     decisiontree::Tree tree): max_depth_(max_depth), 
                     min_samples_split_(min_samples_split), 
                     min_samples_leaf_(min_samples_leaf), 
                     min_weight_leaf_(min_weight_leaf), 
                     class_weight_(class_weight), 
-                    splitter_(splitter), 
-                    tree_(tree) {};
+                    splitter_(std::move(splitter)), 
+                    min_improvement_(EPSILON), 
+                    num_builds_(0), 
+                    tree_(std::move(tree)) {
+        seed_ = splitter_.spawn_seed();
+    };
 
-    ~DepthFirstTreeBuilder() {};
+    virtual ~BasicTreeBuilder() {};
 
+    /**
+     * @brief set the improvement a split must exceed, EPSILON by default, 
+     * e.g. the minimum Newton gain of the gradient criterion, whose gains 
+     * are not fractions of an impurity
+    */
+    void set_min_improvement(double min_improvement) {
+        min_improvement_ = min_improvement;
+    };
+
+    /**
+     * @brief build the tree on the samples of X, read in any layout 
+     * through the view, X is not copied
+    */
+    virtual void build(const DataView& X, 
+                       const std::vector<ClassType>& y, 
+                       NumSamplesType num_samples) = 0;
+
+    /**
+     * @brief build the tree on the row-major X of shape (num_samples, num_features)
+    */
     void build(const std::vector<FeatureType>& X, 
                const std::vector<ClassType>& y, 
                NumSamplesType num_samples) {
+        NumFeaturesType num_features = (num_samples > 0) ? X.size() / num_samples : 0;
+        build(DataView(X.data(), num_samples, num_features), y, num_samples);
+    };
+
+    /**
+     * @brief the samples of node i of the tree built last are 
+     * get_sample_indices()[start:end] with [start, end] = get_node_ranges()[i], 
+     * e.g. to update per-sample values from the leaves without traversing the tree
+    */
+    const std::vector<std::pair<SampleIndexType, SampleIndexType>>& get_node_ranges() const {
+        return node_ranges_;
+    };
+
+    const std::vector<SampleIndexType>& get_sample_indices() const {
+        return splitter_.get_sample_indices();
+    };
+
+    /**
+     * @brief time and work of the build of the tree built last, empty 
+     * unless DECISIONTREE_PROFILE is defined
+    */
+    const TrainingProfile& get_profile() const {
+        return profile_;
+    };
+};
+
+/**
+ * @brief build a binary decision tree in depth-first order.
+*/
+template<typename FeatureType, typename ClassType, typename SampleIndexType>
+class BasicDepthFirstTreeBuilder: public BasicTreeBuilder<FeatureType, ClassType, SampleIndexType> {
+private:
+    using Base = BasicTreeBuilder<FeatureType, ClassType, SampleIndexType>;
+    using DataView = BasicDataView<FeatureType>;
+    using Splitter = BasicSplitter<FeatureType, ClassType, SampleIndexType>;
+
+    using Base::max_depth_;
+    using Base::min_samples_split_;
+    using Base::min_samples_leaf_;
+    using Base::min_weight_leaf_;
+    using Base::splitter_;
+    using typename Base::NodeRecord;
+    using typename Base::NodeRecords;
+    using Base::compute_max_num_nodes;
+    using Base::split_record;
+    using Base::add_root_record;
+    using Base::add_children_records;
+    using Base::add_records_to_tree;
+    using Base::init_features;
+    using Base::profile_;
+
+public:
+    BasicDepthFirstTreeBuilder() {};
+    BasicDepthFirstTreeBuilder(TreeDepthType max_depth, 
+                               NumSamplesType min_samples_split, 
+                               NumSamplesType min_samples_leaf, 
+                               ClassWeightType min_weight_leaf, 
+                               std::vector<ClassWeightType> class_weight, 
+                               Splitter splitter, 
+                               decisiontree::Tree tree): Base(max_depth, 
+                                                              min_samples_split, 
+                                                              min_samples_leaf, 
+                                                              min_weight_leaf, 
+                                                              class_weight, 
+                                                              std::move(splitter), 
+                                                              std::move(tree)) {};
+
+    ~BasicDepthFirstTreeBuilder() {};
+
+    using Base::build;
+    using Base::tree_;
+
+    void build(const DataView& X, 
+               const std::vector<ClassType>& y, 
+               NumSamplesType num_samples) override {
         
-        std::stack<NodeInfo> node_info_stk;
-        // push root node info into stack
-        node_info_stk.push(NodeInfo(0, num_samples, 0, 0, false));
-
-        // allocate a memory of size (2**((max_depth_ + 1))) - 1
-        // init node list of tree
-        tree_.nodes_.reserve((1u << (max_depth_ + 1)) - 1);
-
-        while(!node_info_stk.empty()) {
-            NodeInfo node_info = node_info_stk.top();
-            node_info_stk.pop();
-
-            // init weighted class histogram and inpurity for the current node
-            splitter_.init_node(y, node_info.start, node_info.end);
-            std::vector<std::vector<HistogramType>> histogram = splitter_.criterion_ptr_->get_node_weighted_histogram();
-            double impurity = splitter_.criterion_ptr_->get_node_impurity();
-
-            // get number of samples at the current node
-            NumSamplesType num_node_samples = node_info.end - node_info.start;
-
-            bool is_leaf = (node_info.depth >= max_depth_) ||
-                           (num_node_samples < min_samples_split_) || 
-                           (num_node_samples < 2 * min_samples_leaf_) || 
-                           (num_node_samples < 2 * min_weight_leaf_) ||
-                           (impurity <= EPSILON);
-
-            FeatureIndexType feature_index = 0;
-            SampleIndexType partition_index = 0;
-            FeatureType partition_threshold = std::numeric_limits<double>::quiet_NaN();
-            double improvement = 0.0;
-            int has_missing_value = -1;
-
-            // if not leaf node, split samples[start:end]
-            if (!is_leaf) {
-                splitter_.split_node(X, y, 
-                                     feature_index, 
-                                     partition_index, 
-                                     partition_threshold, 
-                                     improvement, 
-                                     has_missing_value);
-                if (improvement <= EPSILON) {
-                    is_leaf = true;
+        // presort feature columns once if required by splitter
+        init_features(X);
+        DECISIONTREE_PROFILE_TIME(profile_.build_time);
+
+        // records grow in chunks from NUM_NODES_PER_CHUNK nodes
+        NumNodesType max_num_nodes = compute_max_num_nodes(num_samples);
+        NodeRecords records(std::min(max_num_nodes, NUM_NODES_PER_CHUNK), max_num_nodes);
+        add_root_record(records, num_samples);
+
+        // stack of records to split, the left child is split first
+        std::stack<IndexType> record_stk;
+        record_stk.push(0);
+        while (!record_stk.empty()) {
+            IndexType r = record_stk.top();
+            record_stk.pop();
+
+            // the smaller child is counted and the larger one is the parent minus it, 
+            // at most one pending node per depth holds the bins of all features
+            split_record(X, y, splitter_, records[r], records[r].depth + 1 < max_depth_);
+            if (!records[r].is_leaf) {
+                add_children_records(records, r);
+                record_stk.push(records[r].right_record);
+                record_stk.push(records[r].left_record);
+            }
+        }
+
+        // add nodes to tree in depth-first order
+        add_records_to_tree(records);
+        DECISIONTREE_PROFILE_RECORD(splitter_.get_profile(profile_));
+    };
+
+};
+
+/**
+ * @brief build a binary decision tree in breadth-first order, the nodes 
+ * of one depth are split concurrently on a thread pool, each thread with 
+ * a splitter of its own on the shared sample order.
+ * 
+ * Nodes are added to the tree in depth-first order at the end, and each 
+ * node is split with the random state of its key, so the tree is the 
+ * same as with DepthFirstTreeBuilder for the same seed.
+*/
+template<typename FeatureType, typename ClassType, typename SampleIndexType>
+class BasicBreadthFirstTreeBuilder: public BasicTreeBuilder<FeatureType, ClassType, SampleIndexType> {
+private:
+    using Base = BasicTreeBuilder<FeatureType, ClassType, SampleIndexType>;
+    using DataView = BasicDataView<FeatureType>;
+    using Splitter = BasicSplitter<FeatureType, ClassType, SampleIndexType>;
+
+    using Base::max_depth_;
+    using Base::min_samples_split_;
+    using Base::min_samples_leaf_;
+    using Base::min_weight_leaf_;
+    using Base::splitter_;
+    using typename Base::NodeRecord;
+    using typename Base::NodeRecords;
+    using Base::compute_max_num_nodes;
+    using Base::split_record;
+    using Base::add_root_record;
+    using Base::add_children_records;
+    using Base::add_records_to_tree;
+    using Base::init_features;
+    using Base::profile_;
+
+    NumThreadsType num_threads_;
+
+public:
+    BasicBreadthFirstTreeBuilder() {};
+    BasicBreadthFirstTreeBuilder(TreeDepthType max_depth, 
+                                 NumSamplesType min_samples_split, 
+                                 NumSamplesType min_samples_leaf, 
+                                 ClassWeightType min_weight_leaf, 
+                                 std::vector<ClassWeightType> class_weight, 
+                                 Splitter splitter, 
+                                 decisiontree::Tree tree, 
+                                 NumThreadsType num_threads = 0): Base(max_depth, 
+                                                                       min_samples_split, 
+                                                                       min_samples_leaf, 
+                                                                       min_weight_leaf, 
+                                                                       class_weight, 
+                                                                       std::move(splitter), 
+                                                                       std::move(tree)), 
+                    num_threads_(num_threads) {};
+
+    ~BasicBreadthFirstTreeBuilder() {};
+
+    using Base::build;
+    using Base::tree_;
+
+    void build(const DataView& X, 
+               const std::vector<ClassType>& y, 
+               NumSamplesType num_samples) override {
+
+        // presort or bin feature columns once if required by splitter
+        init_features(X);
+        DECISIONTREE_PROFILE_TIME(profile_.build_time);
+
+        // one splitter per thread, all of them on the sample order of splitter_
+        auto thread_pool = std::make_shared<ThreadPool>(num_threads_);
+        NumThreadsType num_threads = thread_pool->get_num_threads();
+        std::vector<Splitter> splitters;
+        splitters.reserve(num_threads);
+        for (NumThreadsType t = 0; t < num_threads; ++t) {
+            splitters.emplace_back(splitter_, true);
+            splitters.back().set_thread_pool(thread_pool);
+        }
+
+        // records of all nodes in breadth-first order, 
+        // records[level_begin:level_end] is the current depth
+        NumNodesType max_num_nodes = compute_max_num_nodes(num_samples);
+        NodeRecords records(std::min(max_num_nodes, NUM_NODES_PER_CHUNK), max_num_nodes);
+        add_root_record(records, num_samples);
+        IndexType level_begin = 0, level_end = 1;
+        while (level_begin < level_end) {
+            // split the nodes of the current depth concurrently
+            std::atomic<IndexType> next_record(level_begin);
+            thread_pool->parallel_for(0, num_threads, [&](IndexType task) {
+                IndexType r;
+                while ((r = next_record++) < level_end) {
+                    split_record(X, y, splitters[task], records[r]);
+                }
+            });
+
+            // children of split nodes are the next depth
+            for (IndexType r = level_begin; r < level_end; ++r) {
+                if (!records[r].is_leaf) {
+                    add_children_records(records, r);
                 }
             }
-            // add node to tree
-            NodeIndexType node_index = tree_.add_node(node_info.is_left, 
-                                                      node_info.depth, 
-                                                      node_info.parent_index, 
-                                                      feature_index, 
-                                                      has_missing_value, 
-                                                      partition_threshold, 
-                                                      impurity, 
-                                                      improvement, 
-                                                      histogram);
-
-            if (!is_leaf) {
-                // push right child node info into the stack
-                node_info_stk.emplace(NodeInfo(partition_index, node_info.end, node_info.depth + 1, node_index, false));
-
-                // push left child node info into the stack
-                node_info_stk.emplace(NodeInfo(node_info.start, partition_index, node_info.depth + 1, node_index, true));
+            level_begin = level_end;
+            level_end = records.size();
+        }
+
+        // add nodes to tree in depth-first order
+        add_records_to_tree(records);
+        for (const auto& splitter : splitters) {
+            DECISIONTREE_PROFILE_RECORD(splitter.get_profile(profile_));
+        }
+    };
+
+};
+
+/**
+ * @brief build a binary decision tree in best-first order, the split 
+ * node with the highest improvement among the frontier is expanded 
+ * next until the tree has max_leaf_nodes leaves. Split nodes left 
+ * in the frontier become leaves, nodes are added to the tree in 
+ * depth-first order at the end.
+*/
+template<typename FeatureType, typename ClassType, typename SampleIndexType>
+class BasicBestFirstTreeBuilder: public BasicTreeBuilder<FeatureType, ClassType, SampleIndexType> {
+private:
+    using Base = BasicTreeBuilder<FeatureType, ClassType, SampleIndexType>;
+    using DataView = BasicDataView<FeatureType>;
+    using Splitter = BasicSplitter<FeatureType, ClassType, SampleIndexType>;
+
+    using Base::max_depth_;
+    using Base::min_samples_split_;
+    using Base::min_samples_leaf_;
+    using Base::min_weight_leaf_;
+    using Base::splitter_;
+    using typename Base::NodeRecord;
+    using typename Base::NodeRecords;
+    using Base::compute_max_num_nodes;
+    using Base::split_record;
+    using Base::add_root_record;
+    using Base::add_children_records;
+    using Base::add_records_to_tree;
+    using Base::init_features;
+    using Base::profile_;
+
+    NumNodesType max_leaf_nodes_;
+
+    // frontier record = [improvement, record index], the highest 
+    // improvement comes first, ties go to the record created first
+    struct FrontierRecord {
+        double improvement;
+        IndexType record;
+
+        FrontierRecord(double improvement, 
+                       IndexType record): improvement(improvement), 
+            record(record) {};
+        ~FrontierRecord() {};
+
+        bool operator<(const FrontierRecord& other) const {
+            if (improvement != other.improvement) {
+                return improvement < other.improvement;
             }
+            return record > other.record;
         };
+    };
+
+public:
+    BasicBestFirstTreeBuilder() {};
+    BasicBestFirstTreeBuilder(TreeDepthType max_depth, 
+                              NumSamplesType min_samples_split, 
+                              NumSamplesType min_samples_leaf, 
+                              ClassWeightType min_weight_leaf, 
+                              std::vector<ClassWeightType> class_weight, 
+                              Splitter splitter, 
+                              decisiontree::Tree tree, 
+                              NumNodesType max_leaf_nodes): Base(max_depth, 
+                                                                 min_samples_split, 
+                                                                 min_samples_leaf, 
+                                                                 min_weight_leaf, 
+                                                                 class_weight, 
+                                                                 std::move(splitter), 
+                                                                 std::move(tree)), 
+                    max_leaf_nodes_(max_leaf_nodes) {};
+
+    ~BasicBestFirstTreeBuilder() {};
 
-        tree_.nodes_.shrink_to_fit();
+    using Base::build;
+    using Base::tree_;
+
+    void build(const DataView& X, 
+               const std::vector<ClassType>& y, 
+               NumSamplesType num_samples) override {
+
+        // presort or bin feature columns once if required by splitter
+        init_features(X);
+        DECISIONTREE_PROFILE_TIME(profile_.build_time);
+
+        // a binary tree with max_leaf_nodes leaves has 2 * max_leaf_nodes - 1 nodes
+        NumNodesType max_num_nodes = std::min(compute_max_num_nodes(num_samples), 2 * max_leaf_nodes_ - 1);
+        NodeRecords records(std::min(max_num_nodes, NUM_NODES_PER_CHUNK), max_num_nodes);
+        add_root_record(records, num_samples);
+        split_record(X, y, splitter_, records[0]);
+
+        std::priority_queue<FrontierRecord> frontier;
+        if (!records[0].is_leaf) {
+            frontier.emplace(records[0].improvement, 0);
+        }
+
+        // each expansion turns one leaf into two
+        NumNodesType num_leaf_nodes = 1;
+        while (!frontier.empty() && num_leaf_nodes < max_leaf_nodes_) {
+            IndexType r = frontier.top().record;
+            frontier.pop();
+
+            add_children_records(records, r);
+            ++num_leaf_nodes;
+
+            for (IndexType child : {records[r].left_record, records[r].right_record}) {
+                split_record(X, y, splitter_, records[child]);
+                if (!records[child].is_leaf) {
+                    frontier.emplace(records[child].improvement, child);
+                }
+            }
+        }
+
+        // the leaf budget is used up, the remaining frontier are leaves
+        while (!frontier.empty()) {
+            records[frontier.top().record].make_leaf();
+            frontier.pop();
+        }
+
+        add_records_to_tree(records);
+        DECISIONTREE_PROFILE_RECORD(splitter_.get_profile(profile_));
     };
 
 };
 
+using TreeBuilder = BasicTreeBuilder<FeatureType, ClassType, SampleIndexType>;
+using DepthFirstTreeBuilder = BasicDepthFirstTreeBuilder<FeatureType, ClassType, SampleIndexType>;
+using BreadthFirstTreeBuilder = BasicBreadthFirstTreeBuilder<FeatureType, ClassType, SampleIndexType>;
+using BestFirstTreeBuilder = BasicBestFirstTreeBuilder<FeatureType, ClassType, SampleIndexType>;
+
 } //namespace
 
 #endif // CORE_BUILDER_HPP_
\ No newline at end of file
@@ -2,79 +2,174 @@
 #define CORE_CRITERION_BASE_HPP_
 
 #include "common/prereqs.hpp"
+#include "utility/aligned_allocator.hpp"
 
 namespace decisiontree {
 
 /**
- * @brief 
+ * @brief base class of the classification criteria, it holds the weighted 
+ * class histograms and impurities of a node and of its children. The 
+ * statistics, the impurity and the improvement of a split are defined by 
+ * the final criterion through ImpurityCriterion, so the split search calls 
+ * them without virtual dispatch on the final criterion type, and they 
+ * cannot be called on a Criterion, whose histograms may not hold classes.
+ * 
+ * All the state lives in one cache line aligned arena allocated at 
+ * construction, every histogram is a slab of shape (num_outputs, 
+ * max_num_classes) with the layout of class_weight, and every per-output 
+ * value is an array of num_outputs values. Each slab starts on its own 
+ * cache line, and no method allocates memory after construction.
 */
 class Criterion {
-private:
+protected:
     NumOutputsType num_outputs_;
     NumSamplesType num_samples_;
     NumClassesType max_num_classes_;
     std::vector<NumClassesType> num_classes_list_;
     std::vector<ClassWeightType> class_weight_;
 
+    // the arena holding the histograms and the per-output values, 
+    // the pointers below point into it
+    std::vector<HistogramType, AlignedAllocator<HistogramType>> arena_;
+
     // weighted histogram in the parent node, it with non missing value, 
     // and it with missing value
-    std::vector<std::vector<HistogramType>> node_weighted_histogram_;
-    std::vector<std::vector<HistogramType>> node_weighted_histogram_missing_;
-    std::vector<std::vector<HistogramType>> node_weighted_histogram_non_missing_;
-
-    // weighted histogram in left node with values smaller than threshold,
-    // it without missing value and it with missing value
-    std::vector<std::vector<HistogramType>> left_weighted_histogram_;
-    std::vector<std::vector<HistogramType>> left_weighted_histogram_missing_;
-    std::vector<std::vector<HistogramType>> left_weighted_histogram_non_missing_;
-
-    // weighted histogram in right node with values bigger than threshold,
-    // it with non-missing value and missing value
-    std::vector<std::vector<HistogramType>> right_weighted_histogram_;
-    std::vector<std::vector<HistogramType>> right_weighted_histogram_missing_;
-    std::vector<std::vector<HistogramType>> right_weighted_histogram_non_missing_;
+    HistogramType* node_weighted_histogram_;
+    HistogramType* node_weighted_histogram_missing_;
+    HistogramType* node_weighted_histogram_non_missing_;
+
+    // weighted histogram in left node with values smaller than threshold
+    HistogramType* left_weighted_histogram_;
+
+    // weighted histogram in right node with values bigger than threshold
+    HistogramType* right_weighted_histogram_;
+
+    // scratch histograms, the unweighted class counts of a range of samples, 
+    // and the histograms of the children with the samples with missing values
+    HistogramType* histogram_count_;
+    HistogramType* left_histogram_missing_;
+    HistogramType* right_histogram_missing_;
 
     // weighted number of samples in the parent node, 
     // it without the missing value and with the missing value
-    std::vector<HistogramType> node_weighted_num_samples_;
-    std::vector<HistogramType> node_weighted_num_samples_missing_;
-    std::vector<HistogramType> node_weighted_num_samples_non_missing_;
+    HistogramType* node_weighted_num_samples_;
+    HistogramType* node_weighted_num_samples_missing_;
+    HistogramType* node_weighted_num_samples_non_missing_;
 
     // value impurity of in the current node, 
     // same value without missing value and with missing value
-    std::vector<double> node_impurity_;
-    std::vector<double> node_impurity_missing_;
-    std::vector<double> node_impurity_non_missing_;
+    double* node_impurity_;
+    double* node_impurity_missing_;
+    double* node_impurity_non_missing_;
 
     // impurity of in the left node with values smaller than threshold
-    std::vector<double> left_impurity_;
-    std::vector<double> left_impurity_missing_;
+    double* left_impurity_;
+    double* left_impurity_missing_;
 
     // impurity of in the right node with values bigger that threshold,
     // impurity with the missing value
-    std::vector<double> right_impurity_;
-    std::vector<double> right_impurity_missing_;
+    double* right_impurity_;
+    double* right_impurity_missing_;
 
     // weighted number of samples in the left node
-    std::vector<HistogramType> left_weighted_num_samples_;
-    std::vector<HistogramType> left_weighted_num_samples_missing_;
+    HistogramType* left_weighted_num_samples_;
+    HistogramType* left_weighted_num_samples_missing_;
 
     // weighted number of samples in the right node
-    std::vector<HistogramType> right_weighted_num_samples_;
-    std::vector<HistogramType> right_weighted_num_samples_missing_;
+    HistogramType* right_weighted_num_samples_;
+    HistogramType* right_weighted_num_samples_missing_;
 
     // the position of threshold value and it at missing value
     SampleIndexType threshold_index_;
     SampleIndexType threshold_index_missing_;
 
-protected:
+    // the weighted histograms, the weighted numbers of samples and the 
+    // impurities of a node of a split, the parent or one of its children
+    struct SplitNode {
+        const HistogramType* histogram;
+        const HistogramType* weighted_num_samples;
+        const double* impurity;
+    };
+
+    /**
+     * @brief average the improvement over the outputs
+    */
+    template<typename ImprovementFunc>
+    double average_improvement(ImprovementFunc improvement) const {
+        double impurity_improvement = 0.0;
+        for (IndexType o = 0; o < num_outputs_; ++o) {
+            impurity_improvement += improvement(o);
+        }
+        return impurity_improvement / num_outputs_;
+    }
+
+private:
+    static const std::size_t NUM_HISTOGRAMS = 8;
+    static const std::size_t NUM_PER_OUTPUT_VALUES = 14;
+
+    // round a number of values up to a whole number of cache lines
+    static std::size_t round_to_cache_line(std::size_t size) {
+        const std::size_t line_size = CACHE_LINE_SIZE / sizeof(HistogramType);
+        return (size + line_size - 1) / line_size * line_size;
+    }
+
     /**
-     * @brief impurity of a weighted class histogram
+     * @brief point the histograms and the per-output values into the arena
     */
-    virtual double compute_impurity(const std::vector<HistogramType>& histogram) = 0;
+    void bind_arena() {
+        const std::size_t histogram_size = round_to_cache_line(num_outputs_ * max_num_classes_);
+        const std::size_t per_output_size = round_to_cache_line(num_outputs_);
+        HistogramType* ptr = arena_.data();
+        auto next = [&ptr](std::size_t size) {
+            HistogramType* slab = ptr;
+            ptr += size;
+            return slab;
+        };
+        node_weighted_histogram_ = next(histogram_size);
+        node_weighted_histogram_missing_ = next(histogram_size);
+        node_weighted_histogram_non_missing_ = next(histogram_size);
+        left_weighted_histogram_ = next(histogram_size);
+        right_weighted_histogram_ = next(histogram_size);
+        histogram_count_ = next(histogram_size);
+        left_histogram_missing_ = next(histogram_size);
+        right_histogram_missing_ = next(histogram_size);
+
+        node_weighted_num_samples_ = next(per_output_size);
+        node_weighted_num_samples_missing_ = next(per_output_size);
+        node_weighted_num_samples_non_missing_ = next(per_output_size);
+        node_impurity_ = next(per_output_size);
+        node_impurity_missing_ = next(per_output_size);
+        node_impurity_non_missing_ = next(per_output_size);
+        left_impurity_ = next(per_output_size);
+        left_impurity_missing_ = next(per_output_size);
+        right_impurity_ = next(per_output_size);
+        right_impurity_missing_ = next(per_output_size);
+        left_weighted_num_samples_ = next(per_output_size);
+        left_weighted_num_samples_missing_ = next(per_output_size);
+        right_weighted_num_samples_ = next(per_output_size);
+        right_weighted_num_samples_missing_ = next(per_output_size);
+    }
+
+    /**
+     * @brief copy a histogram slab into a vector of histograms per output
+    */
+    std::vector<std::vector<HistogramType>> to_histogram_list(const HistogramType* histogram) const {
+        std::vector<std::vector<HistogramType>> histogram_list(num_outputs_);
+        for (IndexType o = 0; o < num_outputs_; ++o) {
+            histogram_list[o].assign(histogram + o * max_num_classes_, 
+                                     histogram + (o + 1) * max_num_classes_);
+        }
+        return histogram_list;
+    }
 
 public:
-    Criterion() {};
+    Criterion(): num_outputs_(0), 
+            num_samples_(0), 
+            max_num_classes_(0), 
+            threshold_index_(0), 
+            threshold_index_missing_(0) {
+                bind_arena();
+            };
     Criterion(NumOutputsType num_outputs, 
               NumSamplesType num_samples, 
               NumClassesType max_num_classes, 
@@ -86,174 +181,91 @@ public:
             class_weight_(class_weight), 
 
             // create and initialize histograms
-            node_weighted_histogram_(num_outputs, std::vector<HistogramType>(max_num_classes, 0.0)), 
-            node_weighted_histogram_missing_(num_outputs, std::vector<HistogramType>(max_num_classes, 0.0)),
-            node_weighted_histogram_non_missing_(num_outputs, std::vector<HistogramType>(max_num_classes, 0.0)),
-
-            left_weighted_histogram_(num_outputs, std::vector<HistogramType>(max_num_classes, 0.0)),
-            left_weighted_histogram_missing_(num_outputs, std::vector<HistogramType>(max_num_classes, 0.0)),
-            left_weighted_histogram_non_missing_(num_outputs, std::vector<HistogramType>(max_num_classes, 0.0)),
-
-            right_weighted_histogram_(num_outputs, std::vector<HistogramType>(max_num_classes, 0.0)), 
-            right_weighted_histogram_missing_(num_outputs, std::vector<HistogramType>(max_num_classes, 0.0)),
-            right_weighted_histogram_non_missing_(num_outputs, std::vector<HistogramType>(max_num_classes, 0.0)),
-
-            node_weighted_num_samples_(num_outputs, 0.0),
-            node_weighted_num_samples_missing_(num_outputs, 0.0),
-            node_weighted_num_samples_non_missing_(num_outputs, 0.0),
-
-            node_impurity_(num_outputs, 0.0),
-            node_impurity_missing_(num_outputs, 0.0),
-            node_impurity_non_missing_(num_outputs, 0.0),
-
-            left_impurity_(num_outputs, 0.0), 
-            left_impurity_missing_(num_outputs, 0.0),
-
-            right_impurity_(num_outputs, 0.0), 
-            right_impurity_missing_(num_outputs, 0.0),
-
-            left_weighted_num_samples_(num_outputs, 0.0),
-            left_weighted_num_samples_missing_(num_outputs, 0.0),
-
-            right_weighted_num_samples_(num_outputs, 0.0), 
-            right_weighted_num_samples_missing_(num_outputs, 0.0),
+            arena_(NUM_HISTOGRAMS * round_to_cache_line(num_outputs * max_num_classes) + 
+                   NUM_PER_OUTPUT_VALUES * round_to_cache_line(num_outputs), 0.0), 
 
             threshold_index_(0),
-            threshold_index_missing_(0) {};
+            threshold_index_missing_(0) {
+                bind_arena();
+            };
+
+    // copy constructor, the pointers are bound to the own arena
+    Criterion(const Criterion& criterion): num_outputs_(criterion.num_outputs_), 
+            num_samples_(criterion.num_samples_), 
+            max_num_classes_(criterion.max_num_classes_),
+            num_classes_list_(criterion.num_classes_list_),
+            class_weight_(criterion.class_weight_), 
+            arena_(criterion.arena_), 
+            threshold_index_(criterion.threshold_index_),
+            threshold_index_missing_(criterion.threshold_index_missing_) {
+                bind_arena();
+            };
+
+    // assignment operator, the arena is reused when the shapes are equal
+    Criterion& operator=(const Criterion& criterion) {
+        num_outputs_ = criterion.num_outputs_;
+        num_samples_ = criterion.num_samples_;
+        max_num_classes_ = criterion.max_num_classes_;
+        num_classes_list_ = criterion.num_classes_list_;
+        class_weight_ = criterion.class_weight_;
+        arena_ = criterion.arena_;
+        threshold_index_ = criterion.threshold_index_;
+        threshold_index_missing_ = criterion.threshold_index_missing_;
+        bind_arena();
+        return *this;
+    }
 
     virtual ~Criterion() {};
 
     /**
-     * @brief weighted class histograms for current node.
-     * 
-     * @param y target stored as a buffer
-     * @param sample_indices  mask on the samples. 
-     *      Indices of the samples in X and y we want to use, 
-     *      where sample_indices[start:end] correspond to the 
-     *      samples in this node
-     * @param start the first sample to use in the mask
-     * @param end the last sample to use in the mask
+     * @brief the node statistics are the weighted class histogram of shape
+     * (num_outputs, max_num_classes) followed by the weighted number of
+     * samples of each output. Both are sums over the samples of the node,
+     * so the statistics of a child are the ones of its parent minus the
+     * ones of its sibling.
     */
-    void compute_node_histogram(const std::vector<ClassType>& y, 
-                                const std::vector<SampleIndexType>& sample_indices, 
-                                SampleIndexType start, 
-                                SampleIndexType end) {
-        // for each output
-        for (IndexType o = 0; o < num_outputs_; o++) {
-            // 1d array to hold the class histogram
-            // count labels for each output
-            std::vector<HistogramType> histogram(max_num_classes_, 0);
-            for (IndexType i = start; i < end; i++) {
-                histogram[y[sample_indices[i] * num_outputs_ + o]]++;
-            }
+    NumClassesType get_node_statistics_size() const {
+        return num_outputs_ * max_num_classes_ + num_outputs_;
+    }
 
-            // class_weight_ is set to be 1.0
-            HistogramType weighted_cnt;
-            node_weighted_num_samples_[o] = 0.0;
-            for (NumClassesType c = 0; c < num_classes_list_[o]; c++) {
-                weighted_cnt = class_weight_[o * max_num_classes_ + c] * histogram[c];
-                node_weighted_histogram_[o][c] = weighted_cnt;
-                node_weighted_num_samples_[o] += weighted_cnt;
-            }
-        }
+    void get_node_statistics(std::vector<HistogramType>& statistics) const {
+        statistics.resize(get_node_statistics_size());
+        std::copy_n(node_weighted_histogram_, num_outputs_ * max_num_classes_, statistics.begin());
+        std::copy_n(node_weighted_num_samples_, num_outputs_, statistics.begin() + num_outputs_ * max_num_classes_);
     }
 
     /**
-     * @brief compute the weighted class histogram for the samples with 
-     * missing values located in sample_indices[0:missing_value_index]
+     * @brief set the weighted class histogram of the current node from
+     * statistics of get_node_statistics instead of counting its samples
     */
-   void compute_node_histogram_missing(const std::vector<ClassType>& y, 
-                                       const std::vector<SampleIndexType>& sample_indices, 
-                                       SampleIndexType missing_value_index) {
-        // for each output
-        for (IndexType o = 0; o < num_outputs_; o++) {
-
-            std::vector<HistogramType> histogram(max_num_classes_, 0);
-            for (IndexType i = 0; i < missing_value_index; ++i) {
-                histogram[y[sample_indices[i] * num_outputs_ + o]]++;
-            }
-
-            // class_weight_ is set to be 1.0
-            HistogramType weighted_cnt;
-            node_weighted_num_samples_missing_[o] = 0.0;
-            for (NumClassesType c = 0; c < num_classes_list_[o]; c++) {
-                weighted_cnt = class_weight_[o * max_num_classes_ + c] * histogram[c];
-                node_weighted_histogram_missing_[o][c] = weighted_cnt;
-                node_weighted_num_samples_missing_[o] += weighted_cnt;
-            }
-
-            for (NumClassesType c = 0; c < num_classes_list_[o]; c++) {
-                node_weighted_histogram_non_missing_[o][c] = node_weighted_histogram_[o][c] - 
-                                                       node_weighted_histogram_missing_[o][c];
-            }
-            node_weighted_num_samples_non_missing_[o] = node_weighted_num_samples_[o] - 
-                                                  node_weighted_num_samples_missing_[o];
-        }
-        threshold_index_missing_ = missing_value_index;
+    void set_node_statistics(const std::vector<HistogramType>& statistics) {
+        std::copy_n(statistics.begin(), num_outputs_ * max_num_classes_, node_weighted_histogram_);
+        std::copy_n(statistics.begin() + num_outputs_ * max_num_classes_, num_outputs_, node_weighted_num_samples_);
     }
 
     /**
      * @brief Evaluate the impurity of the current node.
     */
-    void compute_node_impurity() {
-        // for each output
-        for (IndexType o = 0; o < num_outputs_; o++) {
-            node_impurity_[o] = this->compute_impurity(node_weighted_histogram_[o]);
-        }
-    } 
+    virtual void compute_node_impurity() = 0;
 
     /**
      * @brief Evaluate the impurity of the current node for the 
      *      samples with missing value and non-missing value
     */
-    void compute_node_impurity_missing() {
-        for (IndexType o = 0; o < num_outputs_; o++) {
-            node_impurity_missing_[o] = this->compute_impurity(node_weighted_histogram_missing_[o]);
-            node_impurity_non_missing_[o] = this->compute_impurity(node_weighted_histogram_non_missing_[o]);
-
-        }
-    }
+    virtual void compute_node_impurity_missing() = 0;
 
     /**
      * @brief compute impurity for all outputs of samples for 
      *      left child and right child
     */
-    void compute_children_impurity() {
-        // for each output
-        for (IndexType o = 0; o < num_outputs_; o++) {
-            left_impurity_[o] = this->compute_impurity(left_weighted_histogram_[o]);
-            right_impurity_[o] = this->compute_impurity(right_weighted_histogram_[o]);
-        }
-    }
+    virtual void compute_children_impurity() = 0;
 
     /**
      * @brief compute impurity for all outputs of samples for 
      *      left child and right child, passing on the samples 
      *      with missing values
     */
-    void compute_children_impurity_missing() {
-        // for each output
-        for (IndexType o = 0; o < num_outputs_; o++) {
-            
-            // define histogram 
-            std::vector<HistogramType> histogram(node_weighted_histogram_missing_[o].size(), 0.0);
-
-            // samples that values are smaller than threshold and samples with missing values
-            for (IndexType c = 0; c < node_weighted_histogram_missing_[o].size(); ++c) {
-                histogram[c] = node_weighted_histogram_missing_[o][c] + left_weighted_histogram_[o][c];
-            }
-
-            left_impurity_missing_[o] = this->compute_impurity(histogram);
-            left_weighted_num_samples_missing_[o] = node_weighted_num_samples_missing_[o] + left_weighted_num_samples_[o];
-
-            // samples that values are greater than threshold and samples with missing values
-            for (IndexType c = 0; c < node_weighted_histogram_missing_[o].size(); ++c) {
-                histogram[c] = node_weighted_histogram_missing_[o][c] + right_weighted_histogram_[o][c];
-            }
-            right_impurity_missing_[o] = this->compute_impurity(histogram);
-            right_weighted_num_samples_missing_[o] = node_weighted_num_samples_missing_[o] + right_weighted_num_samples_[o];
-        }
-    }
+    virtual void compute_children_impurity_missing() = 0;
     
     /**
      * @brief initialize class histograms for all outputs 
@@ -266,8 +278,8 @@ public:
             // init class histogram for left child and right child value of 
             // left child is 0, value of right child is current node value
             for (NumClassesType c = 0; c < num_classes_list_[o]; c++) {
-                left_weighted_histogram_[o][c] = 0.0;
-                right_weighted_histogram_[o][c] = node_weighted_histogram_[o][c];
+                left_weighted_histogram_[o * max_num_classes_ + c] = 0.0;
+                right_weighted_histogram_[o * max_num_classes_ + c] = node_weighted_histogram_[o * max_num_classes_ + c];
             }
 
             left_weighted_num_samples_[o] = 0.0;
@@ -288,8 +300,8 @@ public:
             // init class histogram for left child to 0
             // and for right child value to current node value
             for (NumClassesType c = 0; c < num_classes_list_[o]; c++) {
-                left_weighted_histogram_[o][c] = 0.0;
-                right_weighted_histogram_[o][c] = node_weighted_histogram_non_missing_[o][c];
+                left_weighted_histogram_[o * max_num_classes_ + c] = 0.0;
+                right_weighted_histogram_[o * max_num_classes_ + c] = node_weighted_histogram_non_missing_[o * max_num_classes_ + c];
             }
 
             left_weighted_num_samples_[o] = 0.0;
@@ -300,178 +312,474 @@ public:
     }
 
     /**
-     * @brief update class histograms of child nodes with new threshold
+     * @brief interface method to return weighted histogram of the current node
     */
-    void update_children_histogram(const std::vector<ClassType>& y, 
-                                   const std::vector<SampleIndexType>& sample_indices,
-                                   SampleIndexType new_threshold_index) {
-        // for each output
-        for (IndexType o = 0; o < num_outputs_; o++) {
-            std::vector<HistogramType> histogram(max_num_classes_, 0);
+    const std::vector<std::vector<HistogramType>> get_node_weighted_histogram() {
+        return to_histogram_list(node_weighted_histogram_);
+    }
+
+    const std::vector<std::vector<HistogramType>> get_left_weighted_histogram() {
+        return to_histogram_list(left_weighted_histogram_);
+    }
+
+    const std::vector<std::vector<HistogramType>> get_right_weighted_histogram() {
+        return to_histogram_list(right_weighted_histogram_);
+    }
+
+    const std::vector<HistogramType> get_node_weighted_num_samples() {
+        return std::vector<HistogramType>(node_weighted_num_samples_, node_weighted_num_samples_ + num_outputs_);
+    }
+
+    const std::vector<HistogramType> get_left_weighted_num_samples() {
+        return std::vector<HistogramType>(left_weighted_num_samples_, left_weighted_num_samples_ + num_outputs_);
+    }
+
+    const std::vector<HistogramType> get_right_weighted_num_samples() {
+        return std::vector<HistogramType>(right_weighted_num_samples_, right_weighted_num_samples_ + num_outputs_);
+    }
+
+    const double get_node_impurity() {
+        return std::accumulate(node_impurity_, 
+                               node_impurity_ + num_outputs_, 
+                               0.0) / num_outputs_;
+    }
+
+    const double get_left_impurity() {
+        return std::accumulate(left_impurity_, 
+                               left_impurity_ + num_outputs_, 
+                               0.0) / num_outputs_;
+    }
+
+    const double get_right_impurity() {
+        return std::accumulate(right_impurity_, 
+                               right_impurity_ + num_outputs_, 
+                               0.0) / num_outputs_;
+    }
+
+    const double get_node_impurity_missing() {
+        return std::accumulate(node_impurity_missing_, 
+                               node_impurity_missing_ + num_outputs_, 
+                               0.0) / num_outputs_;
+    }
+
+    const double get_node_impurity_non_missing() {
+        return std::accumulate(node_impurity_non_missing_, 
+                               node_impurity_non_missing_ + num_outputs_, 
+                               0.0) / num_outputs_;
+    }
 
-            for (IndexType i = threshold_index_; i < new_threshold_index; i++) {
-                histogram[y[sample_indices[i] * num_outputs_ + o]]++;
+};
+
+/**
+ * @brief implement the impurity methods of Criterion with the impurity of 
+ * the final criterion CriterionType, which must provide 
+ *      static double compute_impurity(const HistogramType* histogram, 
+ *                                     NumClassesType num_classes)
+ *      static void compute_impurity(const HistogramType* left_histogram, 
+ *                                   const HistogramType* right_histogram, 
+ *                                   NumClassesType num_classes, 
+ *                                   double& left_impurity, 
+ *                                   double& right_impurity)
+ * the impurity is called directly and inlined into the loops over outputs, 
+ * the impurities of both children are evaluated in one pass. It may also 
+ * be a non-static member reading the parameters of the criterion.
+ * 
+ * The histograms, the split improvements and the category keys are also 
+ * implemented here through the hooks below, the class counts by default. 
+ * A final criterion whose histograms hold other statistics, e.g. the sums 
+ * of gradients, redefines the hooks instead of the methods, so every call 
+ * on the final criterion or on ImpurityCriterion runs its statistics:
+ *      sum_histogram, add_sample, compute_weighted_num_samples, 
+ *      compute_output_improvement, count_category_orders, rank_category
+*/
+template<typename CriterionType>
+class ImpurityCriterion : public Criterion {
+private:
+    CriterionType& final_criterion() {
+        return static_cast<CriterionType&>(*this);
+    }
+
+    const CriterionType& final_criterion() const {
+        return static_cast<const CriterionType&>(*this);
+    }
+
+    /**
+     * @brief weighted histogram of the unweighted histogram of shape 
+     * (num_outputs, max_num_classes) into weighted_histogram
+    */
+    void weight_histogram(const HistogramType* histogram, HistogramType* weighted_histogram) const {
+        for (IndexType o = 0; o < num_outputs_; o++) {
+            for (NumClassesType c = 0; c < num_classes_list_[o]; c++) {
+                weighted_histogram[o * max_num_classes_ + c] = 
+                    class_weight_[o * max_num_classes_ + c] * histogram[o * max_num_classes_ + c];
             }
+        }
+    }
 
-            // add histogram for samples[index:new_index] to class histogram
-            // for samples[0:index] with value < threshold ==> left child
-            // subtract histogram for samples[index:new_index] to class histogram
-            // for samples[0:index] with value >= threshold ==> right child
-            HistogramType weighted_cnt;
+    /**
+     * @brief move the weighted histogram of shape (num_outputs, max_num_classes) 
+     * from the right child to the left child
+    */
+    void move_to_left_child(const HistogramType* weighted_histogram) {
+        for (IndexType o = 0; o < num_outputs_; o++) {
             for (NumClassesType c = 0; c < num_classes_list_[o]; c++) {
-                weighted_cnt = class_weight_[o * max_num_classes_ + c] * histogram[c];
-                // left child
-                left_weighted_histogram_[o][c] += weighted_cnt;
-                left_weighted_num_samples_[o] += weighted_cnt;
-
-                // right child
-                right_weighted_histogram_[o][c] -= weighted_cnt;
-                right_weighted_num_samples_[o] -= weighted_cnt;
+                left_weighted_histogram_[o * max_num_classes_ + c] += weighted_histogram[o * max_num_classes_ + c];
+                right_weighted_histogram_[o * max_num_classes_ + c] -= weighted_histogram[o * max_num_classes_ + c];
             }
+            HistogramType weighted_num_samples = final_criterion().compute_weighted_num_samples(
+                weighted_histogram + o * max_num_classes_, num_classes_list_[o]
+            );
+            left_weighted_num_samples_[o] += weighted_num_samples;
+            right_weighted_num_samples_[o] -= weighted_num_samples;
         }
-        // update current threshold index
-        threshold_index_ = new_threshold_index;
     }
 
     /**
-     * @brief This method computes the improvement in impurity when a split occurs.
-     * The weighted impurity improvement equation is the following:
+     * @brief average over the outputs of the improvement of the split 
+     * of parent into left and right
+    */
+    double compute_improvement(const SplitNode& parent, 
+                               const SplitNode& left, 
+                               const SplitNode& right) const {
+        return average_improvement([&](IndexType o) {
+            return final_criterion().compute_output_improvement(parent, left, right, o);
+        });
+    }
+
+protected:
+    /**
+     * @brief hook, unweighted class counts of the samples in 
+     * sample_indices[start:end] of shape (num_outputs, max_num_classes), 
+     * held by the criterion until the next call
+    */
+    template<typename ClassType, typename SampleIndexType>
+    HistogramType* sum_histogram(const std::vector<ClassType>& y, 
+                                 const std::vector<SampleIndexType>& sample_indices, 
+                                 IndexType start, 
+                                 IndexType end) {
+        std::fill_n(histogram_count_, num_outputs_ * max_num_classes_, 0.0);
+        for (IndexType i = start; i < end; i++) {
+            final_criterion().add_sample(y, sample_indices[i], histogram_count_);
+        }
+        return histogram_count_;
+    }
+
+    /**
+     * @brief hook, add the classes of sample y[sample_index] to an 
+     * unweighted histogram of shape (num_outputs, max_num_classes)
+    */
+    template<typename ClassType>
+    void add_sample(const std::vector<ClassType>& y, 
+                    IndexType sample_index, 
+                    HistogramType* histogram) const {
+        for (IndexType o = 0; o < num_outputs_; ++o) {
+            histogram[o * max_num_classes_ + y[sample_index * num_outputs_ + o]]++;
+        }
+    }
+
+    /**
+     * @brief hook, weighted number of samples of the weighted histogram 
+     * of one output, the sum of the weighted class counts
+    */
+    HistogramType compute_weighted_num_samples(const HistogramType* weighted_histogram, 
+                                               NumClassesType num_classes) const {
+        HistogramType weighted_num_samples = 0.0;
+        for (NumClassesType c = 0; c < num_classes; c++) {
+            weighted_num_samples += weighted_histogram[c];
+        }
+        return weighted_num_samples;
+    }
+
+    /**
+     * @brief hook, weighted impurity improvement of output o when parent 
+     * is split into left and right:
      *          N_t / N * (impurity - N_t_R / N_t * right_impurity
      *                              - N_t_L / N_t * left_impurity)
      * where N is the total number of samples, N_t is the number of samples
-     * at the current node, N_t_L is the number of samples in the left child,
+     * at the parent node, N_t_L is the number of samples in the left child,
      * and N_t_R is the number of samples in the right child
     */
-    double compute_impurity_improvement() {
-        std::vector<double> impurity_improvement(num_outputs_, 0.0);
-        for (IndexType o = 0; o < num_outputs_; ++o) {
-            impurity_improvement[o] += (node_weighted_num_samples_[o] / num_samples_) * (node_impurity_[o] - 
-                left_weighted_num_samples_[o] / node_weighted_num_samples_[o] * left_impurity_[o] - 
-                    right_weighted_num_samples_[o] / node_weighted_num_samples_[o] * right_impurity_[o]);
-        }
-
-        return std::accumulate(impurity_improvement.begin(), impurity_improvement.end(), 0.0) / impurity_improvement.size();
+    double compute_output_improvement(const SplitNode& parent, 
+                                      const SplitNode& left, 
+                                      const SplitNode& right, 
+                                      IndexType o) const {
+        return (parent.weighted_num_samples[o] / num_samples_) * (parent.impurity[o] - 
+                left.weighted_num_samples[o] / parent.weighted_num_samples[o] * left.impurity[o] - 
+                    right.weighted_num_samples[o] / parent.weighted_num_samples[o] * right.impurity[o]);
     }
 
     /**
-     * computes the improvement in impurity at the current node 
-     * for samples with missing values.
+     * @brief hook, number of rankings of the categories tried by the 
+     * categorical split search, one per class of each output, the ranking 
+     * by the fraction of class c, only one for an output of 2 classes since 
+     * the ranking of the other class is its reverse
     */
-    double compute_impurity_improvement_missing() {
-        std::vector<double> impurity_improvement(num_outputs_, 0.0);
+    NumClassesType count_category_orders() const {
+        NumClassesType num_orders = 0;
         for (IndexType o = 0; o < num_outputs_; ++o) {
-            impurity_improvement[o] += (node_weighted_num_samples_[o] / num_samples_) * (node_impurity_[o] - 
-                node_weighted_num_samples_missing_[o] / node_weighted_num_samples_[o] * node_impurity_missing_[o] - 
-                    node_weighted_num_samples_non_missing_[o] / node_weighted_num_samples_[o] * node_impurity_non_missing_[o]);
+            num_orders += (num_classes_list_[o] == 2) ? 1 : num_classes_list_[o];
         }
+        return num_orders;
+    }
 
-        return std::accumulate(impurity_improvement.begin(), impurity_improvement.end(), 0.0) / impurity_improvement.size();
+    /**
+     * @brief hook, key ranking a category in the ranking order, the weighted 
+     * fraction of the class of order among the samples of the category
+    */
+    double rank_category(const HistogramType* histogram, IndexType order) const {
+        IndexType o = 0;
+        while (order >= ((num_classes_list_[o] == 2) ? 1 : num_classes_list_[o])) {
+            order -= (num_classes_list_[o] == 2) ? 1 : num_classes_list_[o];
+            ++o;
+        }
+        HistogramType weighted_num_samples = 0.0;
+        for (NumClassesType c = 0; c < num_classes_list_[o]; ++c) {
+            weighted_num_samples += class_weight_[o * max_num_classes_ + c] * histogram[o * max_num_classes_ + c];
+        }
+        if (weighted_num_samples <= 0.0) {
+            return 0.0;
+        }
+        return class_weight_[o * max_num_classes_ + order] * histogram[o * max_num_classes_ + order] / weighted_num_samples;
     }
 
+public:
+    ImpurityCriterion() {};
+    ImpurityCriterion(NumOutputsType num_outputs, 
+                      NumSamplesType num_samples, 
+                      NumClassesType max_num_classes, 
+                      std::vector<NumClassesType> num_classes_list, 
+                      std::vector<ClassWeightType> class_weight): Criterion(num_outputs, 
+                                                                            num_samples, 
+                                                                            max_num_classes, 
+                                                                            num_classes_list, 
+                                                                            class_weight) {};
+    ~ImpurityCriterion() {};
+
     /**
-     * computes the improvement in impurity at the current node 
-     * for samples non-missing values.
-     *      N_t_no_m / N * (impurit_no_m - N_t_R / N_t_no_m * right_impurity
-     *                                   - N-t_L / N_t_no_m * left_impurity)
-     * N: total number of samples
-     * N_t_no_m: number of samples with non-missing at the current node
-     * impurit_no_m: impurity at the current node samples are non missing
-     * N_t_R / N_t_L: number of samples in the right/left child
+     * @brief weighted class histograms for current node.
      * 
+     * @param y target stored as a buffer
+     * @param sample_indices  mask on the samples. 
+     *      Indices of the samples in X and y we want to use, 
+     *      where sample_indices[start:end] correspond to the 
+     *      samples in this node
+     * @param start the first sample to use in the mask
+     * @param end the last sample to use in the mask
     */
-    double compute_impurity_improvement_non_missing() {
-        std::vector<double> impurity_improvement(num_outputs_, 0.0);
-        for (IndexType o = 0; o < num_outputs_; ++o) {
-            impurity_improvement[o] += (node_weighted_num_samples_non_missing_[o] / num_samples_) * (node_impurity_non_missing_[o] - 
-                left_weighted_num_samples_[o] / node_weighted_num_samples_non_missing_[o] * left_impurity_[o] - 
-                    right_weighted_num_samples_[o] / node_weighted_num_samples_non_missing_[o] * right_impurity_[o]);
+    template<typename ClassType, typename SampleIndexType>
+    void compute_node_histogram(const std::vector<ClassType>& y, 
+                                const std::vector<SampleIndexType>& sample_indices, 
+                                IndexType start, 
+                                IndexType end) {
+        weight_histogram(final_criterion().sum_histogram(y, sample_indices, start, end), node_weighted_histogram_);
+        for (IndexType o = 0; o < num_outputs_; o++) {
+            node_weighted_num_samples_[o] = final_criterion().compute_weighted_num_samples(
+                node_weighted_histogram_ + o * max_num_classes_, num_classes_list_[o]
+            );
         }
-        return std::accumulate(impurity_improvement.begin(), impurity_improvement.end(), 0.0) / impurity_improvement.size();
     }
 
     /**
-     * @brief computes the improvement in impurity at the left node
-     * for samples for missing values
+     * @brief compute the weighted class histogram for the samples with 
+     * missing values located in sample_indices[0:missing_value_index]
     */
-    double compute_left_impurity_improvement_missing() {
-        std::vector<double> impurity_improvement(num_outputs_, 0.0);
-        for (IndexType o = 0; o < num_outputs_; ++o) {
-            impurity_improvement[o] += (node_weighted_num_samples_[o] / num_samples_) * (node_impurity_[o] - 
-                left_weighted_num_samples_missing_[o] / node_weighted_num_samples_[o] * left_impurity_missing_[o] - 
-                    right_weighted_num_samples_[o] / node_weighted_num_samples_[o] * right_impurity_[o]);
+    template<typename ClassType, typename SampleIndexType>
+    void compute_node_histogram_missing(const std::vector<ClassType>& y, 
+                                        const std::vector<SampleIndexType>& sample_indices, 
+                                        IndexType missing_value_index) {
+        weight_histogram(final_criterion().sum_histogram(y, sample_indices, 0, missing_value_index), 
+                         node_weighted_histogram_missing_);
+        for (IndexType o = 0; o < num_outputs_; o++) {
+            node_weighted_num_samples_missing_[o] = final_criterion().compute_weighted_num_samples(
+                node_weighted_histogram_missing_ + o * max_num_classes_, num_classes_list_[o]
+            );
+            for (NumClassesType c = 0; c < num_classes_list_[o]; c++) {
+                node_weighted_histogram_non_missing_[o * max_num_classes_ + c] = 
+                    node_weighted_histogram_[o * max_num_classes_ + c] - 
+                        node_weighted_histogram_missing_[o * max_num_classes_ + c];
+            }
+            node_weighted_num_samples_non_missing_[o] = node_weighted_num_samples_[o] - 
+                                                  node_weighted_num_samples_missing_[o];
         }
-        return std::accumulate(impurity_improvement.begin(), impurity_improvement.end(), 0.0) / impurity_improvement.size();
+        threshold_index_missing_ = missing_value_index;
     }
 
     /**
-     * @brief computes the improvement in impurity at the right node
-     * for samples for missing values
+     * @brief update class histograms of child nodes with new threshold, 
+     * the samples sample_indices[threshold_index:new_threshold_index] 
+     * move from the right child to the left child
     */
-    double compute_right_impurity_improvement_missing() {
-        std::vector<double> impurity_improvement(num_outputs_, 0.0);
-        for (IndexType o = 0; o < num_outputs_; ++o) {
-            impurity_improvement[o] += (node_weighted_num_samples_[o] / num_samples_) * (node_impurity_[o] - 
-                left_weighted_num_samples_[o] / node_weighted_num_samples_[o] * left_impurity_[o] - 
-                    right_weighted_num_samples_missing_[o] / node_weighted_num_samples_[o] * right_impurity_missing_[o]);
-        }
-        return std::accumulate(impurity_improvement.begin(), impurity_improvement.end(), 0.0) / impurity_improvement.size();
+    template<typename ClassType, typename SampleIndexType>
+    void update_children_histogram(const std::vector<ClassType>& y, 
+                                   const std::vector<SampleIndexType>& sample_indices,
+                                   IndexType new_threshold_index) {
+        HistogramType* histogram = final_criterion().sum_histogram(y, sample_indices, threshold_index_, new_threshold_index);
+        weight_histogram(histogram, histogram);
+        move_to_left_child(histogram);
+        // update current threshold index
+        threshold_index_ = new_threshold_index;
     }
 
     /**
-     * @brief interface method to return weighted histogram of the current node
+     * @brief update class histograms of child nodes by moving the samples of 
+     *      one histogram bin from the right child to the left child
+     * 
+     * @param histogram unweighted class histogram of the samples in the bin, 
+     *      stored as a buffer of shape (num_outputs, max_num_classes)
     */
-    const std::vector<std::vector<HistogramType>> get_node_weighted_histogram() {
-        return node_weighted_histogram_;
+    void update_children_histogram(const HistogramType* histogram) {
+        weight_histogram(histogram, histogram_count_);
+        move_to_left_child(histogram_count_);
     }
 
-    const std::vector<std::vector<HistogramType>> get_left_weighted_histogram() {
-        return left_weighted_histogram_;
+    /**
+     * @brief add the sample y[sample_index] to an unweighted histogram of 
+     * shape (num_outputs, max_num_classes), e.g. the histogram of a bin
+    */
+    template<typename ClassType>
+    void add_sample_to_histogram(const std::vector<ClassType>& y, 
+                                 IndexType sample_index, 
+                                 HistogramType* histogram) const {
+        final_criterion().add_sample(y, sample_index, histogram);
     }
 
-    const std::vector<std::vector<HistogramType>> get_right_weighted_histogram() {
-        return right_weighted_histogram_;
+    /**
+     * @brief number of rankings of the categories tried by the categorical 
+     * split search
+    */
+    NumClassesType get_num_category_orders() const {
+        return final_criterion().count_category_orders();
     }
 
-    const std::vector<HistogramType> get_node_weighted_num_samples() {
-        return node_weighted_num_samples_;
+    /**
+     * @brief key ranking a category in the ranking order
+     * 
+     * @param histogram unweighted histogram of the samples of the category, 
+     *      of shape (num_outputs, max_num_classes)
+    */
+    double compute_category_key(const HistogramType* histogram, IndexType order) const {
+        return final_criterion().rank_category(histogram, order);
     }
 
-    const std::vector<HistogramType> get_left_weighted_num_samples() {
-        return left_weighted_num_samples_;
+    /**
+     * @brief This method computes the improvement in impurity when a split occurs
+     * of the current node into the left child and the right child.
+    */
+    double compute_impurity_improvement() {
+        return compute_improvement({node_weighted_histogram_, node_weighted_num_samples_, node_impurity_}, 
+                                   {left_weighted_histogram_, left_weighted_num_samples_, left_impurity_}, 
+                                   {right_weighted_histogram_, right_weighted_num_samples_, right_impurity_});
     }
 
-    const std::vector<HistogramType> get_right_weighted_num_samples() {
-        return right_weighted_num_samples_;
+    /**
+     * computes the improvement in impurity at the current node 
+     * for samples with missing values.
+    */
+    double compute_impurity_improvement_missing() {
+        return compute_improvement({node_weighted_histogram_, node_weighted_num_samples_, node_impurity_}, 
+                                   {node_weighted_histogram_missing_, node_weighted_num_samples_missing_, node_impurity_missing_}, 
+                                   {node_weighted_histogram_non_missing_, node_weighted_num_samples_non_missing_, node_impurity_non_missing_});
     }
 
-    const double get_node_impurity() {
-        return std::accumulate(node_impurity_.begin(), 
-                               node_impurity_.end(), 
-                               0.0) / num_outputs_;
+    /**
+     * computes the improvement in impurity at the current node 
+     * for samples non-missing values, the parent is the node without 
+     * the samples with missing values.
+    */
+    double compute_impurity_improvement_non_missing() {
+        return compute_improvement({node_weighted_histogram_non_missing_, node_weighted_num_samples_non_missing_, node_impurity_non_missing_}, 
+                                   {left_weighted_histogram_, left_weighted_num_samples_, left_impurity_}, 
+                                   {right_weighted_histogram_, right_weighted_num_samples_, right_impurity_});
     }
 
-    const double get_left_impurity() {
-        return std::accumulate(left_impurity_.begin(), 
-                               left_impurity_.end(), 
-                               0.0) / num_outputs_;
+    /**
+     * @brief computes the improvement in impurity at the left node
+     * for samples for missing values, after compute_children_impurity_missing
+    */
+    double compute_left_impurity_improvement_missing() {
+        return compute_improvement({node_weighted_histogram_, node_weighted_num_samples_, node_impurity_}, 
+                                   {left_histogram_missing_, left_weighted_num_samples_missing_, left_impurity_missing_}, 
+                                   {right_weighted_histogram_, right_weighted_num_samples_, right_impurity_});
     }
 
-    const double get_right_impurity() {
-        return std::accumulate(right_impurity_.begin(), 
-                               right_impurity_.end(), 
-                               0.0) / num_outputs_;
+    /**
+     * @brief computes the improvement in impurity at the right node
+     * for samples for missing values, after compute_children_impurity_missing
+    */
+    double compute_right_impurity_improvement_missing() {
+        return compute_improvement({node_weighted_histogram_, node_weighted_num_samples_, node_impurity_}, 
+                                   {left_weighted_histogram_, left_weighted_num_samples_, left_impurity_}, 
+                                   {right_histogram_missing_, right_weighted_num_samples_missing_, right_impurity_missing_});
     }
 
-    const double get_node_impurity_missing() {
-        return std::accumulate(node_impurity_missing_.begin(), 
-                               node_impurity_missing_.end(), 
-                               0.0) / num_outputs_;
+    /**
+     * @brief Evaluate the impurity of the current node.
+    */
+    void compute_node_impurity() override {
+        // for each output
+        for (IndexType o = 0; o < num_outputs_; o++) {
+            node_impurity_[o] = final_criterion().compute_impurity(node_weighted_histogram_ + o * max_num_classes_, num_classes_list_[o]);
+        }
+    } 
+
+    /**
+     * @brief Evaluate the impurity of the current node for the 
+     *      samples with missing value and non-missing value
+    */
+    void compute_node_impurity_missing() override {
+        for (IndexType o = 0; o < num_outputs_; o++) {
+            final_criterion().compute_impurity(node_weighted_histogram_missing_ + o * max_num_classes_, 
+                                               node_weighted_histogram_non_missing_ + o * max_num_classes_, 
+                                               num_classes_list_[o], 
+                                               node_impurity_missing_[o], 
+                                               node_impurity_non_missing_[o]);
+        }
     }
 
-    const double get_node_impurity_non_missing() {
-        return std::accumulate(node_impurity_non_missing_.begin(), 
-                               node_impurity_non_missing_.end(), 
-                               0.0) / num_outputs_;
+    /**
+     * @brief compute impurity for all outputs of samples for 
+     *      left child and right child
+    */
+    void compute_children_impurity() override {
+        // for each output
+        for (IndexType o = 0; o < num_outputs_; o++) {
+            final_criterion().compute_impurity(left_weighted_histogram_ + o * max_num_classes_, 
+                                               right_weighted_histogram_ + o * max_num_classes_, 
+                                               num_classes_list_[o], 
+                                               left_impurity_[o], 
+                                               right_impurity_[o]);
+        }
+    }
+
+    /**
+     * @brief compute impurity for all outputs of samples for 
+     *      left child and right child, passing on the samples 
+     *      with missing values
+    */
+    void compute_children_impurity_missing() override {
+        // for each output
+        for (IndexType o = 0; o < num_outputs_; o++) {
+            const HistogramType* node_histogram_missing = node_weighted_histogram_missing_ + o * max_num_classes_;
+            const HistogramType* left_histogram = left_weighted_histogram_ + o * max_num_classes_;
+            const HistogramType* right_histogram = right_weighted_histogram_ + o * max_num_classes_;
+
+            // samples that values are smaller than threshold and samples with missing values, 
+            // samples that values are greater than threshold and samples with missing values
+            HistogramType* left_histogram_missing = left_histogram_missing_ + o * max_num_classes_;
+            HistogramType* right_histogram_missing = right_histogram_missing_ + o * max_num_classes_;
+            for (NumClassesType c = 0; c < num_classes_list_[o]; ++c) {
+                left_histogram_missing[c] = node_histogram_missing[c] + left_histogram[c];
+                right_histogram_missing[c] = node_histogram_missing[c] + right_histogram[c];
+            }
+            final_criterion().compute_impurity(left_histogram_missing, 
+                                               right_histogram_missing, 
+                                               num_classes_list_[o], 
+                                               left_impurity_missing_[o], 
+                                               right_impurity_missing_[o]);
+
+            left_weighted_num_samples_missing_[o] = node_weighted_num_samples_missing_[o] + left_weighted_num_samples_[o];
+            right_weighted_num_samples_missing_[o] = node_weighted_num_samples_missing_[o] + right_weighted_num_samples_[o];
+        }
     }
 
 };
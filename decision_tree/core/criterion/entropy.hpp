@@ -2,48 +2,70 @@
 #define CORE_CRITERION_ENTROPY_HPP_
 
 #include "common/prereqs.hpp"
+#include "utility/math.hpp"
 #include "base.hpp"
 
 namespace decisiontree {
 
-class Entropy : public Criterion {
-protected:
+class Entropy final : public ImpurityCriterion<Entropy> {
+public:
     /**
-     * @brief override method to compute impurity of a weighted class histogram
+     * @brief impurity of a weighted class histogram
      * The Entropy is then defined as:
      *  - count_k = 1 / Nm \sum_{x_i in Rm} I(yi = k) 
      *  - cross-entropy = -\sum_{k=0}^{K-1} count_k log(count_k)
      *  
      * @param histogram sum of the weighted count of each label
+     * @param num_classes number of classes in histogram
     */
-    double compute_impurity(const std::vector<HistogramType>& histogram) override {
-        double cnt;
-        double sum_cnt = 0.0;
-        double entropy = 0.0;
-        for (IndexType c = 0; c < histogram.size(); ++c) {
-            cnt = static_cast<double>(histogram[c]);
-            sum_cnt += cnt;
-            if (cnt > 0.0) {
-                cnt /= sum_cnt;
-                entropy -= cnt * std::log2(cnt);
-            }
-        }
-        return entropy;
+    static double compute_impurity(const HistogramType* histogram, NumClassesType num_classes) {
+        double impurity;
+        compute_impurity(histogram, histogram, num_classes, impurity, impurity);
+        return impurity;
+    };
+
+    /**
+     * @brief impurities of two weighted class histograms, typically of the 
+     * left child and of the right child, computed in a single vectorized pass
+    */
+    static void compute_impurity(const HistogramType* left_histogram, 
+                                 const HistogramType* right_histogram, 
+                                 NumClassesType num_classes, 
+                                 double& left_impurity, 
+                                 double& right_impurity) {
+        double left_sum_cnt, left_sum_cnt_log, right_sum_cnt, right_sum_cnt_log;
+        sum_and_entropy_sum(left_histogram, right_histogram, num_classes, 
+                            left_sum_cnt, left_sum_cnt_log, 
+                            right_sum_cnt, right_sum_cnt_log);
+        left_impurity = compute_impurity_from_sums(left_sum_cnt, left_sum_cnt_log);
+        right_impurity = compute_impurity_from_sums(right_sum_cnt, right_sum_cnt_log);
     };
 
-public:
     Entropy() {};
     Entropy(NumOutputsType num_outputs, 
             NumSamplesType num_samples, 
             NumClassesType max_num_classes, 
             std::vector<NumClassesType> num_classes_list, 
-            std::vector<ClassWeightType> class_weight): Criterion(num_outputs, 
+            std::vector<ClassWeightType> class_weight): ImpurityCriterion<Entropy>(num_outputs, 
                 num_samples, 
                 max_num_classes, 
                 num_classes_list, 
                 class_weight) {};
     ~Entropy() {};
 
+private:
+    /**
+     * with N = sum_k cnt_k, the entropy of the normalized counts is
+     *  -\sum_k cnt_k / N log2(cnt_k / N) = log2(N) - \sum_k cnt_k log2(cnt_k) / N
+     * it is clamped at 0 against rounding errors on pure nodes
+    */
+    static double compute_impurity_from_sums(double sum_cnt, double sum_cnt_log) {
+        if (sum_cnt <= 0.0) {
+            return 0.0;
+        }
+        return std::max(0.0, std::log2(sum_cnt) - sum_cnt_log / sum_cnt);
+    };
+
 };
 
 }
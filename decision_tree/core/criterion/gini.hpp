@@ -2,44 +2,61 @@
 #define CORE_CRITERION_GINI_HPP_
 
 #include "common/prereqs.hpp"
+#include "utility/math.hpp"
 #include "base.hpp"
 
 namespace decisiontree {
 
-class Gini : public Criterion {
-protected:
+class Gini final : public ImpurityCriterion<Gini> {
+public:
     /**
-     * @brief override method to compute impurity of a weighted class histogram
+     * @brief impurity of a weighted class histogram
      * The Gini Index is then defined as:
      *  - index = 1 - sum_{k=0}^{k-1} count_k ** 2, where 
+     *  - count_k = 1 / Nm \sum_{x_i in Rm} I(yi = k) 
      * @param histogram sum of the weighted count of each label
+     * @param num_classes number of classes in histogram
     */
-    double compute_impurity(const std::vector<HistogramType>& histogram) override {
-        double cnt;
-        double sum_cnt = 0.0;
-        double sum_cnt_sq = 0.0;
-
-        for (IndexType c = 0; c < histogram.size(); ++c) {
-            cnt = static_cast<double>(histogram[c]);
-            sum_cnt += cnt;
-            sum_cnt_sq += cnt * cnt;
-        }
-        return (sum_cnt > 0.0) ? (1.0 - sum_cnt_sq / (sum_cnt*sum_cnt)) : 0.0;
+    static double compute_impurity(const HistogramType* histogram, NumClassesType num_classes) {
+        double impurity;
+        compute_impurity(histogram, histogram, num_classes, impurity, impurity);
+        return impurity;
+    };
+
+    /**
+     * @brief impurities of two weighted class histograms, typically of the 
+     * left child and of the right child, computed in a single vectorized pass
+    */
+    static void compute_impurity(const HistogramType* left_histogram, 
+                                 const HistogramType* right_histogram, 
+                                 NumClassesType num_classes, 
+                                 double& left_impurity, 
+                                 double& right_impurity) {
+        double left_sum_cnt, left_sum_cnt_sq, right_sum_cnt, right_sum_cnt_sq;
+        sum_and_square_sum(left_histogram, right_histogram, num_classes, 
+                           left_sum_cnt, left_sum_cnt_sq, 
+                           right_sum_cnt, right_sum_cnt_sq);
+        left_impurity = compute_impurity_from_sums(left_sum_cnt, left_sum_cnt_sq);
+        right_impurity = compute_impurity_from_sums(right_sum_cnt, right_sum_cnt_sq);
     };
 
-public:
     Gini() {};
     Gini(NumOutputsType num_outputs, 
          NumSamplesType num_samples, 
          NumClassesType max_num_classes, 
          std::vector<NumClassesType> num_classes_list,
-         std::vector<ClassWeightType> class_weight): Criterion(num_outputs, 
+         std::vector<ClassWeightType> class_weight): ImpurityCriterion<Gini>(num_outputs, 
             num_samples, 
             max_num_classes, 
             num_classes_list, 
             class_weight) {};
     ~Gini() {};
 
+private:
+    static double compute_impurity_from_sums(double sum_cnt, double sum_cnt_sq) {
+        return (sum_cnt > 0.0) ? (1.0 - sum_cnt_sq / (sum_cnt*sum_cnt)) : 0.0;
+    };
+
 };
 
 }
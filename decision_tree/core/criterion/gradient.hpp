@@ -0,0 +1,175 @@
+#ifndef CORE_CRITERION_GRADIENT_HPP_
+#define CORE_CRITERION_GRADIENT_HPP_
+
+#include "common/prereqs.hpp"
+#include "base.hpp"
+
+namespace decisiontree {
+
+// number of statistics in the histogram of a node of GradientCriterion: H and G
+const NumClassesType NUM_GRADIENT_STATISTICS = 2;
+
+/**
+ * @brief second-order criterion of gradient boosting, it splits on the
+ * gradients g_i and the hessians h_i of the loss at the current scores
+ * instead of the class labels, which are ignored.
+ *
+ * A node has a single output with the histogram [H, G] of the sums
+ * H = sum h_i and G = sum g_i over its samples, its weighted number of
+ * samples is H. The improvement of a split is the Newton gain
+ *      G_L^2 / (H_L + lambda) + G_R^2 / (H_R + lambda) - G^2 / (H + lambda)
+ * where lambda is the L2 regularization of the leaf values. It is not scaled
+ * by the number of samples, so a minimum gain means the same on any training
+ * set, and it is computed from the scores G^2 / (H + lambda) of the nodes
+ * rather than from differences of impurities, which would cancel the large
+ * terms g_i^2 / h_i of the samples with tiny hessians. The purity of a node
+ * is not known from [H, G], so a non-empty node has impurity 1 and the split
+ * stops on the gain.
+ *
+ * The statistics, the gain and the category keys are the hooks of
+ * ImpurityCriterion, so the histogram and improvement methods of the
+ * criterion run them whether called on GradientCriterion or on its base.
+*/
+class GradientCriterion final : public ImpurityCriterion<GradientCriterion> {
+private:
+    // gradients and hessians of the loss for each sample, held by the caller
+    const double* gradients_;
+    const double* hessians_;
+    double l2_regularization_;
+
+    friend class ImpurityCriterion<GradientCriterion>;
+
+    /**
+     * @brief Newton score G^2 / (H + lambda) of a histogram [H, G], the
+     * decrease of the second-order loss when its samples get the leaf value
+    */
+    double compute_score(const HistogramType* histogram) const {
+        const double denominator = histogram[0] + l2_regularization_;
+        return (denominator > 0.0) ? histogram[1] * histogram[1] / denominator : 0.0;
+    };
+
+    /**
+     * @brief hook of ImpurityCriterion, histogram [H, G] of the samples 
+     * in sample_indices[start:end], y is not read
+    */
+    template<typename ClassType, typename SampleIndexType>
+    HistogramType* sum_histogram(const std::vector<ClassType>& y, 
+                                 const std::vector<SampleIndexType>& sample_indices,
+                                 IndexType start,
+                                 IndexType end) {
+        if (gradients_ == nullptr || hessians_ == nullptr) {
+            throw std::runtime_error("The gradients and hessians of the criterion are not set.");
+        }
+        std::fill_n(histogram_count_, NUM_GRADIENT_STATISTICS, 0.0);
+        for (IndexType i = start; i < end; ++i) {
+            add_sample(y, sample_indices[i], histogram_count_);
+        }
+        return histogram_count_;
+    };
+
+    /**
+     * @brief hook of ImpurityCriterion, add the statistics of sample_index 
+     * to histogram [H, G], y is not read
+    */
+    template<typename ClassType>
+    void add_sample(const std::vector<ClassType>& y, 
+                    IndexType sample_index, 
+                    HistogramType* histogram) const {
+        histogram[0] += hessians_[sample_index];
+        histogram[1] += gradients_[sample_index];
+    };
+
+    /**
+     * @brief hook of ImpurityCriterion, the weighted number of samples 
+     * of a histogram [H, G] is H
+    */
+    HistogramType compute_weighted_num_samples(const HistogramType* weighted_histogram, 
+                                               NumClassesType num_classes) const {
+        return weighted_histogram[0];
+    };
+
+    /**
+     * @brief hook of ImpurityCriterion, Newton gain of the split of 
+     * parent into left and right
+    */
+    double compute_output_improvement(const SplitNode& parent, 
+                                      const SplitNode& left, 
+                                      const SplitNode& right, 
+                                      IndexType o) const {
+        return compute_score(left.histogram) + compute_score(right.histogram) - compute_score(parent.histogram);
+    };
+
+    /**
+     * @brief hook of ImpurityCriterion, categories are ranked once, 
+     * by the mean Newton step
+    */
+    NumClassesType count_category_orders() const {
+        return 1;
+    };
+
+    /**
+     * @brief hook of ImpurityCriterion, key ranking a category, G / H 
+     * of its histogram [H, G]
+    */
+    double rank_category(const HistogramType* histogram, IndexType order) const {
+        return (histogram[0] > 0.0) ? histogram[1] / histogram[0] : 0.0;
+    };
+
+public:
+    /**
+     * @brief impurity of a histogram [H, G], 1 if it holds samples
+    */
+    double compute_impurity(const HistogramType* histogram, NumClassesType num_classes) const {
+        return (histogram[0] > 0.0) ? 1.0 : 0.0;
+    };
+
+    void compute_impurity(const HistogramType* left_histogram,
+                          const HistogramType* right_histogram,
+                          NumClassesType num_classes,
+                          double& left_impurity,
+                          double& right_impurity) const {
+        left_impurity = compute_impurity(left_histogram, num_classes);
+        right_impurity = compute_impurity(right_histogram, num_classes);
+    };
+
+    /**
+     * @brief the leaf value -G / (H + lambda) minimizing the second-order
+     * approximation of the loss for the histogram [H, G] of the leaf
+    */
+    static double compute_leaf_value(const HistogramType* histogram, double l2_regularization) {
+        const double denominator = histogram[0] + l2_regularization;
+        return (denominator > 0.0) ? -histogram[1] / denominator : 0.0;
+    };
+
+    GradientCriterion(): gradients_(nullptr), hessians_(nullptr), l2_regularization_(0.0) {};
+    GradientCriterion(NumSamplesType num_samples,
+                      const double* gradients = nullptr,
+                      const double* hessians = nullptr,
+                      double l2_regularization = 0.0): ImpurityCriterion<GradientCriterion>(1,
+            num_samples,
+            NUM_GRADIENT_STATISTICS,
+            {NUM_GRADIENT_STATISTICS},
+            std::vector<ClassWeightType>(NUM_GRADIENT_STATISTICS, 1.0)),
+        gradients_(gradients),
+        hessians_(hessians),
+        l2_regularization_(l2_regularization) {};
+    GradientCriterion(const GradientCriterion&) = default;
+    GradientCriterion& operator=(const GradientCriterion&) = default;
+    ~GradientCriterion() {};
+
+    /**
+     * @brief set the gradients and the hessians of the loss for the next
+     * tree, the buffers of num_samples values are read in place, the
+     * hessians must be positive.
+    */
+    void set_gradients(const double* gradients,
+                       const double* hessians,
+                       double l2_regularization) {
+        gradients_ = gradients;
+        hessians_ = hessians;
+        l2_regularization_ = l2_regularization;
+    };
+};
+
+}
+#endif // CORE_CRITERION_GRADIENT_HPP_
@@ -0,0 +1,481 @@
+#ifndef CORE_DATA_LOADER_HPP_
+#define CORE_DATA_LOADER_HPP_
+
+#include "common/prereqs.hpp"
+#include "core/dataset.hpp"
+#include "utility/binary_io.hpp"
+#include "utility/thread_pool.hpp"
+
+#include <unordered_map>
+
+namespace decisiontree {
+
+// number of bytes of a CSV file parsed by one task
+const std::size_t CSV_CHUNK_SIZE = 1 << 22;
+
+/**
+ * @brief a labeled dataset loaded from a file, ready to fit a classifier:
+ * the features X of shape (num_samples, num_features) in column-major
+ * layout and the classes y of shape (num_samples, num_outputs) in
+ * row-major layout, y[i * num_outputs + o] is the index of the label
+ * of sample i in class_labels[o].
+ *
+ * Two formats are read:
+ *  - CSV, with a header line naming the columns, parsed in chunks of
+ *    lines by several threads from the file mapped in memory
+ *  - the binary dataset format written by save, mapped in memory with
+ *    X read in place from the mapped pages
+*/
+template<typename FeatureType, typename ClassType>
+class BasicLabeledData {
+private:
+    using DataView = BasicDataView<FeatureType>;
+
+    NumSamplesType num_samples_;
+    std::vector<std::string> feature_names_;
+    std::vector<std::vector<std::string>> class_labels_;
+
+    // X_data_ points into X_ or into the buffer held by storage_, the 
+    // mapped file or the values parsed from a CSV file
+    std::vector<FeatureType> X_;
+    const FeatureType* X_data_;
+    std::shared_ptr<const void> storage_;
+    std::vector<ClassType> y_;
+
+    /**
+     * @brief a field of a CSV line in [begin:end], without surrounding
+     * spaces, carriage return and double quotes
+    */
+    static void trim_field(const char*& begin, const char*& end) {
+        while (begin < end && (*begin == ' ' || *begin == '\t')) {
+            ++begin;
+        }
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+            --end;
+        }
+        if (end - begin >= 2 && *begin == '"' && end[-1] == '"') {
+            ++begin;
+            --end;
+        }
+    };
+
+    /**
+     * @brief end of the line starting at begin, the position of '\n' or end
+    */
+    static const char* find_line_end(const char* begin, const char* end) {
+        const char* line_end = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        return line_end ? line_end : end;
+    };
+
+    /**
+     * @brief true if the line holds more than a carriage return,
+     * empty lines are skipped
+    */
+    static bool is_data_line(const char* begin, const char* end) {
+        return end > begin && !(end - begin == 1 && *begin == '\r');
+    };
+
+    /**
+     * @brief parse a decimal number of at most 19 digits whose value is
+     * mantissa * 10^exponent with mantissa <= 2^53 and |exponent| <= 22,
+     * then mantissa and 10^exponent are exact doubles and one product or
+     * quotient rounds to the nearest double as strtod does. Return false
+     * for the other values, which are left to strtod.
+    */
+    static bool parse_decimal(const char* begin, const char* end, double& value) {
+        static const double powers_of_10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        const char* p = begin;
+        bool negative = (p < end && *p == '-');
+        if (p < end && (*p == '-' || *p == '+')) {
+            ++p;
+        }
+        std::uint64_t mantissa = 0;
+        int exponent = 0, num_digits = 0;
+        for (; p < end && static_cast<unsigned>(*p - '0') < 10; ++p, ++num_digits) {
+            mantissa = mantissa * 10 + (*p - '0');
+        }
+        if (p < end && *p == '.') {
+            for (++p; p < end && static_cast<unsigned>(*p - '0') < 10; ++p, ++num_digits, --exponent) {
+                mantissa = mantissa * 10 + (*p - '0');
+            }
+        }
+        if (num_digits == 0 || num_digits > 19) {
+            return false;
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            bool negative_exponent = (p < end && *p == '-');
+            if (p < end && (*p == '-' || *p == '+')) {
+                ++p;
+            }
+            int e = 0, num_exponent_digits = 0;
+            for (; p < end && static_cast<unsigned>(*p - '0') < 10 && num_exponent_digits < 4; ++p, ++num_exponent_digits) {
+                e = e * 10 + (*p - '0');
+            }
+            if (num_exponent_digits == 0) {
+                return false;
+            }
+            exponent += negative_exponent ? -e : e;
+        }
+        if (p != end || mantissa > (std::uint64_t(1) << 53) || exponent < -22 || exponent > 22) {
+            return false;
+        }
+        value = static_cast<double>(mantissa);
+        value = exponent < 0 ? value / powers_of_10[-exponent] : value * powers_of_10[exponent];
+        value = negative ? -value : value;
+        return true;
+    };
+
+    /**
+     * @brief parse a feature value, an empty cell or "nan" is a missing value
+    */
+    static FeatureType parse_value(const char* begin, const char* end, NumSamplesType row) {
+        trim_field(begin, end);
+        if (begin == end) {
+            return std::numeric_limits<FeatureType>::quiet_NaN();
+        }
+        double value;
+        if (parse_decimal(begin, end, value)) {
+            return static_cast<FeatureType>(value);
+        }
+        // strtod needs a terminated string, copy the value to the stack
+        char buffer[64];
+        std::size_t size = end - begin;
+        if (size >= sizeof(buffer)) {
+            throw std::runtime_error("Invalid value at data row " + std::to_string(row + 1) + ".");
+        }
+        std::memcpy(buffer, begin, size);
+        buffer[size] = '\0';
+        char* parsed_end;
+        value = std::strtod(buffer, &parsed_end);
+        if (parsed_end != buffer + size) {
+            throw std::runtime_error("Invalid value '" + std::string(buffer) +
+                                     "' at data row " + std::to_string(row + 1) + ".");
+        }
+        return static_cast<FeatureType>(value);
+    };
+
+    /**
+     * @brief call func(task) for each task in [0:num_tasks], on the thread
+     * pool if it is given
+    */
+    static void run_tasks(ThreadPool* thread_pool,
+                          IndexType num_tasks,
+                          const std::function<void(IndexType)>& func) {
+        if (thread_pool) {
+            thread_pool->parallel_for(0, num_tasks, func);
+        }
+        else {
+            for (IndexType t = 0; t < num_tasks; ++t) {
+                func(t);
+            }
+        }
+    };
+
+public:
+    BasicLabeledData(): num_samples_(0), X_data_(nullptr) {};
+    ~BasicLabeledData() {};
+
+    BasicLabeledData(const BasicLabeledData&) = delete;
+    BasicLabeledData& operator=(const BasicLabeledData&) = delete;
+    BasicLabeledData(BasicLabeledData&& other) = default;
+    BasicLabeledData& operator=(BasicLabeledData&& other) = default;
+
+    /**
+     * @brief a view on X in column-major layout, valid while this object lives
+    */
+    DataView get_X() const {
+        return DataView(X_data_, num_samples_, feature_names_.size(), DataLayout::column_major);
+    };
+
+    const std::vector<ClassType>& get_y() const {
+        return y_;
+    };
+
+    NumSamplesType get_num_samples() const {
+        return num_samples_;
+    };
+
+    const std::vector<std::string>& get_feature_names() const {
+        return feature_names_;
+    };
+
+    const std::vector<std::vector<std::string>>& get_class_labels() const {
+        return class_labels_;
+    };
+
+    /**
+     * @brief parse a CSV file whose first line names the columns. The
+     * cells of an output column are labels of class_labels[o], the other
+     * columns are features whose empty or "nan" cells are missing values.
+     * Cells may be quoted but can not hold the delimiter or a line break.
+     * The file is cut in chunks of about chunk_size bytes at line breaks,
+     * the threads first count the rows of each chunk, then parse each
+     * chunk into its rows of X and y.
+     *
+     * @param class_labels the labels of each output, in the order of the
+     *      classes of the classifier
+     * @param target_names the columns of the outputs, if empty the last
+     *      class_labels.size() columns
+     * @param num_threads number of parsing threads, by default 0, the
+     *      number of concurrent threads supported by the hardware
+    */
+    static BasicLabeledData read_csv(const std::string& path,
+                                     const std::vector<std::vector<std::string>>& class_labels,
+                                     const std::vector<std::string>& target_names = {},
+                                     NumThreadsType num_threads = 0,
+                                     char delimiter = ',',
+                                     std::size_t chunk_size = CSV_CHUNK_SIZE) {
+        NumOutputsType num_outputs = class_labels.size();
+        if (num_outputs == 0) {
+            throw std::invalid_argument("class_labels must hold at least one output.");
+        }
+        if (!target_names.empty() && target_names.size() != num_outputs) {
+            throw std::invalid_argument("target_names must name one column per output.");
+        }
+        std::vector<std::unordered_map<std::string, ClassType>> label_indices(num_outputs);
+        for (IndexType o = 0; o < num_outputs; ++o) {
+            for (IndexType c = 0; c < class_labels[o].size(); ++c) {
+                label_indices[o].emplace(class_labels[o][c], static_cast<ClassType>(c));
+            }
+        }
+
+        auto mapped_file = std::make_shared<const MappedFile>(path);
+        const char* data = mapped_file->data();
+        const char* data_end = data + mapped_file->size();
+
+        // header, each column is a feature or an output
+        const char* header_end = find_line_end(data, data_end);
+        std::vector<std::string> column_names;
+        for (const char* begin = data; ; ) {
+            const char* end = static_cast<const char*>(std::memchr(begin, delimiter, header_end - begin));
+            const char* field_end = end ? end : header_end;
+            const char* field_begin = begin;
+            trim_field(field_begin, field_end);
+            column_names.emplace_back(field_begin, field_end);
+            if (!end) {
+                break;
+            }
+            begin = end + 1;
+        }
+        NumFeaturesType num_columns = column_names.size();
+        if (num_columns < num_outputs) {
+            throw std::runtime_error("The CSV file has fewer columns than outputs.");
+        }
+
+        // column_outputs[k] is the output of column k, or num_outputs for a feature
+        std::vector<IndexType> column_outputs(num_columns, num_outputs);
+        if (target_names.empty()) {
+            for (IndexType o = 0; o < num_outputs; ++o) {
+                column_outputs[num_columns - num_outputs + o] = o;
+            }
+        }
+        else {
+            for (IndexType o = 0; o < num_outputs; ++o) {
+                auto it = std::find(column_names.begin(), column_names.end(), target_names[o]);
+                if (it == column_names.end()) {
+                    throw std::runtime_error("The CSV file has no column '" + target_names[o] + "'.");
+                }
+                column_outputs[it - column_names.begin()] = o;
+            }
+        }
+
+        BasicLabeledData dataset;
+        dataset.class_labels_ = class_labels;
+        std::vector<IndexType> column_features(num_columns, 0);
+        for (IndexType k = 0; k < num_columns; ++k) {
+            if (column_outputs[k] == num_outputs) {
+                column_features[k] = dataset.feature_names_.size();
+                dataset.feature_names_.push_back(column_names[k]);
+            }
+        }
+        NumFeaturesType num_features = dataset.feature_names_.size();
+
+        // cut the lines after the header in chunks at line breaks
+        const char* body = std::min(header_end + 1, data_end);
+        std::vector<const char*> chunk_begins = {body};
+        chunk_size = std::max<std::size_t>(chunk_size, 1);
+        while (static_cast<std::size_t>(data_end - chunk_begins.back()) > chunk_size) {
+            const char* line_end = find_line_end(chunk_begins.back() + chunk_size, data_end);
+            if (line_end == data_end) {
+                break;
+            }
+            chunk_begins.push_back(line_end + 1);
+        }
+        IndexType num_chunks = chunk_begins.size();
+        chunk_begins.push_back(data_end);
+
+        std::unique_ptr<ThreadPool> thread_pool;
+        if (num_threads != 1 && num_chunks > 1) {
+            thread_pool.reset(new ThreadPool(num_threads == 0 ? 0 : std::min<NumThreadsType>(num_threads, num_chunks)));
+        }
+
+        // count the rows of each chunk, then the first row of each chunk
+        std::vector<NumSamplesType> chunk_rows(num_chunks + 1, 0);
+        run_tasks(thread_pool.get(), num_chunks, [&](IndexType t) {
+            NumSamplesType num_rows = 0;
+            for (const char* begin = chunk_begins[t]; begin < chunk_begins[t + 1]; ) {
+                const char* end = find_line_end(begin, chunk_begins[t + 1]);
+                num_rows += is_data_line(begin, end);
+                begin = end + 1;
+            }
+            chunk_rows[t + 1] = num_rows;
+        });
+        std::partial_sum(chunk_rows.begin(), chunk_rows.end(), chunk_rows.begin());
+        NumSamplesType num_samples = chunk_rows[num_chunks];
+
+        // X is not value-initialized, each value is written once by the 
+        // task parsing its row instead of zero-filling X in one thread first
+        dataset.num_samples_ = num_samples;
+        std::shared_ptr<FeatureType> X_values(new FeatureType[num_samples * num_features], 
+                                              std::default_delete<FeatureType[]>());
+        dataset.y_.resize(num_samples * num_outputs);
+        FeatureType* X = X_values.get();
+        ClassType* y = dataset.y_.data();
+
+        // parse the rows of each chunk, X is column-major
+        run_tasks(thread_pool.get(), num_chunks, [&](IndexType t) {
+            NumSamplesType row = chunk_rows[t];
+            for (const char* begin = chunk_begins[t]; begin < chunk_begins[t + 1]; ) {
+                const char* line_end = find_line_end(begin, chunk_begins[t + 1]);
+                if (!is_data_line(begin, line_end)) {
+                    begin = line_end + 1;
+                    continue;
+                }
+                IndexType k = 0;
+                for (const char* field_begin = begin; ; ++k) {
+                    const char* end = static_cast<const char*>(std::memchr(field_begin, delimiter, line_end - field_begin));
+                    const char* field_end = end ? end : line_end;
+                    if (k >= num_columns) {
+                        throw std::runtime_error("Too many columns at data row " + std::to_string(row + 1) + ".");
+                    }
+                    if (column_outputs[k] == num_outputs) {
+                        X[column_features[k] * num_samples + row] = parse_value(field_begin, field_end, row);
+                    }
+                    else {
+                        IndexType o = column_outputs[k];
+                        trim_field(field_begin, field_end);
+                        auto it = label_indices[o].find(std::string(field_begin, field_end));
+                        if (it == label_indices[o].end()) {
+                            throw std::runtime_error("Unknown class label '" + std::string(field_begin, field_end) +
+                                                     "' at data row " + std::to_string(row + 1) + ".");
+                        }
+                        y[row * num_outputs + o] = it->second;
+                    }
+                    if (!end) {
+                        break;
+                    }
+                    field_begin = end + 1;
+                }
+                if (k + 1 != num_columns) {
+                    throw std::runtime_error("Too few columns at data row " + std::to_string(row + 1) + ".");
+                }
+                ++row;
+                begin = line_end + 1;
+            }
+        });
+
+        dataset.X_data_ = X;
+        dataset.storage_ = X_values;
+        return dataset;
+    };
+
+    /**
+     * @brief save the dataset to a binary dataset file: [header, num_samples,
+     * num_features, feature_names, num_outputs, (num_classes, class_labels)
+     * per output, X, y], X is stored column-major as doubles and y row-major
+     * as 64-bit integers, strings are stored as [size, chars].
+    */
+    void save(const std::string& path) const {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        if (!os) {
+            throw std::runtime_error("Failed to open '" + path + "'.");
+        }
+        BinaryWriter writer(os);
+        writer.write_header(MODEL_KIND_DATASET);
+        writer.write<std::uint64_t>(num_samples_);
+        writer.write<std::uint64_t>(feature_names_.size());
+        for (const auto& feature_name : feature_names_) {
+            writer.write_string(feature_name);
+        }
+        writer.write<std::uint64_t>(class_labels_.size());
+        for (const auto& labels : class_labels_) {
+            writer.write<std::uint64_t>(labels.size());
+            for (const auto& label : labels) {
+                writer.write_string(label);
+            }
+        }
+        NumSamplesType num_values = num_samples_ * feature_names_.size();
+        if (std::is_same<FeatureType, double>::value) {
+            writer.write_array(reinterpret_cast<const double*>(X_data_), num_values);
+        }
+        else {
+            std::vector<double> X(X_data_, X_data_ + num_values);
+            writer.write_array(X.data(), num_values);
+        }
+        std::vector<std::int64_t> y(y_.begin(), y_.end());
+        writer.write_array(y.data(), y.size());
+    };
+
+    /**
+     * @brief load a dataset saved by save, the file is mapped in memory and
+     * X is read in place from the mapped pages, only y is copied. The
+     * classes are checked to be in range.
+    */
+    static BasicLabeledData load(const std::string& path) {
+        auto mapped_file = std::make_shared<const MappedFile>(path);
+        BinaryReader reader(mapped_file->data(), mapped_file->size());
+        reader.read_header(MODEL_KIND_DATASET);
+
+        BasicLabeledData dataset;
+        dataset.num_samples_ = reader.read<std::uint64_t>();
+        dataset.feature_names_.resize(reader.read_count(sizeof(std::uint64_t)));
+        for (auto& feature_name : dataset.feature_names_) {
+            feature_name = reader.read_string();
+        }
+        dataset.class_labels_.resize(reader.read_count(sizeof(std::uint64_t)));
+        for (auto& labels : dataset.class_labels_) {
+            labels.resize(reader.read_count(sizeof(std::uint64_t)));
+            for (auto& label : labels) {
+                label = reader.read_string();
+            }
+        }
+        NumOutputsType num_outputs = dataset.class_labels_.size();
+        if (num_outputs == 0) {
+            throw std::runtime_error("The binary dataset has no output.");
+        }
+
+        NumFeaturesType num_features = dataset.feature_names_.size();
+        if ((num_features > 0 && dataset.num_samples_ > std::numeric_limits<std::uint64_t>::max() / num_features) ||
+                dataset.num_samples_ > std::numeric_limits<std::uint64_t>::max() / num_outputs) {
+            throw std::runtime_error("The binary dataset is truncated.");
+        }
+        const double* X = reader.read_array<double>(dataset.num_samples_ * num_features);
+        if (std::is_same<FeatureType, double>::value) {
+            dataset.X_data_ = reinterpret_cast<const FeatureType*>(X);
+            dataset.storage_ = mapped_file;
+        }
+        else {
+            dataset.X_.assign(X, X + dataset.num_samples_ * num_features);
+            dataset.X_data_ = dataset.X_.data();
+        }
+
+        const std::int64_t* y = reader.read_array<std::int64_t>(dataset.num_samples_ * num_outputs);
+        dataset.y_.assign(y, y + dataset.num_samples_ * num_outputs);
+        for (IndexType i = 0; i < dataset.y_.size(); ++i) {
+            if (y[i] < 0 || static_cast<NumClassesType>(y[i]) >= dataset.class_labels_[i % num_outputs].size()) {
+                throw std::runtime_error("The binary dataset has an invalid class.");
+            }
+        }
+        return dataset;
+    };
+};
+
+using LabeledData = BasicLabeledData<FeatureType, ClassType>;
+
+} // namespace
+
+#endif // CORE_DATA_LOADER_HPP_
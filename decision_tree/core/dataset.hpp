@@ -0,0 +1,172 @@
+#ifndef CORE_DATASET_HPP_
+#define CORE_DATASET_HPP_
+
+#include "common/prereqs.hpp"
+
+namespace decisiontree {
+
+/**
+ * @brief layout of a dense matrix of shape (num_samples, num_features),
+ * row-major stores the features of a sample together, column-major
+ * stores the values of a feature together.
+*/
+enum class DataLayout {row_major, column_major};
+
+/**
+ * @brief a read-only view on a dense feature matrix of shape (num_samples,
+ * num_features) held by the caller, X(i, f) is
+ *      data[i * sample_stride + f * feature_stride]
+ * so that a row-major or a column-major buffer, or a strided slice of
+ * a bigger one (e.g. a numpy or an Arrow buffer), is read without copy.
+ * The caller keeps the buffer alive while the view is in use.
+*/
+template<typename FeatureType>
+class BasicDataView {
+private:
+    const FeatureType* data_;
+    NumSamplesType num_samples_;
+    NumFeaturesType num_features_;
+    std::size_t sample_stride_;
+    std::size_t feature_stride_;
+
+public:
+    BasicDataView(): data_(nullptr),
+        num_samples_(0),
+        num_features_(0),
+        sample_stride_(0),
+        feature_stride_(0) {};
+
+    /**
+     * @param data buffer of num_samples * num_features values
+     * @param layout order of the values in data
+    */
+    BasicDataView(const FeatureType* data,
+                  NumSamplesType num_samples,
+                  NumFeaturesType num_features,
+                  DataLayout layout = DataLayout::row_major): data_(data),
+        num_samples_(num_samples),
+        num_features_(num_features),
+        sample_stride_(layout == DataLayout::row_major ? num_features : 1),
+        feature_stride_(layout == DataLayout::row_major ? 1 : num_samples) {};
+
+    /**
+     * @param sample_stride number of values between two consecutive samples
+     * @param feature_stride number of values between two consecutive features
+    */
+    BasicDataView(const FeatureType* data,
+                  NumSamplesType num_samples,
+                  NumFeaturesType num_features,
+                  std::size_t sample_stride,
+                  std::size_t feature_stride): data_(data),
+        num_samples_(num_samples),
+        num_features_(num_features),
+        sample_stride_(sample_stride),
+        feature_stride_(feature_stride) {};
+
+    ~BasicDataView() {};
+
+    FeatureType operator()(IndexType sample_index, FeatureIndexType feature_index) const {
+        return data_[sample_index * sample_stride_ + feature_index * feature_stride_];
+    };
+
+    NumSamplesType get_num_samples() const {
+        return num_samples_;
+    };
+
+    NumFeaturesType get_num_features() const {
+        return num_features_;
+    };
+
+    /**
+     * @brief true if the values of each feature are contiguous
+    */
+    bool is_column_major() const {
+        return sample_stride_ == 1;
+    };
+
+    /**
+     * @brief pointer to the values of feature_index, the values of
+     * consecutive samples are get_column_stride() values apart
+    */
+    const FeatureType* get_column(FeatureIndexType feature_index) const {
+        return data_ + feature_index * feature_stride_;
+    };
+
+    std::size_t get_column_stride() const {
+        return sample_stride_;
+    };
+
+    /**
+     * @brief a view on the samples [begin:end] of the same buffer
+    */
+    BasicDataView slice(IndexType begin, IndexType end) const {
+        return BasicDataView(data_ + begin * sample_stride_, 
+                             end - begin, 
+                             num_features_, 
+                             sample_stride_, 
+                             feature_stride_);
+    };
+};
+
+/**
+ * @brief a dense feature matrix owned in column-major layout, the split
+ * search gathers the values of one feature at a time, which then come
+ * from a single contiguous column.
+*/
+template<typename FeatureType>
+class BasicDataset {
+private:
+    using DataView = BasicDataView<FeatureType>;
+
+    std::vector<FeatureType> data_;
+    NumSamplesType num_samples_;
+    NumFeaturesType num_features_;
+
+public:
+    BasicDataset(): num_samples_(0), num_features_(0) {};
+
+    /**
+     * @brief copy the matrix of a view of any layout into column-major
+    */
+    explicit BasicDataset(const DataView& X): data_(X.get_num_samples() * X.get_num_features()),
+        num_samples_(X.get_num_samples()),
+        num_features_(X.get_num_features()) {
+        for (FeatureIndexType f = 0; f < num_features_; ++f) {
+            const FeatureType* column = X.get_column(f);
+            const std::size_t stride = X.get_column_stride();
+            FeatureType* f_data = &data_[f * num_samples_];
+            for (IndexType i = 0; i < num_samples_; ++i) {
+                f_data[i] = column[i * stride];
+            }
+        }
+    };
+
+    /**
+     * @brief copy the row-major X of shape (num_samples, num_features)
+    */
+    BasicDataset(const std::vector<FeatureType>& X,
+                 NumFeaturesType num_features): BasicDataset(DataView(X.data(),
+                                                                      num_features > 0 ? X.size() / num_features : 0,
+                                                                      num_features)) {};
+
+    ~BasicDataset() {};
+
+    DataView get_view() const {
+        return DataView(data_.data(), num_samples_, num_features_, DataLayout::column_major);
+    };
+
+    NumSamplesType get_num_samples() const {
+        return num_samples_;
+    };
+
+    NumFeaturesType get_num_features() const {
+        return num_features_;
+    };
+};
+
+using DataView = BasicDataView<FeatureType>;
+using Dataset = BasicDataset<FeatureType>;
+
+} // namespace
+
+#endif // CORE_DATASET_HPP_
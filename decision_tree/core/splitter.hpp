@@ -2,20 +2,43 @@
 #define CORE_SPLITTER_HPP_
 
 #include "common/prereqs.hpp"
+#include "utility/profiler.hpp"
 #include "utility/random.hpp"
 #include "utility/sort.hpp"
+#include "utility/thread_pool.hpp"
+
+#include "dataset.hpp"
 
 #include "criterion/base.hpp"
 #include "criterion/gini.hpp"
 #include "criterion/entropy.hpp"
+#include "criterion/gradient.hpp"
 
 namespace decisiontree {
 
 /**
  * @brief
 */
-class Splitter {
+template<typename FeatureType, typename ClassType, typename SampleIndexType>
+class BasicSplitter {
+public:
+    /**
+     * @brief the histograms of a node which are sums over its samples, so 
+     * the ones of the larger child are derived as parent minus sibling. 
+     * statistics holds the node statistics of the criterion, with hist split 
+     * policy and all features considered at each node, bin_histograms and 
+     * bin_num_samples hold the histograms of the bins of all features, 
+     * bin b of feature f at bin_offsets[f] + b.
+    */
+    struct NodeHistograms {
+        std::vector<HistogramType> statistics;
+        std::vector<HistogramType> bin_histograms;
+        std::vector<NumSamplesType> bin_num_samples;
+    };
+
 private:
+    using DataView = BasicDataView<FeatureType>;
+
     NumOutputsType num_outputs_;
     NumSamplesType num_samples_;
     NumFeaturesType num_features_;
@@ -23,39 +46,198 @@ private:
     NumClassesType max_num_classes_;
     std::vector<ClassWeightType> class_weight_;
     std::vector<NumClassesType> num_classes_list_;
-    std::string criterion_;
-    std::string split_policy_;
+    CriterionKind criterion_;
+    SplitPolicy split_policy_;
     RandomState random_state_;
+    bool presort_;
+
+    // is_categorical_[f] is true if feature f holds category codes, 
+    // empty if all features are numerical
+    std::vector<bool> is_categorical_;
+
+    // gradients and hessians of the loss read by the gradient criterion, 
+    // held by the caller
+    const double* gradients_;
+    const double* hessians_;
+    double l2_regularization_;
 
     SampleIndexType start_;
     SampleIndexType end_;
-    std::vector<SampleIndexType> sample_indices_;
+
+    // sample order of the tree being built, it can be shared by splitters 
+    // that split disjoint nodes of the same tree concurrently, each splitter 
+    // only writes inside its node [start:end]
+    struct SampleBuffer {
+        std::vector<SampleIndexType> sample_indices;
+
+        // presorted_indices[f * num_samples + i] holds the samples sorted by 
+        // X[:, f] (missing values first) within each node range [start:end], 
+        // it is derived from FeatureTables::sorted_indices in init_features 
+        // and stable partitioned after each split
+        std::vector<SampleIndexType> presorted_indices;
+        std::vector<std::uint8_t> is_left_mask;
+
+        SampleBuffer(NumSamplesType num_samples): sample_indices(num_samples) {
+            std::iota(sample_indices.begin(), sample_indices.end(), 0);
+        };
+        SampleBuffer(const std::vector<SampleIndexType>& sample_indices): sample_indices(sample_indices) {};
+        ~SampleBuffer() {};
+    };
+    std::shared_ptr<SampleBuffer> buffer_;
+
+    // per-feature lookup tables, they only depend on X, so they are computed 
+    // once and only read afterwards, by all the copies of the splitter, e.g. 
+    // the trees of a forest grown on their own draws of the samples
+    struct FeatureTables {
+        // sorted_indices[f * num_samples + k] is the k-th of all samples 
+        // sorted by X[:, f], missing values first, for presort
+        std::vector<SampleIndexType> sorted_indices;
+
+        // binned_X[f * num_samples + i] is the bin of X[i, f] for hist policy, 
+        // bin_thresholds[f][b] is the upper bound of values in bin b of feature f
+        std::vector<BinType> binned_X;
+        std::vector<std::vector<FeatureType>> bin_thresholds;
+
+        // bin_offsets[f] is the index of the first bin of feature f among 
+        // the bins of all features, bin_offsets[num_features] is their number
+        std::vector<IndexType> bin_offsets;
+
+        // num_categories[f] is the largest category of the categorical 
+        // feature f plus one, 0 for a numerical feature
+        std::vector<NumBinsType> num_categories;
+    };
+    std::shared_ptr<FeatureTables> tables_;
+    std::vector<SampleIndexType> presorted_buffer_;
+
+    // histograms of the current node, given by init_node or computed from its samples
+    NodeHistograms node_histograms_;
+
+    // time and work of the splitter outside of the split tasks
+    TrainingProfile profile_;
+
+    // left categories of the split found by split_node if it is categorical
+    std::vector<std::uint64_t> split_categories_;
+
+    // result of splitting the node on one feature
+    struct SplitInfo {
+        FeatureIndexType feature_index;
+        SampleIndexType partition_index;
+        FeatureType partition_threshold;
+        double improvement;
+        int has_missing_value;
+        bool is_found;
+
+        SplitInfo(double improvement = 0.0): feature_index(0), 
+            partition_index(0), 
+            partition_threshold(0.0), 
+            improvement(improvement), 
+            has_missing_value(0), 
+            is_found(false) {};
+        ~SplitInfo() {};
+
+        bool is_better_than(const SplitInfo& other) const {
+            if (!is_found) {
+                return false;
+            }
+            if (!other.is_found) {
+                return true;
+            }
+            return (improvement > other.improvement) || 
+                   (improvement == other.improvement && feature_index < other.feature_index);
+        }
+    };
+
+    // scratch memory of the split search of one task, sized once to the 
+    // number of samples and reused by every node, a node of num_samples 
+    // samples works in the first num_samples elements of each buffer
+    struct SplitWorkspace {
+        // samples of the node reordered by the feature being split and 
+        // their order for the best split found so far
+        std::vector<SampleIndexType> sample_indices;
+        std::vector<SampleIndexType> best_sample_indices;
+        std::vector<SampleIndexType> missing_sample_indices;
+        std::vector<FeatureType> f_X;
+
+        // histograms of the bins of one feature, hist split policy only
+        std::vector<HistogramType> bin_histogram;
+        std::vector<NumSamplesType> bin_num_samples;
+        SortBuffer<FeatureType, SampleIndexType> sort_buffer;
+
+        // histograms and ranking keys of the categories of one feature, sized 
+        // at the first categorical split, the categories found at the node, 
+        // and the left categories of the current and of the best split as bitsets
+        std::vector<HistogramType> category_histogram;
+        std::vector<NumSamplesType> category_num_samples;
+        std::vector<double> category_keys;
+        std::vector<IndexType> node_categories;
+        std::vector<std::uint64_t> categories;
+        std::vector<std::uint64_t> best_categories;
+
+        // time and work of the split search of the task
+        TrainingProfile profile;
+
+        SplitWorkspace(NumSamplesType num_samples, 
+                       NumClassesType bin_stride, 
+                       NumBinsType num_bins): sample_indices(num_samples), 
+            best_sample_indices(num_samples), 
+            missing_sample_indices(num_samples), 
+            f_X(num_samples), 
+            bin_histogram(num_bins * bin_stride), 
+            bin_num_samples(num_bins) {
+                sort_buffer.reserve(num_samples);
+            };
+        ~SplitWorkspace() {};
+    };
+
+    // per-task criterion and workspace of the split search, the thread 
+    // pool is started at the first node worth splitting in parallel
+    NumThreadsType num_threads_;
+    std::shared_ptr<ThreadPool> thread_pool_;
+    std::vector<std::shared_ptr<Criterion>> task_criterion_ptrs_;
+    std::vector<SplitWorkspace> task_workspaces_;
+    std::vector<SplitInfo> task_splits_;
+
+    // features in the order they are drawn and the candidate features of a node
+    std::vector<FeatureIndexType> feature_indices_;
+    std::vector<FeatureIndexType> candidate_features_;
 
 protected:
-    void random_split_feature(const std::vector<FeatureType>& X, 
+    template<typename CriterionType>
+    void random_split_feature(const DataView& X, 
                               const std::vector<ClassType>& y,
-                              std::vector<SampleIndexType>& sample_indices, 
                               FeatureIndexType feature_index, 
                               SampleIndexType& partition_index,
                               FeatureType& partition_threshold,
                               double& improvement, 
-                              int& has_missing_value) {
+                              int& has_missing_value, 
+                              CriterionType& criterion, 
+                              SplitWorkspace& workspace) {
         
         // copy f_X = X[sample_indices[start:end], feature_index] 
         // as the selected training data for the current node
         NumSamplesType num_samples = end_ - start_;
-        std::vector<FeatureType> f_X(num_samples);
-        for (IndexType i = 0; i < num_samples; ++i) {
-            f_X[i] = X[sample_indices[i]*num_features_ + feature_index];
+        std::vector<SampleIndexType>& sample_indices = workspace.sample_indices;
+        const FeatureType* f_column = X.get_column(feature_index);
+        const std::size_t f_stride = X.get_column_stride();
+        std::vector<FeatureType>& f_X = workspace.f_X;
+        TrainingProfile& profile = workspace.profile;
+        {
+            DECISIONTREE_PROFILE_TIME(profile.gather_time);
+            for (IndexType i = 0; i < num_samples; ++i) {
+                f_X[i] = f_column[sample_indices[i] * f_stride];
+            }
         }
         
         // check the missing value and shift missing value and its index to the left
         SampleIndexType missing_value_index = 0;
-        for (IndexType i = 0; i < num_samples; ++i) {
-            if (std::isnan(f_X[i])) {
-                std::swap(f_X[i], f_X[missing_value_index]);
-                std::swap(sample_indices[i], sample_indices[missing_value_index]);
-                missing_value_index++;
+        {
+            DECISIONTREE_PROFILE_TIME(profile.missing_partition_time);
+            for (IndexType i = 0; i < num_samples; ++i) {
+                if (std::isnan(f_X[i])) {
+                    std::swap(f_X[i], f_X[missing_value_index]);
+                    std::swap(sample_indices[i], sample_indices[missing_value_index]);
+                    missing_value_index++;
+                }
             }
         }
 
@@ -93,23 +275,34 @@ protected:
 
                 // partition sample indices such that f_X[indices[np - 1]] <= threshold < f_X[indices[np]]
                 SampleIndexType index = missing_value_index, next_index = num_samples;
-                while (index < next_index) {
-                    if (f_X[index] <= partition_threshold) {
-                        ++index;
-                    }
-                    else {
-                        --next_index;
-                        std::swap(f_X[index], f_X[next_index]);
-                        std::swap(sample_indices[index], sample_indices[next_index]);
+                {
+                    DECISIONTREE_PROFILE_TIME(profile.rearrange_time);
+                    while (index < next_index) {
+                        if (f_X[index] <= partition_threshold) {
+                            ++index;
+                        }
+                        else {
+                            --next_index;
+                            std::swap(f_X[index], f_X[next_index]);
+                            std::swap(sample_indices[index], sample_indices[next_index]);
+                        }
                     }
                 }
 
                 // no missing value
                 if (missing_value_index == 0) {
-                    criterion_ptr_->init_children_histogram();
-                    criterion_ptr_->update_children_histogram(y, sample_indices, next_index);
-                    criterion_ptr_->compute_children_impurity();
-                    double impurity_improvement = criterion_ptr_->compute_impurity_improvement();
+                    DECISIONTREE_PROFILE_RECORD(profile.num_thresholds_evaluated++);
+                    {
+                        DECISIONTREE_PROFILE_TIME(profile.histogram_update_time);
+                        criterion.init_children_histogram();
+                        criterion.update_children_histogram(y, sample_indices, next_index);
+                    }
+                    double impurity_improvement = 0.0;
+                    {
+                        DECISIONTREE_PROFILE_TIME(profile.impurity_time);
+                        criterion.compute_children_impurity();
+                        impurity_improvement = criterion.compute_impurity_improvement();
+                    }
 
                     partition_index = start_ + next_index;
                     improvement = impurity_improvement;
@@ -122,30 +315,59 @@ protected:
         }
     };
 
-    void best_split_feature(const std::vector<FeatureType>& X, 
+    /**
+     * @brief threshold between two consecutive distinct values lower < upper, 
+     * their midpoint rounded to FeatureType, or lower if the midpoint rounds 
+     * up to upper, e.g. for adjacent floats, so that x <= threshold sends 
+     * lower to the left and upper to the right as the split of the samples
+    */
+    static FeatureType compute_threshold(FeatureType lower, FeatureType upper) {
+        FeatureType threshold = static_cast<FeatureType>((lower + upper) / 2.0);
+        return (threshold < upper) ? threshold : lower;
+    }
+
+    template<typename CriterionType>
+    void best_split_feature(const DataView& X, 
                             const std::vector<ClassType>& y, 
-                            std::vector<SampleIndexType>& sample_indices, 
                             FeatureIndexType feature_index, 
                             SampleIndexType& partition_index,
                             FeatureType& partition_threshold,
                             double& improvement, 
-                            int& has_missing_value) {
+                            int& has_missing_value, 
+                            CriterionType& criterion, 
+                            SplitWorkspace& workspace) {
         
         // copy f_X = X[sample_indices[start:end], feature_index] 
         // as the selected training data for the current node
         NumSamplesType num_samples = end_ - start_;
-        std::vector<FeatureType> f_X(num_samples);
-        for (IndexType i = 0; i < num_samples; ++i) {
-            f_X[i] = X[sample_indices[i]*num_features_ + feature_index];
+        std::vector<SampleIndexType>& sample_indices = workspace.sample_indices;
+        std::vector<FeatureType>& f_X = workspace.f_X;
+        TrainingProfile& profile = workspace.profile;
+        {
+            DECISIONTREE_PROFILE_TIME(profile.gather_time);
+            if (presort_) {
+                // sample_indices[start:end] already sorted by feature_index
+                std::copy(&buffer_->presorted_indices[feature_index * num_samples_ + start_], 
+                          &buffer_->presorted_indices[feature_index * num_samples_ + end_], 
+                          sample_indices.begin());
+            }
+            const FeatureType* f_column = X.get_column(feature_index);
+            const std::size_t f_stride = X.get_column_stride();
+            for (IndexType i = 0; i < num_samples; ++i) {
+                f_X[i] = f_column[sample_indices[i] * f_stride];
+            }
         }
         
         // check the missing value and shift missing value and its index to the left
         SampleIndexType missing_value_index = 0;
-        for (IndexType i = 0; i < num_samples; ++i) {
-            if (std::isnan(f_X[i])) {
-                std::swap(f_X[i], f_X[missing_value_index]);
-                std::swap(sample_indices[i], sample_indices[missing_value_index]);
-                missing_value_index++;
+        {
+            DECISIONTREE_PROFILE_TIME(profile.missing_partition_time);
+            for (IndexType i = 0; i < num_samples; ++i) {
+                if (std::isnan(f_X[i])) {
+                    std::swap(f_X[i], f_X[missing_value_index]);
+                    std::swap(sample_indices[i], sample_indices[missing_value_index]);
+                    missing_value_index++;
+                }
             }
         }
 
@@ -157,16 +379,22 @@ protected:
         // if samples have missing value
         if (missing_value_index > 0) {
             // compute class histogram, impurity and improvement for samples with missing values
-            criterion_ptr_->compute_node_histogram_missing(y, sample_indices, missing_value_index);
-            criterion_ptr_->compute_node_impurity_missing();
-            improvement = criterion_ptr_->compute_impurity_improvement_missing();
+            {
+                DECISIONTREE_PROFILE_TIME(profile.histogram_update_time);
+                criterion.compute_node_histogram_missing(y, sample_indices, missing_value_index);
+            }
+            {
+                DECISIONTREE_PROFILE_TIME(profile.impurity_time);
+                criterion.compute_node_impurity_missing();
+                improvement = criterion.compute_impurity_improvement_missing();
+            }
             // pass all samples with missing values to the left child
             // pass all samples with non-missing values to the right child
             has_missing_value = 0;
             partition_threshold = std::numeric_limits<FeatureType>::quiet_NaN();
             partition_index = start_ + missing_value_index;
 
-            if (criterion_ptr_->get_node_impurity_non_missing() < EPSILON) {
+            if (criterion.get_node_impurity_non_missing() < EPSILON) {
                 return;
             }
 
@@ -189,15 +417,18 @@ protected:
         // not constant feature
         if (fx_min + EPSILON < fx_max) {
             if (missing_value_index == 0) {
-                criterion_ptr_->init_children_histogram();
+                criterion.init_children_histogram();
             }
             else if (missing_value_index > 0) {
-                criterion_ptr_->init_children_histogram_non_missing();
+                criterion.init_children_histogram_non_missing();
             }
 
             // sort f_X and corresponding sample_indices by soring f_X
             // missing values are at the beginnig of sample_indices
-            sort<FeatureType, FeatureIndexType>(f_X, sample_indices, missing_value_index, num_samples); 
+            if (!presort_) {
+                DECISIONTREE_PROFILE_TIME(profile.sort_time);
+                sort(f_X, sample_indices, missing_value_index, num_samples, workspace.sort_buffer);
+            }
 
             // find threshold
             // init index and next_index for the position of last and next potential split position
@@ -222,31 +453,34 @@ protected:
                 next_index++;
 
                 // update class histograms from current indice to the new indice (correspond to threshold)
-                criterion_ptr_->update_children_histogram(y, sample_indices, next_index);
+                DECISIONTREE_PROFILE_RECORD(profile.num_thresholds_evaluated++);
+                DECISIONTREE_PROFILE_SAMPLE(profile.num_thresholds_evaluated);
+                criterion.update_children_histogram(y, sample_indices, next_index);
+                DECISIONTREE_PROFILE_LAP(profile.histogram_update_time);
 
                 // compute impurity for left child and right child
-                criterion_ptr_->compute_children_impurity();
-                
-                // compute impurity improvement
+                // and impurity improvement
                 double impurity_improvement = 0.0;
+                criterion.compute_children_impurity();
                 if (missing_value_index == 0) {
-                    impurity_improvement = criterion_ptr_->compute_impurity_improvement();
+                    impurity_improvement = criterion.compute_impurity_improvement();
                     // std::cout << "impurity_improvement = " << impurity_improvement << std::endl;
                 }
                 else if (missing_value_index > 0) {
-                    impurity_improvement = criterion_ptr_->compute_impurity_improvement_non_missing();
+                    impurity_improvement = criterion.compute_impurity_improvement_non_missing();
                 }
+                DECISIONTREE_PROFILE_LAP(profile.impurity_time);
 
                 if (impurity_improvement > max_improvement) {
                     max_improvement = impurity_improvement;
-                    max_partition_threshold = (f_X[index] + f_X[next_index]) / 2.0;
+                    max_partition_threshold = compute_threshold(f_X[index], f_X[next_index]);
                     max_partition_index = start_ + next_index; 
                     // std::cout << "current position = " << index << ", value = " << f_X[index] << 
                     //              "next position = " << next_index << ", value = " << f_X[next_index] << std::endl;
                 }
                 
                 // if right node impurity is 0.0 stop
-                if (criterion_ptr_->get_right_impurity() < EPSILON) {
+                if (criterion.get_right_impurity() < EPSILON) {
                     break;
                 }
                 index = next_index;
@@ -260,12 +494,15 @@ protected:
                 has_missing_value = -1;
             }
             else if (missing_value_index > 0) {
-                // call compute_children_impurity_missing 
-                criterion_ptr_->compute_children_impurity_missing();
-
-                // compute left and right improvement for samples with missing values
-                double left_impurity_improvement = criterion_ptr_->compute_left_impurity_improvement_missing();
-                double right_impurity_improvement = criterion_ptr_->compute_right_impurity_improvement_missing();
+                // call compute_children_impurity_missing and compute left 
+                // and right improvement for samples with missing values
+                double left_impurity_improvement = 0.0, right_impurity_improvement = 0.0;
+                {
+                    DECISIONTREE_PROFILE_TIME(profile.impurity_time);
+                    criterion.compute_children_impurity_missing();
+                    left_impurity_improvement = criterion.compute_left_impurity_improvement_missing();
+                    right_impurity_improvement = criterion.compute_right_impurity_improvement_missing();
+                }
 
                 if (left_impurity_improvement > right_impurity_improvement) {
                     // add missing values to left child
@@ -284,8 +521,11 @@ protected:
                         partition_threshold = max_partition_threshold;
 
                         // move samples with missing values to the end of the sample vector
-                        std::vector<SampleIndexType> sample_indice_missing(&sample_indices[0], 
-                                                                           &sample_indices[missing_value_index]);
+                        DECISIONTREE_PROFILE_TIME(profile.rearrange_time);
+                        std::vector<SampleIndexType>& sample_indice_missing = workspace.missing_sample_indices;
+                        std::copy(&sample_indices[0], 
+                                  &sample_indices[missing_value_index], 
+                                  &sample_indice_missing[0]);
                         std::copy(&sample_indices[missing_value_index], 
                                   &sample_indices[num_samples], 
                                   &sample_indices[0]);
@@ -299,15 +539,972 @@ protected:
         }
     };
 
+    template<typename CriterionType>
+    void hist_split_feature(const std::vector<ClassType>& y, 
+                            FeatureIndexType feature_index, 
+                            SampleIndexType& partition_index,
+                            FeatureType& partition_threshold,
+                            double& improvement, 
+                            int& has_missing_value, 
+                            CriterionType& criterion, 
+                            SplitWorkspace& workspace) {
+        
+        // f_bins = tables_->binned_X[feature_index, :] is the binned column of 
+        // the selected feature for all training samples
+        NumSamplesType num_samples = end_ - start_;
+        std::vector<SampleIndexType>& sample_indices = workspace.sample_indices;
+        const BinType* f_bins = &tables_->binned_X[feature_index * num_samples_];
+        TrainingProfile& profile = workspace.profile;
+
+        // check the missing value and shift missing value index to the left
+        SampleIndexType missing_value_index = 0;
+        {
+            DECISIONTREE_PROFILE_TIME(profile.missing_partition_time);
+            for (IndexType i = 0; i < num_samples; ++i) {
+                if (f_bins[sample_indices[i]] == MISSING_VALUE_BIN) {
+                    std::swap(sample_indices[i], sample_indices[missing_value_index]);
+                    missing_value_index++;
+                }
+            }
+        }
+
+        // if all samples have missing value, cannot split feature
+        if (missing_value_index == num_samples) {
+            return ;
+        }
+
+        // if samples have missing value
+        if (missing_value_index > 0) {
+            // compute class histogram, impurity and improvement for samples with missing values
+            {
+                DECISIONTREE_PROFILE_TIME(profile.histogram_update_time);
+                criterion.compute_node_histogram_missing(y, sample_indices, missing_value_index);
+            }
+            {
+                DECISIONTREE_PROFILE_TIME(profile.impurity_time);
+                criterion.compute_node_impurity_missing();
+                improvement = criterion.compute_impurity_improvement_missing();
+            }
+            // pass all samples with missing values to the left child
+            // pass all samples with non-missing values to the right child
+            has_missing_value = 0;
+            partition_threshold = std::numeric_limits<FeatureType>::quiet_NaN();
+            partition_index = start_ + missing_value_index;
+
+            if (criterion.get_node_impurity_non_missing() < EPSILON) {
+                return;
+            }
+        }
+
+        // unweighted histogram of each bin for non-missing samples, 
+        // bin_histogram has the shape of (num_bins, num_outputs, max_num_classes), 
+        // it is read from the histograms of the node if they hold the bins, 
+        // otherwise it is built from the samples of the node
+        NumBinsType num_bins = tables_->bin_thresholds[feature_index].size() + 1;
+        NumClassesType bin_stride = num_outputs_ * max_num_classes_;
+        const HistogramType* bin_histogram;
+        const NumSamplesType* bin_num_samples;
+        if (!node_histograms_.bin_num_samples.empty()) {
+            IndexType bin_offset = tables_->bin_offsets[feature_index];
+            bin_histogram = &node_histograms_.bin_histograms[bin_offset * bin_stride];
+            bin_num_samples = &node_histograms_.bin_num_samples[bin_offset];
+        }
+        else {
+            DECISIONTREE_PROFILE_TIME(profile.histogram_update_time);
+            HistogramType* f_bin_histogram = workspace.bin_histogram.data();
+            NumSamplesType* f_bin_num_samples = workspace.bin_num_samples.data();
+            std::fill_n(f_bin_histogram, num_bins * bin_stride, 0.0);
+            std::fill_n(f_bin_num_samples, num_bins, 0);
+            for (IndexType i = missing_value_index; i < num_samples; ++i) {
+                BinType bin = f_bins[sample_indices[i]];
+                f_bin_num_samples[bin]++;
+                criterion.add_sample_to_histogram(y, sample_indices[i], &f_bin_histogram[bin * bin_stride]);
+            }
+            bin_histogram = f_bin_histogram;
+            bin_num_samples = f_bin_num_samples;
+        }
+
+        // ---Split based on threshold---
+        // check constant feature, the first and the last non-empty bin
+        NumBinsType first_bin = 0, last_bin = num_bins - 1;
+        while (bin_num_samples[first_bin] == 0) {
+            first_bin++;
+        }
+        while (bin_num_samples[last_bin] == 0) {
+            last_bin--;
+        }
+
+        // not constant feature
+        if (first_bin < last_bin) {
+            if (missing_value_index == 0) {
+                criterion.init_children_histogram();
+            }
+            else if (missing_value_index > 0) {
+                criterion.init_children_histogram_non_missing();
+            }
+
+            // find threshold, scan bins and move each bin from right child to left child
+            double max_improvement = 0.0;
+            FeatureType max_partition_threshold = 0.0;
+            NumBinsType max_partition_bin = num_bins;
+            for (NumBinsType bin = first_bin; bin < last_bin; ++bin) {
+                // skip empty bin
+                if (bin_num_samples[bin] == 0) {
+                    continue;
+                }
+
+                // update class histograms with the samples of current bin
+                DECISIONTREE_PROFILE_RECORD(profile.num_thresholds_evaluated++);
+                DECISIONTREE_PROFILE_SAMPLE(profile.num_thresholds_evaluated);
+                criterion.update_children_histogram(&bin_histogram[bin * bin_stride]);
+                DECISIONTREE_PROFILE_LAP(profile.histogram_update_time);
+
+                // compute impurity for left child and right child
+                // and impurity improvement
+                double impurity_improvement = 0.0;
+                criterion.compute_children_impurity();
+                if (missing_value_index == 0) {
+                    impurity_improvement = criterion.compute_impurity_improvement();
+                }
+                else if (missing_value_index > 0) {
+                    impurity_improvement = criterion.compute_impurity_improvement_non_missing();
+                }
+                DECISIONTREE_PROFILE_LAP(profile.impurity_time);
+
+                if (impurity_improvement > max_improvement) {
+                    max_improvement = impurity_improvement;
+                    max_partition_threshold = tables_->bin_thresholds[feature_index][bin];
+                    max_partition_bin = bin;
+                }
+
+                // if right node impurity is 0.0 stop
+                if (criterion.get_right_impurity() < EPSILON) {
+                    break;
+                }
+            }
+
+            // partition non-missing sample indices such that bins of 
+            // sample_indices[missing_value_index:next_index] <= max_partition_bin
+            SampleIndexType max_partition_index = start_ + missing_value_index;
+            if (max_partition_bin < num_bins) {
+                DECISIONTREE_PROFILE_TIME(profile.rearrange_time);
+                SampleIndexType index = missing_value_index, next_index = num_samples;
+                while (index < next_index) {
+                    if (f_bins[sample_indices[index]] <= max_partition_bin) {
+                        ++index;
+                    }
+                    else {
+                        --next_index;
+                        std::swap(sample_indices[index], sample_indices[next_index]);
+                    }
+                }
+                max_partition_index = start_ + next_index;
+            }
+
+            // samples without missing values
+            if (missing_value_index == 0) {
+                partition_index = max_partition_index;
+                partition_threshold = max_partition_threshold;
+                improvement = max_improvement;
+                has_missing_value = -1;
+            }
+            else if (missing_value_index > 0) {
+                // call compute_children_impurity_missing and compute left 
+                // and right improvement for samples with missing values
+                double left_impurity_improvement = 0.0, right_impurity_improvement = 0.0;
+                {
+                    DECISIONTREE_PROFILE_TIME(profile.impurity_time);
+                    criterion.compute_children_impurity_missing();
+                    left_impurity_improvement = criterion.compute_left_impurity_improvement_missing();
+                    right_impurity_improvement = criterion.compute_right_impurity_improvement_missing();
+                }
+
+                if (left_impurity_improvement > right_impurity_improvement) {
+                    // add missing values to left child
+                    if (improvement < left_impurity_improvement) {
+                        improvement = left_impurity_improvement;
+                        partition_index = max_partition_index;
+                        partition_threshold = max_partition_threshold;
+                        has_missing_value = 0;
+                    }
+                }
+                else {
+                    // add missing values to right child
+                    if (improvement < right_impurity_improvement) {
+                        improvement = right_impurity_improvement;
+                        has_missing_value = 1;
+                        partition_threshold = max_partition_threshold;
+
+                        // move samples with missing values to the end of the sample vector
+                        DECISIONTREE_PROFILE_TIME(profile.rearrange_time);
+                        std::vector<SampleIndexType>& sample_indice_missing = workspace.missing_sample_indices;
+                        std::copy(&sample_indices[0], 
+                                  &sample_indices[missing_value_index], 
+                                  &sample_indice_missing[0]);
+                        std::copy(&sample_indices[missing_value_index], 
+                                  &sample_indices[num_samples], 
+                                  &sample_indices[0]);
+                        std::copy(&sample_indice_missing[0], 
+                                  &sample_indice_missing[missing_value_index], 
+                                  &sample_indices[num_samples - missing_value_index]);
+                        partition_index = max_partition_index - missing_value_index;
+                    }
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief split a categorical feature by the set of categories going to the 
+     * left child. The categories found at the node are ranked by a key of the 
+     * class histogram of their samples, see Criterion::compute_category_key, 
+     * and the prefixes of each ranking are scanned as the bins of the hist 
+     * split policy. With 2 classes the ranking by the fraction of one class 
+     * holds the best partition of the categories. The left categories of the 
+     * split are written to workspace.categories as a bitset, it stays empty 
+     * unless the split found is on the categories.
+    */
+    template<typename CriterionType>
+    void categorical_split_feature(const DataView& X, 
+                                   const std::vector<ClassType>& y,
+                                   FeatureIndexType feature_index, 
+                                   SampleIndexType& partition_index,
+                                   FeatureType& partition_threshold,
+                                   double& improvement, 
+                                   int& has_missing_value, 
+                                   CriterionType& criterion, 
+                                   SplitWorkspace& workspace) {
+        
+        NumSamplesType num_samples = end_ - start_;
+        std::vector<SampleIndexType>& sample_indices = workspace.sample_indices;
+        const FeatureType* f_column = X.get_column(feature_index);
+        const std::size_t f_stride = X.get_column_stride();
+        TrainingProfile& profile = workspace.profile;
+
+        // check the missing value and shift missing value index to the left
+        SampleIndexType missing_value_index = 0;
+        {
+            DECISIONTREE_PROFILE_TIME(profile.missing_partition_time);
+            for (IndexType i = 0; i < num_samples; ++i) {
+                if (std::isnan(f_column[sample_indices[i] * f_stride])) {
+                    std::swap(sample_indices[i], sample_indices[missing_value_index]);
+                    missing_value_index++;
+                }
+            }
+        }
+
+        // if all samples have missing value, cannot split feature
+        if (missing_value_index == num_samples) {
+            return ;
+        }
+
+        // if samples have missing value
+        if (missing_value_index > 0) {
+            // compute class histogram, impurity and improvement for samples with missing values
+            {
+                DECISIONTREE_PROFILE_TIME(profile.histogram_update_time);
+                criterion.compute_node_histogram_missing(y, sample_indices, missing_value_index);
+            }
+            {
+                DECISIONTREE_PROFILE_TIME(profile.impurity_time);
+                criterion.compute_node_impurity_missing();
+                improvement = criterion.compute_impurity_improvement_missing();
+            }
+            // pass all samples with missing values to the left child
+            // pass all samples with non-missing values to the right child
+            has_missing_value = 0;
+            partition_threshold = std::numeric_limits<FeatureType>::quiet_NaN();
+            partition_index = start_ + missing_value_index;
+
+            if (criterion.get_node_impurity_non_missing() < EPSILON) {
+                return;
+            }
+        }
+
+        // unweighted histogram of each category found at the node, of shape 
+        // (num_categories, num_outputs, max_num_classes), a histogram is 
+        // cleared when its category is first found
+        NumBinsType num_categories = tables_->num_categories[feature_index];
+        NumClassesType category_stride = num_outputs_ * max_num_classes_;
+        if (workspace.category_num_samples.size() < num_categories) {
+            workspace.category_histogram.resize(num_categories * category_stride);
+            workspace.category_num_samples.resize(num_categories, 0);
+            workspace.category_keys.resize(num_categories);
+        }
+        HistogramType* category_histogram = workspace.category_histogram.data();
+        std::vector<NumSamplesType>& category_num_samples = workspace.category_num_samples;
+        std::vector<double>& category_keys = workspace.category_keys;
+        std::vector<IndexType>& node_categories = workspace.node_categories;
+        node_categories.clear();
+        {
+            DECISIONTREE_PROFILE_TIME(profile.histogram_update_time);
+            for (IndexType i = missing_value_index; i < num_samples; ++i) {
+                IndexType category = static_cast<IndexType>(f_column[sample_indices[i] * f_stride]);
+                if (category_num_samples[category]++ == 0) {
+                    node_categories.push_back(category);
+                    std::fill_n(&category_histogram[category * category_stride], category_stride, 0.0);
+                }
+                criterion.add_sample_to_histogram(y, sample_indices[i], &category_histogram[category * category_stride]);
+            }
+            for (IndexType category : node_categories) {
+                category_num_samples[category] = 0;
+            }
+        }
+
+        // constant feature
+        if (node_categories.size() < 2) {
+            return ;
+        }
+
+        // rank the categories by the key of order, ties by category
+        auto rank_categories = [&](IndexType order) {
+            DECISIONTREE_PROFILE_TIME(profile.sort_time);
+            for (IndexType category : node_categories) {
+                category_keys[category] = criterion.compute_category_key(&category_histogram[category * category_stride], order);
+            }
+            std::sort(node_categories.begin(), node_categories.end(), 
+                [&category_keys](IndexType left, IndexType right) -> bool {
+                    return category_keys[left] < category_keys[right] || 
+                           (category_keys[left] == category_keys[right] && left < right);
+                });
+        };
+
+        // find the best prefix of each ranking, scan the ranked categories 
+        // and move each category from right child to left child
+        double max_improvement = 0.0;
+        IndexType max_order = 0;
+        IndexType max_num_left_categories = 0;
+        NumClassesType num_orders = criterion.get_num_category_orders();
+        for (IndexType order = 0; order < num_orders; ++order) {
+            rank_categories(order);
+            if (missing_value_index == 0) {
+                criterion.init_children_histogram();
+            }
+            else if (missing_value_index > 0) {
+                criterion.init_children_histogram_non_missing();
+            }
+
+            for (IndexType k = 0; k + 1 < node_categories.size(); ++k) {
+                DECISIONTREE_PROFILE_RECORD(profile.num_thresholds_evaluated++);
+                DECISIONTREE_PROFILE_SAMPLE(profile.num_thresholds_evaluated);
+                criterion.update_children_histogram(&category_histogram[node_categories[k] * category_stride]);
+                DECISIONTREE_PROFILE_LAP(profile.histogram_update_time);
+
+                double impurity_improvement = 0.0;
+                criterion.compute_children_impurity();
+                if (missing_value_index == 0) {
+                    impurity_improvement = criterion.compute_impurity_improvement();
+                }
+                else if (missing_value_index > 0) {
+                    impurity_improvement = criterion.compute_impurity_improvement_non_missing();
+                }
+                DECISIONTREE_PROFILE_LAP(profile.impurity_time);
+
+                if (impurity_improvement > max_improvement) {
+                    max_improvement = impurity_improvement;
+                    max_order = order;
+                    max_num_left_categories = k + 1;
+                }
+
+                // if right node impurity is 0.0 stop
+                if (criterion.get_right_impurity() < EPSILON) {
+                    break;
+                }
+            }
+        }
+
+        if (max_num_left_categories == 0) {
+            return ;
+        }
+
+        // bitset of the left categories of the best prefix, the children 
+        // histograms are moved back to it for the samples with missing values
+        if (num_orders > 1) {
+            rank_categories(max_order);
+        }
+        std::vector<std::uint64_t>& categories = workspace.categories;
+        IndexType max_left_category = *std::max_element(node_categories.begin(), 
+                                                        node_categories.begin() + max_num_left_categories);
+        categories.assign(max_left_category / 64 + 1, 0);
+        for (IndexType k = 0; k < max_num_left_categories; ++k) {
+            categories[node_categories[k] / 64] |= std::uint64_t(1) << (node_categories[k] % 64);
+        }
+        if (missing_value_index > 0) {
+            DECISIONTREE_PROFILE_TIME(profile.histogram_update_time);
+            criterion.init_children_histogram_non_missing();
+            for (IndexType k = 0; k < max_num_left_categories; ++k) {
+                criterion.update_children_histogram(&category_histogram[node_categories[k] * category_stride]);
+            }
+        }
+
+        // partition non-missing sample indices such that the categories of 
+        // sample_indices[missing_value_index:next_index] are left categories
+        SampleIndexType max_partition_index;
+        {
+            DECISIONTREE_PROFILE_TIME(profile.rearrange_time);
+            SampleIndexType index = missing_value_index, next_index = num_samples;
+            while (index < next_index) {
+                IndexType category = static_cast<IndexType>(f_column[sample_indices[index] * f_stride]);
+                if (category <= max_left_category && ((categories[category / 64] >> (category % 64)) & 1)) {
+                    ++index;
+                }
+                else {
+                    --next_index;
+                    std::swap(sample_indices[index], sample_indices[next_index]);
+                }
+            }
+            max_partition_index = start_ + next_index;
+        }
+
+        // samples without missing values
+        if (missing_value_index == 0) {
+            partition_index = max_partition_index;
+            partition_threshold = std::numeric_limits<FeatureType>::quiet_NaN();
+            improvement = max_improvement;
+            has_missing_value = -1;
+            return ;
+        }
+
+        // call compute_children_impurity_missing and compute left 
+        // and right improvement for samples with missing values
+        double left_impurity_improvement = 0.0, right_impurity_improvement = 0.0;
+        {
+            DECISIONTREE_PROFILE_TIME(profile.impurity_time);
+            criterion.compute_children_impurity_missing();
+            left_impurity_improvement = criterion.compute_left_impurity_improvement_missing();
+            right_impurity_improvement = criterion.compute_right_impurity_improvement_missing();
+        }
+
+        if (left_impurity_improvement > right_impurity_improvement && improvement < left_impurity_improvement) {
+            // add missing values to left child
+            improvement = left_impurity_improvement;
+            partition_index = max_partition_index;
+            has_missing_value = 0;
+        }
+        else if (left_impurity_improvement <= right_impurity_improvement && improvement < right_impurity_improvement) {
+            // add missing values to right child, move samples with 
+            // missing values to the end of the sample vector
+            improvement = right_impurity_improvement;
+            has_missing_value = 1;
+            DECISIONTREE_PROFILE_TIME(profile.rearrange_time);
+            std::vector<SampleIndexType>& sample_indice_missing = workspace.missing_sample_indices;
+            std::copy(&sample_indices[0], 
+                      &sample_indices[missing_value_index], 
+                      &sample_indice_missing[0]);
+            std::copy(&sample_indices[missing_value_index], 
+                      &sample_indices[num_samples], 
+                      &sample_indices[0]);
+            std::copy(&sample_indice_missing[0], 
+                      &sample_indice_missing[missing_value_index], 
+                      &sample_indices[num_samples - missing_value_index]);
+            partition_index = max_partition_index - missing_value_index;
+        }
+        else {
+            // the split of the missing values alone is better
+            categories.clear();
+        }
+    };
+
+    /**
+     * @brief quantize each feature column once into at most MAX_NUM_BINS bins, 
+     * the bin edges are the midpoints between consecutive distinct values, with 
+     * more distinct values than bins, edges are placed at the sample quantiles
+    */
+    void compute_feature_bins(const DataView& X) {
+        tables_->binned_X.resize(num_features_ * num_samples_);
+        tables_->bin_thresholds.assign(num_features_, std::vector<FeatureType>());
+        tables_->bin_offsets.assign(num_features_ + 1, 0);
+
+        std::vector<FeatureType> f_X;
+        f_X.reserve(num_samples_);
+        for (FeatureIndexType f = 0; f < num_features_; ++f) {
+            // sorted non-missing values and its distinct values
+            f_X.clear();
+            for (IndexType i = 0; i < num_samples_; ++i) {
+                if (!std::isnan(X(i, f))) {
+                    f_X.push_back(X(i, f));
+                }
+            }
+            std::sort(f_X.begin(), f_X.end());
+            std::vector<FeatureType> f_distinct(f_X.begin(), f_X.end());
+            f_distinct.erase(std::unique(f_distinct.begin(), f_distinct.end()), f_distinct.end());
+
+            std::vector<FeatureType>& thresholds = tables_->bin_thresholds[f];
+            if (f_distinct.size() <= MAX_NUM_BINS) {
+                for (IndexType k = 1; k < f_distinct.size(); ++k) {
+                    thresholds.push_back(compute_threshold(f_distinct[k - 1], f_distinct[k]));
+                }
+            }
+            else {
+                for (NumBinsType b = 1; b < MAX_NUM_BINS; ++b) {
+                    FeatureType value = f_X[b * f_X.size() / MAX_NUM_BINS - 1];
+                    auto next = std::upper_bound(f_distinct.begin(), f_distinct.end(), value);
+                    if (next == f_distinct.end()) {
+                        break;
+                    }
+                    FeatureType threshold = compute_threshold(value, *next);
+                    if (thresholds.empty() || threshold > thresholds.back()) {
+                        thresholds.push_back(threshold);
+                    }
+                }
+            }
+
+            // value x is in bin b if thresholds[b - 1] < x <= thresholds[b]
+            for (IndexType i = 0; i < num_samples_; ++i) {
+                FeatureType value = X(i, f);
+                if (std::isnan(value)) {
+                    tables_->binned_X[f * num_samples_ + i] = MISSING_VALUE_BIN;
+                }
+                else {
+                    tables_->binned_X[f * num_samples_ + i] = static_cast<BinType>(
+                        std::lower_bound(thresholds.begin(), thresholds.end(), value) - thresholds.begin()
+                    );
+                }
+            }
+            tables_->bin_offsets[f + 1] = tables_->bin_offsets[f] + thresholds.size() + 1;
+        }
+    }
+
+    /**
+     * @brief find the number of categories of each categorical feature, the 
+     * non-missing values of a categorical feature must be category codes, 
+     * integers in [0, MAX_NUM_CATEGORIES)
+    */
+    void compute_feature_categories(const DataView& X) {
+        tables_->num_categories.assign(num_features_, 0);
+        for (FeatureIndexType f = 0; f < num_features_; ++f) {
+            if (!is_categorical_[f]) {
+                continue;
+            }
+            NumBinsType num_categories = 0;
+            for (IndexType i = 0; i < num_samples_; ++i) {
+                FeatureType value = X(i, f);
+                if (std::isnan(value)) {
+                    continue;
+                }
+                if (!(value >= 0 && value < MAX_NUM_CATEGORIES) || value != std::floor(value)) {
+                    throw std::invalid_argument("Values of categorical features must be integers in [0, " + 
+                                                std::to_string(MAX_NUM_CATEGORIES) + ").");
+                }
+                num_categories = std::max<NumBinsType>(num_categories, static_cast<NumBinsType>(value) + 1);
+            }
+            tables_->num_categories[f] = num_categories;
+        }
+    }
+
+    /**
+     * @brief the histograms of a node hold the bins of all features with hist 
+     * split policy when all features are considered at each node, otherwise 
+     * binning all features costs more than binning the candidates only
+    */
+    bool has_bin_histograms() const {
+        return split_policy_ == SplitPolicy::hist && max_num_features_ == num_features_;
+    }
+
+    /**
+     * @brief count the samples in sample_indices[start:end] into the node 
+     * histogram of the criterion
+    */
+    void compute_node_histogram(const std::vector<ClassType>& y, 
+                                SampleIndexType start, 
+                                SampleIndexType end) {
+        switch (criterion_) {
+            case CriterionKind::gini:
+                static_cast<Gini&>(*criterion_ptr_).compute_node_histogram(y, buffer_->sample_indices, start, end);
+                break;
+            case CriterionKind::entropy:
+                static_cast<Entropy&>(*criterion_ptr_).compute_node_histogram(y, buffer_->sample_indices, start, end);
+                break;
+            case CriterionKind::gradient:
+                static_cast<GradientCriterion&>(*criterion_ptr_).compute_node_histogram(y, buffer_->sample_indices, start, end);
+                break;
+        }
+    }
+
+    /**
+     * @brief unweighted histograms of the bins of all features for the samples 
+     * in sample_indices[start:end], samples with missing values are left out, 
+     * the features of a large node are binned in parallel
+    */
+    template<typename CriterionType>
+    void compute_bin_histograms(const std::vector<ClassType>& y, 
+                                SampleIndexType start, 
+                                SampleIndexType end, 
+                                const CriterionType& criterion, 
+                                NodeHistograms& histograms) {
+        DECISIONTREE_PROFILE_TIME(profile_.histogram_update_time);
+        NumClassesType bin_stride = num_outputs_ * max_num_classes_;
+        histograms.bin_histograms.assign(tables_->bin_offsets.back() * bin_stride, 0.0);
+        histograms.bin_num_samples.assign(tables_->bin_offsets.back(), 0);
+        const std::vector<SampleIndexType>& sample_indices = buffer_->sample_indices;
+        auto bin_feature = [&](IndexType f) {
+            const BinType* f_bins = &tables_->binned_X[f * num_samples_];
+            HistogramType* f_bin_histogram = &histograms.bin_histograms[tables_->bin_offsets[f] * bin_stride];
+            NumSamplesType* f_bin_num_samples = &histograms.bin_num_samples[tables_->bin_offsets[f]];
+            for (IndexType i = start; i < end; ++i) {
+                BinType bin = f_bins[sample_indices[i]];
+                if (bin != MISSING_VALUE_BIN) {
+                    f_bin_num_samples[bin]++;
+                    criterion.add_sample_to_histogram(y, sample_indices[i], &f_bin_histogram[bin * bin_stride]);
+                }
+            }
+        };
+
+        if (num_threads_ > 1 && end - start >= MIN_PARALLEL_NUM_SAMPLES) {
+            if (thread_pool_ == nullptr) {
+                thread_pool_ = std::make_shared<ThreadPool>(num_threads_);
+            }
+            thread_pool_->parallel_for(0, num_features_, bin_feature);
+        }
+        else {
+            for (FeatureIndexType f = 0; f < num_features_; ++f) {
+                bin_feature(f);
+            }
+        }
+    }
+
+    void compute_bin_histograms(const std::vector<ClassType>& y, 
+                                SampleIndexType start, 
+                                SampleIndexType end, 
+                                NodeHistograms& histograms) {
+        switch (criterion_) {
+            case CriterionKind::gini:
+                compute_bin_histograms(y, start, end, static_cast<const Gini&>(*criterion_ptr_), histograms);
+                break;
+            case CriterionKind::entropy:
+                compute_bin_histograms(y, start, end, static_cast<const Entropy&>(*criterion_ptr_), histograms);
+                break;
+            case CriterionKind::gradient:
+                compute_bin_histograms(y, start, end, static_cast<const GradientCriterion&>(*criterion_ptr_), histograms);
+                break;
+        }
+    }
+
+    /**
+     * @brief keep the presorted orders valid for the child nodes, samples in 
+     * buffer_->sample_indices[start:partition_index] go to the left child, stable 
+     * partition buffer_->presorted_indices[f, start:end] of each feature accordingly
+    */
+    void partition_presorted_indices(SampleIndexType partition_index) {
+        DECISIONTREE_PROFILE_TIME(profile_.rearrange_time);
+        if (presorted_buffer_.size() < end_ - start_) {
+            presorted_buffer_.resize(num_samples_);
+        }
+        for (IndexType i = start_; i < end_; ++i) {
+            buffer_->is_left_mask[buffer_->sample_indices[i]] = (i < partition_index) ? 1 : 0;
+        }
+
+        for (FeatureIndexType f = 0; f < num_features_; ++f) {
+            SampleIndexType* f_indices = &buffer_->presorted_indices[f * num_samples_];
+            SampleIndexType left_index = start_;
+            SampleIndexType right_index = 0;
+            for (IndexType i = start_; i < end_; ++i) {
+                if (buffer_->is_left_mask[f_indices[i]]) {
+                    f_indices[left_index++] = f_indices[i];
+                }
+                else {
+                    presorted_buffer_[right_index++] = f_indices[i];
+                }
+            }
+            std::copy(&presorted_buffer_[0], &presorted_buffer_[right_index], &f_indices[left_index]);
+        }
+    }
+
+    /**
+     * @brief split the samples of the current node on one feature 
+     * with the split policy and the given criterion of final type 
+     * CriterionType, the criterion calls of the threshold scan are 
+     * resolved at compile time. The samples of the node are reordered 
+     * in place in workspace.sample_indices[0:end - start].
+    */
+    template<typename CriterionType>
+    void split_feature(const DataView& X, 
+                       const std::vector<ClassType>& y, 
+                       FeatureIndexType feature_index, 
+                       SampleIndexType& partition_index,
+                       FeatureType& partition_threshold,
+                       double& improvement, 
+                       int& has_missing_value, 
+                       CriterionType& criterion, 
+                       SplitWorkspace& workspace) {
+        DECISIONTREE_PROFILE_RECORD(workspace.profile.num_samples_touched += end_ - start_);
+        workspace.categories.clear();
+        // categorical features are split by sets of categories for any split policy
+        if (is_categorical(feature_index)) {
+            categorical_split_feature(X, y, 
+                                      feature_index, 
+                                      partition_index, 
+                                      partition_threshold, 
+                                      improvement, 
+                                      has_missing_value, 
+                                      criterion, 
+                                      workspace);
+            return ;
+        }
+        switch (split_policy_) {
+            case SplitPolicy::best:
+                best_split_feature(X, y, 
+                                   feature_index, 
+                                   partition_index, 
+                                   partition_threshold, 
+                                   improvement, 
+                                   has_missing_value, 
+                                   criterion, 
+                                   workspace);
+                break;
+            case SplitPolicy::random:
+                random_split_feature(X, y, 
+                                     feature_index,
+                                     partition_index,
+                                     partition_threshold,
+                                     improvement,
+                                     has_missing_value, 
+                                     criterion, 
+                                     workspace);
+                break;
+            case SplitPolicy::hist:
+                hist_split_feature(y, 
+                                   feature_index,
+                                   partition_index,
+                                   partition_threshold,
+                                   improvement,
+                                   has_missing_value, 
+                                   criterion, 
+                                   workspace);
+                break;
+        }
+    }
+
+    /**
+     * @brief split the samples of the current node on one feature, 
+     * dispatch once on the criterion selected at construction
+    */
+    void split_feature(const DataView& X, 
+                       const std::vector<ClassType>& y, 
+                       FeatureIndexType feature_index, 
+                       SampleIndexType& partition_index,
+                       FeatureType& partition_threshold,
+                       double& improvement, 
+                       int& has_missing_value, 
+                       Criterion& criterion, 
+                       SplitWorkspace& workspace) {
+        switch (criterion_) {
+            case CriterionKind::gini:
+                split_feature(X, y, 
+                              feature_index, 
+                              partition_index, 
+                              partition_threshold, 
+                              improvement, 
+                              has_missing_value, 
+                              static_cast<Gini&>(criterion), 
+                              workspace);
+                break;
+            case CriterionKind::entropy:
+                split_feature(X, y, 
+                              feature_index, 
+                              partition_index, 
+                              partition_threshold, 
+                              improvement, 
+                              has_missing_value, 
+                              static_cast<Entropy&>(criterion), 
+                              workspace);
+                break;
+            case CriterionKind::gradient:
+                split_feature(X, y, 
+                              feature_index, 
+                              partition_index, 
+                              partition_threshold, 
+                              improvement, 
+                              has_missing_value, 
+                              static_cast<GradientCriterion&>(criterion), 
+                              workspace);
+                break;
+        }
+    }
+
+    /**
+     * @brief allocate the criterion and the workspace of num_tasks tasks, 
+     * the ones of previous nodes are kept, so the split search of a node 
+     * only allocates the first time it runs on more tasks
+    */
+    void init_workspaces(NumThreadsType num_tasks) {
+        NumClassesType bin_stride = num_outputs_ * max_num_classes_;
+        NumBinsType num_bins = (split_policy_ == SplitPolicy::hist) ? MAX_NUM_BINS + 1 : 0;
+        while (task_criterion_ptrs_.size() < num_tasks) {
+            task_criterion_ptrs_.push_back(create_criterion());
+        }
+        while (task_workspaces_.size() < num_tasks) {
+            task_workspaces_.emplace_back(num_samples_, bin_stride, num_bins);
+        }
+        if (task_splits_.size() < num_tasks) {
+            task_splits_.resize(num_tasks);
+        }
+    }
+
+    /**
+     * @brief evaluate the candidate features independently of each other, 
+     * each task owns its criterion and sample indices and searches the 
+     * features k, k + num_tasks, ..., the results are reduced in a fixed 
+     * way: the best improvement wins and ties go to the lowest feature index, 
+     * so the split depends neither on the number of threads nor on the order 
+     * the candidates are drawn in.
+    */
+    void split_candidate_features(const DataView& X, 
+                                  const std::vector<ClassType>& y, 
+                                  const std::vector<FeatureIndexType>& f_candidates, 
+                                  FeatureIndexType& feature_index, 
+                                  SampleIndexType& partition_index,
+                                  FeatureType& partition_threshold,
+                                  double& improvement, 
+                                  int& has_missing_value) {
+        if (f_candidates.empty()) {
+            return ;
+        }
+        NumSamplesType num_samples = end_ - start_;
+
+        // random split policy draws thresholds from the shared random state, 
+        // small nodes are not worth waking up the workers
+        NumThreadsType num_tasks = 1;
+        if (num_threads_ > 1 && split_policy_ != SplitPolicy::random && num_samples >= MIN_PARALLEL_NUM_SAMPLES) {
+            num_tasks = std::min<NumThreadsType>(num_threads_, f_candidates.size());
+            if (thread_pool_ == nullptr) {
+                thread_pool_ = std::make_shared<ThreadPool>(num_threads_);
+            }
+        }
+        init_workspaces(num_tasks);
+
+        double min_improvement = improvement;
+        auto split_task = [&](IndexType task) {
+            // copy the node state into the criterion of the task
+            *task_criterion_ptrs_[task] = *criterion_ptr_;
+            SplitWorkspace& workspace = task_workspaces_[task];
+            std::copy(&buffer_->sample_indices[start_], 
+                      &buffer_->sample_indices[end_], 
+                      workspace.sample_indices.begin());
+            SplitInfo& best_split = task_splits_[task];
+            best_split = SplitInfo(min_improvement);
+
+            for (IndexType k = task; k < f_candidates.size(); k += num_tasks) {
+                SplitInfo split(min_improvement);
+                split.feature_index = f_candidates[k];
+                split_feature(X, y, 
+                              split.feature_index, 
+                              split.partition_index, 
+                              split.partition_threshold, 
+                              split.improvement, 
+                              split.has_missing_value, 
+                              *task_criterion_ptrs_[task], 
+                              workspace);
+                split.is_found = split.improvement > min_improvement;
+                if (split.is_better_than(best_split)) {
+                    DECISIONTREE_PROFILE_TIME(workspace.profile.rearrange_time);
+                    best_split = split;
+                    workspace.best_categories.swap(workspace.categories);
+                    std::copy(workspace.sample_indices.begin(), 
+                              workspace.sample_indices.begin() + num_samples, 
+                              workspace.best_sample_indices.begin());
+                }
+            }
+        };
+
+        if (num_tasks > 1) {
+            thread_pool_->parallel_for(0, num_tasks, split_task);
+        }
+        else {
+            split_task(0);
+        }
+
+        // reduce the best split of each task
+        IndexType best_task = 0;
+        for (IndexType task = 1; task < num_tasks; ++task) {
+            if (task_splits_[task].is_better_than(task_splits_[best_task])) {
+                best_task = task;
+            }
+        }
+        const SplitInfo& best_split = task_splits_[best_task];
+        if (best_split.is_found) {
+            feature_index = best_split.feature_index;
+            partition_index = best_split.partition_index;
+            partition_threshold = best_split.partition_threshold;
+            improvement = best_split.improvement;
+            has_missing_value = best_split.has_missing_value;
+            const SplitWorkspace& workspace = task_workspaces_[best_task];
+            split_categories_ = workspace.best_categories;
+            // replace buffer_->sample_indices with ordered sample indices of the best split
+            DECISIONTREE_PROFILE_TIME(profile_.rearrange_time);
+            std::copy(workspace.best_sample_indices.begin(), 
+                      workspace.best_sample_indices.begin() + num_samples, 
+                      &buffer_->sample_indices[start_]);
+        }
+    }
+
+    static CriterionKind to_criterion_kind(const std::string& criterion) {
+        if (criterion == "gini") {
+            return CriterionKind::gini;
+        }
+        if (criterion == "entropy") {
+            return CriterionKind::entropy;
+        }
+        if (criterion == "gradient") {
+            return CriterionKind::gradient;
+        }
+        throw std::invalid_argument("Criterion must be 'gini', 'entropy' or 'gradient'.");
+    }
+
+    static SplitPolicy to_split_policy(const std::string& split_policy) {
+        if (split_policy == "best") {
+            return SplitPolicy::best;
+        }
+        if (split_policy == "random") {
+            return SplitPolicy::random;
+        }
+        if (split_policy == "hist") {
+            return SplitPolicy::hist;
+        }
+        throw std::invalid_argument("Split policy must be 'best', 'random' or 'hist'.");
+    }
+
+    std::shared_ptr<Criterion> create_criterion() const {
+        if (criterion_ == CriterionKind::gradient) {
+            return std::make_shared<decisiontree::GradientCriterion>(num_samples_, 
+                                                                     gradients_, 
+                                                                     hessians_, 
+                                                                     l2_regularization_);
+        }
+        if (criterion_ == CriterionKind::entropy) {
+            return std::make_shared<decisiontree::Entropy>(num_outputs_, 
+                                                           num_samples_, 
+                                                           max_num_classes_,
+                                                           num_classes_list_, 
+                                                           class_weight_);
+        }
+        return std::make_shared<decisiontree::Gini>(num_outputs_, 
+                                                    num_samples_, 
+                                                    max_num_classes_,
+                                                    num_classes_list_, 
+                                                    class_weight_);
+    }
+
 public:
     std::shared_ptr<decisiontree::Criterion> criterion_ptr_;
 
 public:
     // default constructor 
-    Splitter() {};
+    BasicSplitter() {};
 
     // copy constructor
-    Splitter(const Splitter& splitter): num_outputs_(splitter.num_outputs_), 
+    BasicSplitter(const BasicSplitter& splitter): BasicSplitter(splitter, false) {};
+
+    // move constructor, takes over the samples and the criterion of splitter
+    BasicSplitter(BasicSplitter&& splitter) = default;
+
+    /**
+     * @brief copy a splitter, with share_sample_buffer the copy shares the 
+     * sample order and the feature lookup tables of splitter from the start, 
+     * see share_sample_buffer, otherwise it keeps its own samples to train on
+    */
+    BasicSplitter(const BasicSplitter& splitter, 
+                  bool share_sample_buffer): num_outputs_(splitter.num_outputs_), 
         num_samples_(splitter.num_samples_), 
         num_features_(splitter.num_features_),
         max_num_features_(splitter.max_num_features_), 
@@ -317,30 +1514,26 @@ public:
         criterion_(splitter.criterion_),
         split_policy_(splitter.split_policy_),
         random_state_(splitter.random_state_), 
+        presort_(splitter.presort_), 
+        is_categorical_(splitter.is_categorical_), 
+        gradients_(splitter.gradients_), 
+        hessians_(splitter.hessians_), 
+        l2_regularization_(splitter.l2_regularization_), 
         // init s_ptr for criterion class and sample index array 
         start_(splitter.start_), 
         end_(splitter.end_),
-        sample_indices_(splitter.num_samples_),
+        // a copy keeps the samples to train on and shares the lookup tables
+        buffer_(share_sample_buffer ? splitter.buffer_ 
+                                    : std::make_shared<SampleBuffer>(splitter.buffer_->sample_indices)),
+        tables_(splitter.tables_),
+        num_threads_(splitter.num_threads_), 
+        thread_pool_(nullptr), 
         criterion_ptr_(splitter.criterion_ptr_) {
-            std::iota(sample_indices_.begin(), sample_indices_.end(), 0);
-            if (criterion_ == "gini") {
-                criterion_ptr_ = std::make_shared<decisiontree::Gini>(num_outputs_, 
-                                                                      num_samples_, 
-                                                                      max_num_classes_,
-                                                                      num_classes_list_, 
-                                                                      class_weight_);
-            }
-            else if (criterion_ == "entropy") {
-                criterion_ptr_ = std::make_shared<decisiontree::Entropy>(num_outputs_, 
-                                                                        num_samples_, 
-                                                                        max_num_classes_,
-                                                                        num_classes_list_, 
-                                                                        class_weight_);
-            }
+            criterion_ptr_ = create_criterion();
         };
 
     // assignment constructor
-    Splitter& operator=(const Splitter& splitter) {
+    BasicSplitter& operator=(const BasicSplitter& splitter) {
         num_outputs_ = splitter.num_outputs_;
         num_samples_ = splitter.num_samples_;
         num_features_ = splitter.num_features_;
@@ -351,72 +1544,255 @@ public:
         criterion_ = splitter.criterion_;
         split_policy_ = splitter.split_policy_;
         random_state_ = splitter.random_state_; 
+        presort_ = splitter.presort_;
+        is_categorical_ = splitter.is_categorical_;
+        gradients_ = splitter.gradients_;
+        hessians_ = splitter.hessians_;
+        l2_regularization_ = splitter.l2_regularization_;
         
         start_ = splitter.start_;
         end_ = splitter.end_;
-        sample_indices_ = splitter.sample_indices_;
-        std::iota(sample_indices_.begin(), sample_indices_.end(), 0);
-        criterion_ptr_ = splitter.criterion_ptr_;
-        if (criterion_ == "gini") {
-            criterion_ptr_ = std::make_shared<decisiontree::Gini>(num_outputs_, 
-                                                                num_samples_, 
-                                                                max_num_classes_,
-                                                                num_classes_list_, 
-                                                                class_weight_);
-            }
-        else if (criterion_ == "entropy") {
-            criterion_ptr_ = std::make_shared<decisiontree::Entropy>(num_outputs_, 
-                                                                    num_samples_, 
-                                                                    max_num_classes_,
-                                                                    num_classes_list_, 
-                                                                    class_weight_);
-        }
+        buffer_ = std::make_shared<SampleBuffer>(splitter.buffer_->sample_indices);
+        tables_ = splitter.tables_;
+        num_threads_ = splitter.num_threads_;
+        thread_pool_ = nullptr;
+        task_criterion_ptrs_.clear();
+        task_workspaces_.clear();
+        profile_.clear();
+        criterion_ptr_ = create_criterion();
         return *this;
     }
 
     // constructor with parameters
-    Splitter(NumOutputsType num_outputs,
-             NumSamplesType num_samples,
-             NumFeaturesType num_features, 
-             NumFeaturesType max_num_features, 
-             NumClassesType max_num_classes, 
-             std::vector<ClassWeightType> class_weight,
-             std::vector<NumClassesType> num_classes_list, 
-             std::string criterion, 
-             std::string split_policy, 
-             const RandomState& random_state): num_outputs_(num_outputs), 
+    BasicSplitter(NumOutputsType num_outputs,
+                  NumSamplesType num_samples,
+                  NumFeaturesType num_features, 
+                  NumFeaturesType max_num_features, 
+                  NumClassesType max_num_classes, 
+                  std::vector<ClassWeightType> class_weight,
+                  std::vector<NumClassesType> num_classes_list, 
+                  std::string criterion, 
+                  std::string split_policy, 
+                  const RandomState& random_state, 
+                  bool presort = false, 
+                  NumThreadsType num_threads = 1): num_outputs_(num_outputs), 
         num_samples_(num_samples), 
         num_features_(num_features),
         max_num_features_(max_num_features), 
         max_num_classes_(max_num_classes),
         class_weight_(class_weight), 
         num_classes_list_(num_classes_list),
-        criterion_(criterion),
-        split_policy_(split_policy),
+        criterion_(to_criterion_kind(criterion)),
+        split_policy_(to_split_policy(split_policy)),
         random_state_(random_state), 
+        presort_(presort && split_policy == "best"), 
+        gradients_(nullptr), 
+        hessians_(nullptr), 
+        l2_regularization_(0.0), 
         // init sample index array 
         start_(0), 
         end_(num_samples),
-        sample_indices_(num_samples),
+        buffer_(std::make_shared<SampleBuffer>(num_samples)),
+        tables_(std::make_shared<FeatureTables>()),
+        num_threads_(std::max<NumThreadsType>(num_threads, 1)), 
+        thread_pool_(nullptr), 
         criterion_ptr_(nullptr) {
             // init s_ptr for criterion class and sample index array
-            std::iota(sample_indices_.begin(), sample_indices_.end(), 0);
-            if (criterion_ == "gini") {
-                criterion_ptr_ = std::make_shared<decisiontree::Gini>(num_outputs_, 
-                                                                    num_samples_, 
-                                                                    max_num_classes_,
-                                                                    num_classes_list_, 
-                                                                    class_weight_);
-            }
-            else if (criterion_ == "entropy") {
-                criterion_ptr_ = std::make_shared<decisiontree::Entropy>(num_outputs_, 
-                                                                        num_samples_, 
-                                                                        max_num_classes_,
-                                                                        num_classes_list_, 
-                                                                        class_weight_);
-            }
+            criterion_ptr_ = create_criterion();
         };
-    ~Splitter() {};
+    ~BasicSplitter() {};
+
+    /**
+     * @brief compute the per-feature lookup tables required by the splitter: 
+     * with presort, the order of all samples by each feature column, missing 
+     * values first, with hist split policy, the bins of each feature column, 
+     * and the number of categories of the categorical features. The tables 
+     * only depend on X, they are computed once and shared by the copies of 
+     * the splitter, so a builder which grows several trees on the same X, 
+     * e.g. the rounds of boosting or the trees of a forest, computes them 
+     * once. Call it before copies of the splitter run init_features 
+     * concurrently.
+    */
+    void init_feature_tables(const DataView& X) {
+        if (!is_categorical_.empty() && tables_->num_categories.empty()) {
+            compute_feature_categories(X);
+        }
+        if (split_policy_ == SplitPolicy::hist && tables_->binned_X.empty()) {
+            compute_feature_bins(X);
+        }
+        if (presort_ && tables_->sorted_indices.empty()) {
+            tables_->sorted_indices.resize(num_features_ * num_samples_);
+            for (FeatureIndexType f = 0; f < num_features_; ++f) {
+                auto first = tables_->sorted_indices.begin() + f * num_samples_;
+                auto last = first + num_samples_;
+                std::iota(first, last, 0);
+                std::stable_sort(first, last, 
+                    [&X, f](SampleIndexType left, SampleIndexType right) -> bool {
+                        FeatureType left_value = X(left, f);
+                        FeatureType right_value = X(right, f);
+                        if (std::isnan(left_value)) {
+                            return !std::isnan(right_value);
+                        }
+                        return left_value < right_value;
+                    });
+            }
+        }
+    }
+
+    /**
+     * @brief prepare the splitter before building a tree on its samples, 
+     * compute the lookup tables if not done yet, with presort, order the 
+     * samples of the tree by each feature column, a sample drawn k times 
+     * is repeated k times in the order of all samples.
+    */
+    void init_features(const DataView& X) {
+        init_feature_tables(X);
+        if (!presort_) {
+            return ;
+        }
+        buffer_->presorted_indices.resize(num_features_ * num_samples_);
+        presorted_buffer_.resize(num_samples_);
+        buffer_->is_left_mask.resize(num_samples_);
+
+        // the samples of the tree in the order of all samples, without 
+        // sorting again, each with its number of draws
+        std::vector<NumSamplesType> num_draws(num_samples_, 0);
+        for (SampleIndexType sample_index : buffer_->sample_indices) {
+            num_draws[sample_index]++;
+        }
+        for (FeatureIndexType f = 0; f < num_features_; ++f) {
+            const SampleIndexType* f_sorted_indices = &tables_->sorted_indices[f * num_samples_];
+            SampleIndexType* f_indices = &buffer_->presorted_indices[f * num_samples_];
+            for (IndexType k = 0; k < num_samples_; ++k) {
+                for (NumSamplesType d = 0; d < num_draws[f_sorted_indices[k]]; ++d) {
+                    *f_indices++ = f_sorted_indices[k];
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief share the sample order and the feature lookup tables of another 
+     * splitter on the same training data, both splitters can then split 
+     * disjoint nodes of the same tree concurrently.
+    */
+    void share_sample_buffer(const BasicSplitter& splitter) {
+        buffer_ = splitter.buffer_;
+        tables_ = splitter.tables_;
+    }
+
+    /**
+     * @brief train on the given draws of samples instead of each sample once, 
+     * e.g. a bootstrap sample, a sample drawn k times weighs k times in 
+     * the histograms. Call it before init_features.
+     * 
+     * @param sample_indices num_samples draws in [0, num_samples), with repetitions
+    */
+    void set_sample_indices(const std::vector<SampleIndexType>& sample_indices) {
+        if (sample_indices.size() != num_samples_) {
+            throw std::invalid_argument("Number of sample draws must be equal to the number of samples.");
+        }
+        for (SampleIndexType sample_index : sample_indices) {
+            if (sample_index >= num_samples_) {
+                throw std::invalid_argument("Sample index of the draws is out of range.");
+            }
+        }
+        buffer_->sample_indices = sample_indices;
+    }
+
+    /**
+     * @brief mark the features holding category codes, they are split by sets 
+     * of categories instead of thresholds. Call it before init_features.
+     * 
+     * @param is_categorical num_features flags, or empty if all features are numerical
+    */
+    void set_categorical_features(const std::vector<bool>& is_categorical) {
+        if (!is_categorical.empty() && is_categorical.size() != num_features_) {
+            throw std::invalid_argument("Number of categorical flags must be equal to the number of features.");
+        }
+        is_categorical_ = is_categorical;
+        tables_ = std::make_shared<FeatureTables>();
+    }
+
+    bool is_categorical(FeatureIndexType feature_index) const {
+        return !is_categorical_.empty() && is_categorical_[feature_index];
+    }
+
+    /**
+     * @brief left categories of the last split found by split_node as a 
+     * bitset, empty if the split is on a threshold
+    */
+    const std::vector<std::uint64_t>& get_split_categories() const {
+        return split_categories_;
+    }
+
+    /**
+     * @brief the sample order of the tree being built, the samples of a node 
+     * are sample_indices[start:end]
+    */
+    const std::vector<SampleIndexType>& get_sample_indices() const {
+        return buffer_->sample_indices;
+    }
+
+    /**
+     * @brief add the time and the work of the split search since the last 
+     * clear_profile to profile, empty unless DECISIONTREE_PROFILE is defined
+    */
+    void get_profile(TrainingProfile& profile) const {
+        profile.merge(profile_);
+        for (const auto& workspace : task_workspaces_) {
+            profile.merge(workspace.profile);
+        }
+    }
+
+    void clear_profile() {
+        profile_.clear();
+        for (auto& workspace : task_workspaces_) {
+            workspace.profile.clear();
+        }
+    }
+
+    /**
+     * @brief set the gradients and the hessians of the loss which the gradient 
+     * criterion splits on, the buffers of num_samples values are read in place 
+     * and the caller keeps them alive while building.
+     * 
+     * @param l2_regularization L2 regularization of the leaf values
+    */
+    void set_gradients(const double* gradients, 
+                       const double* hessians, 
+                       double l2_regularization) {
+        if (criterion_ != CriterionKind::gradient) {
+            throw std::runtime_error("Gradients are only read by the gradient criterion.");
+        }
+        gradients_ = gradients;
+        hessians_ = hessians;
+        l2_regularization_ = l2_regularization;
+        static_cast<GradientCriterion&>(*criterion_ptr_).set_gradients(gradients, hessians, l2_regularization);
+        for (auto& task_criterion_ptr : task_criterion_ptrs_) {
+            static_cast<GradientCriterion&>(*task_criterion_ptr).set_gradients(gradients, hessians, l2_regularization);
+        }
+    }
+
+    /**
+     * @brief search split features on a shared thread pool with all its threads
+    */
+    void set_thread_pool(const std::shared_ptr<ThreadPool>& thread_pool) {
+        thread_pool_ = thread_pool;
+        num_threads_ = thread_pool->get_num_threads();
+    }
+
+    /**
+     * @brief draw a seed from the random state of the splitter, e.g. the 
+     * seed the builders derive the random states of the nodes of a tree from
+    */
+    unsigned long spawn_seed() {
+        return static_cast<unsigned long>(random_state_.uniform_int(0, LONG_MAX));
+    }
+
+    void set_random_state(const RandomState& random_state) {
+        random_state_ = random_state;
+    }
 
     /**
      * initialize node and compute weighted histograms and impurity for the node.
@@ -424,14 +1800,79 @@ public:
     void init_node(const std::vector<ClassType>& y, 
                    SampleIndexType start, 
                    SampleIndexType end) {
+        init_node(y, start, end, NodeHistograms());
+    }
+
+    /**
+     * @brief initialize node from the histograms derived by init_children of 
+     * its parent, the samples of the node are only counted if they are empty.
+    */
+    void init_node(const std::vector<ClassType>& y, 
+                   SampleIndexType start, 
+                   SampleIndexType end, 
+                   NodeHistograms&& histograms) {
         start_ = start;
         end_ = end;
-        criterion_ptr_->compute_node_histogram(y, sample_indices_, start, end);
+        node_histograms_ = std::move(histograms);
+        if (node_histograms_.statistics.empty()) {
+            compute_node_histogram(y, start, end);
+            criterion_ptr_->get_node_statistics(node_histograms_.statistics);
+        }
+        else {
+            criterion_ptr_->set_node_statistics(node_histograms_.statistics);
+        }
         criterion_ptr_->compute_node_impurity();
     }
 
+    /**
+     * @brief derive the histograms of both children of the node split by 
+     * split_node at partition_index, the smaller child is counted from its 
+     * samples and the larger one is the node minus the smaller child. It 
+     * leaves the criterion in an unspecified state.
+     * 
+     * @param with_bin_histograms also derive the bins of all features if the 
+     *      node holds them, e.g. false if the children will not be split
+    */
+    void init_children(const std::vector<ClassType>& y, 
+                       SampleIndexType partition_index, 
+                       bool with_bin_histograms, 
+                       NodeHistograms& left_histograms, 
+                       NodeHistograms& right_histograms) {
+        bool is_left_smaller = (partition_index - start_) <= (end_ - partition_index);
+        NodeHistograms& smaller = is_left_smaller ? left_histograms : right_histograms;
+        NodeHistograms& larger = is_left_smaller ? right_histograms : left_histograms;
+        SampleIndexType smaller_start = is_left_smaller ? start_ : partition_index;
+        SampleIndexType smaller_end = is_left_smaller ? partition_index : end_;
+
+        // larger takes over the histograms of the node, then subtracts the smaller
+        larger = std::move(node_histograms_);
+        node_histograms_ = NodeHistograms();
+
+        compute_node_histogram(y, smaller_start, smaller_end);
+        criterion_ptr_->get_node_statistics(smaller.statistics);
+        for (IndexType k = 0; k < smaller.statistics.size(); ++k) {
+            larger.statistics[k] -= smaller.statistics[k];
+        }
+
+        if (with_bin_histograms && !larger.bin_num_samples.empty()) {
+            compute_bin_histograms(y, smaller_start, smaller_end, smaller);
+            for (IndexType k = 0; k < smaller.bin_histograms.size(); ++k) {
+                larger.bin_histograms[k] -= smaller.bin_histograms[k];
+            }
+            for (IndexType k = 0; k < smaller.bin_num_samples.size(); ++k) {
+                larger.bin_num_samples[k] -= smaller.bin_num_samples[k];
+            }
+        }
+        else {
+            smaller.bin_histograms.clear();
+            smaller.bin_num_samples.clear();
+            larger.bin_histograms.clear();
+            larger.bin_num_samples.clear();
+        }
+    }
 
-    void split_node(const std::vector<FeatureType>& X, 
+
+    void split_node(const DataView& X, 
                     const std::vector<ClassType>& y, 
                     FeatureIndexType& feature_index, 
                     SampleIndexType& partition_index,
@@ -439,31 +1880,51 @@ public:
                     double& improvement, 
                     int& has_missing_value) {
 
-        // copy current sample_indices = sample_indices[start_, end_]
-        // lookup-table to the training data X, y
-        NumSamplesType num_samples = end_ - start_;
-        std::vector<SampleIndexType> f_sample_indice(num_samples);
-        std::copy(&sample_indices_[start_], &sample_indices_[end_], f_sample_indice.begin());
+        split_categories_.clear();
+
+        // bins of all features for the hist split policy, unless derived from the parent
+        if (has_bin_histograms() && node_histograms_.bin_num_samples.empty()) {
+            compute_bin_histograms(y, start_, end_, node_histograms_);
+        }
 
         // loop: k random features (k defined by max_num_features)
         // loop all features in random order
 
         // sampling features without replacement in an iterative way
         // init a feature index array
-        std::vector<FeatureIndexType> f_indices(num_features_);
+        std::vector<FeatureIndexType>& f_indices = feature_indices_;
+        f_indices.resize(num_features_);
         std::iota(f_indices.begin(), f_indices.end(), 0);
 
+        // draw the max_num_features candidate features first, 
         // i is in range of [0, num_features - 1]
+        std::vector<FeatureIndexType>& f_candidates = candidate_features_;
+        f_candidates.clear();
+        f_candidates.reserve(num_features_);
         FeatureIndexType i = num_features_;
-        while ((i > (num_features_ - max_num_features_)) || 
-               (improvement < EPSILON && i > 0)) {
-            
-            // std::cout << "current index i = " << i << std::endl;
-            FeatureIndexType j = 0;
-            if (i > 0) {
-                j = static_cast<FeatureIndexType>(random_state_.uniform_int(0, i));
-            }
-            // std::cout << "random index j = " << j << std::endl;
+        while (i > (num_features_ - max_num_features_)) {
+            FeatureIndexType j = static_cast<FeatureIndexType>(random_state_.uniform_int(0, i));
+            --i;
+            std::swap(f_indices[i], f_indices[j]);
+            f_candidates.push_back(f_indices[i]);
+        }
+        split_candidate_features(X, y, f_candidates, 
+                                 feature_index, 
+                                 partition_index, 
+                                 partition_threshold, 
+                                 improvement, 
+                                 has_missing_value);
+
+        // copy current sample_indices = sample_indices[start_, end_] into the 
+        // workspace of the first task, lookup-table to the training data X, y
+        NumSamplesType num_samples = end_ - start_;
+        init_workspaces(1);
+        SplitWorkspace& workspace = task_workspaces_[0];
+        std::copy(&buffer_->sample_indices[start_], &buffer_->sample_indices[end_], workspace.sample_indices.begin());
+
+        // no candidate improves the impurity, keep drawing features one by one
+        while (improvement < EPSILON && i > 0) {
+            FeatureIndexType j = static_cast<FeatureIndexType>(random_state_.uniform_int(0, i));
             --i;
             std::swap(f_indices[i], f_indices[j]);
             FeatureIndexType f_index = f_indices[i];
@@ -473,25 +1934,14 @@ public:
             double f_improvement = improvement;
             SampleIndexType f_partition_index = 0;
             FeatureType f_partition_threshold = 0.0;
-
-            if (split_policy_ == "best") {
-                best_split_feature(X, y, 
-                                   f_sample_indice, 
-                                   f_index, 
-                                   f_partition_index, 
-                                   f_partition_threshold, 
-                                   f_improvement, 
-                                   f_has_missing_value);
-            }
-            else if (split_policy_ == "random") {
-                random_split_feature(X, y, 
-                                     f_sample_indice, 
-                                     f_index,
-                                     f_partition_index,
-                                     f_partition_threshold,
-                                     f_improvement,
-                                     f_has_missing_value);
-            }
+            split_feature(X, y, 
+                          f_index, 
+                          f_partition_index, 
+                          f_partition_threshold, 
+                          f_improvement, 
+                          f_has_missing_value, 
+                          *criterion_ptr_, 
+                          workspace);
             
             if (f_improvement > improvement) {
                 feature_index = f_index;
@@ -499,13 +1949,23 @@ public:
                 partition_threshold = f_partition_threshold;
                 improvement = f_improvement;
                 has_missing_value = f_has_missing_value;
-                // replace sample_indices_ with ordered f_sample_indices
-                std::copy(f_sample_indice.begin(), f_sample_indice.end(), &sample_indices_[start_]);
+                split_categories_ = workspace.categories;
+                // replace sample_indices of the node with ordered f_sample_indices
+                DECISIONTREE_PROFILE_TIME(profile_.rearrange_time);
+                std::copy(workspace.sample_indices.begin(), 
+                          workspace.sample_indices.begin() + num_samples, 
+                          &buffer_->sample_indices[start_]);
             }
         }
+
+        if (presort_ && improvement > EPSILON) {
+            partition_presorted_indices(partition_index);
+        }
     }
 };
 
+using Splitter = BasicSplitter<FeatureType, ClassType, SampleIndexType>;
+
 } //namespace
 
 #endif // CORE_SPLITTER_HPP_
\ No newline at end of file
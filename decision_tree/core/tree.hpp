@@ -2,19 +2,59 @@
 #define CORE_TREE_HPP_
 
 #include "common/prereqs.hpp"
+#include "utility/binary_io.hpp"
+#include "utility/math.hpp"
+#include "utility/thread_pool.hpp"
+
+#include "dataset.hpp"
 
 namespace decisiontree {
 
 /**
- * The binary tree is represented as a number of parallel arrays. The i-th
- * element of each array holds information about the node `i`. Node 0 is the
- * tree's root. 
- * 
- * For node data stored at index i, the two child nodes are at 
- * index (2 * i + 1) and (2 * i + 2); the parent node is (i - 1) // 2 
- * (where // indicates integer division).
+ * @brief the fields of a node read when traversing the tree, a leaf has 
+ * left_child = right_child = 0. A categorical split sends the categories 
+ * of a bitset of the tree to the left child instead of comparing to the 
+ * threshold, see TreeView::is_left. The layout is also the on-disk layout 
+ * of a node in the binary model format, is_categorical takes the 4 bytes 
+ * of padding of version 1, where they are zero.
 */
-class Tree {
+struct TreeNode {
+    NodeIndexType left_child;
+    NodeIndexType right_child;
+    FeatureIndexType feature_index;
+    FeatureType threshold;
+    int has_missing_value;
+    int is_categorical;
+
+    TreeNode(NodeIndexType left_child, 
+             NodeIndexType right_child, 
+             FeatureIndexType feature_index,
+             FeatureType threshold,
+             int has_missing_value, 
+             int is_categorical = 0): 
+        left_child(left_child), 
+        right_child(right_child), 
+        feature_index(feature_index),
+        threshold(threshold),
+        has_missing_value(has_missing_value), 
+        is_categorical(is_categorical) {};
+    
+    ~TreeNode() {};
+};
+
+static_assert(sizeof(TreeNode) == 40 && std::is_standard_layout<TreeNode>::value, 
+              "TreeNode must match its on-disk layout");
+
+class Tree;
+
+/**
+ * @brief a read-only view of the arrays of a tree, it serves predictions 
+ * either from the vectors of a Tree or in place from a binary model file 
+ * mapped in memory. A view is cheap to copy and never modified, storage 
+ * keeps the arrays alive, it is null when the view borrows them from a 
+ * Tree owned by the caller.
+*/
+class TreeView {
 private:
     struct IndexInfo {
         NodeIndexType index;
@@ -26,36 +66,596 @@ private:
         ~IndexInfo() {};
     };
 
-    struct TreeNode {
-        NodeIndexType left_child;
-        NodeIndexType right_child;
-        FeatureIndexType feature_index;
-        int has_missing_value;
-        FeatureType threshold;
-        double impurity;
-        double improvement;
-        std::vector<std::vector<HistogramType>> histogram;
-
-        TreeNode(NodeIndexType left_child, 
-                 NodeIndexType right_child, 
-                 FeatureIndexType feature_index,
-                 int has_missing_value,
-                 FeatureType threshold,
-                 double impurity,
-                 double improvement,
-                 const std::vector<std::vector<HistogramType>>& histogram): 
-            left_child(left_child), 
-            right_child(right_child), 
-            feature_index(feature_index),
-            has_missing_value(has_missing_value),
-            threshold(threshold),
-            impurity(impurity),
-            improvement(improvement),
-            histogram(histogram) {};
+    NumOutputsType num_outputs_;
+    NumFeaturesType num_features_;
+    std::vector<NumClassesType> num_classes_list_;
+
+    TreeDepthType max_depth_;
+    NodeIndexType node_count_;
+    NumClassesType max_num_classes_;
+
+    const TreeNode* nodes_;
+    const double* impurities_;
+    const double* improvements_;
+    const HistogramType* values_;
+    const double* proba_;
+
+    // the left categories of node i are the bitset 
+    // categories_[category_offsets_[i]:category_offsets_[i + 1]], 
+    // category c is bit c % 64 of word c / 64
+    const IndexType* category_offsets_;
+    const std::uint64_t* categories_;
+    std::shared_ptr<const void> storage_;
+
+    friend class Tree;
+
+    /**
+     * @brief sum of the weighted histogram of node for the first output
+    */
+    HistogramType compute_weighted_num_samples(NodeIndexType node_index) const {
+        const HistogramType* value = get_value(node_index);
+        return std::accumulate(value, value + num_classes_list_[0], 0.0);
+    };
+
+    /**
+     * @brief weight of node among the samples which go down both children of 
+     * its parent, node_weights[node] if given, otherwise the weighted number 
+     * of training samples of node
+    */
+    HistogramType get_node_weight(NodeIndexType node_index, const double* node_weights) const {
+        return (node_weights != nullptr) ? node_weights[node_index] : compute_weighted_num_samples(node_index);
+    };
+
+    /**
+     * @brief call func(leaf, weight) for the leaves reached by sample X[sample_index] 
+     * from node_index. When the sample misses the split feature of a node which 
+     * has no missing value direction, it goes down both children, weighted 
+     * by the share of each child in the weights of both, see get_node_weight.
+    */
+    template<typename FeatureType, typename Function>
+    void for_each_sample_leaf(const BasicDataView<FeatureType>& X, 
+                              IndexType sample_index, 
+                              NodeIndexType node_index, 
+                              const double* node_weights, 
+                              std::vector<IndexInfo>& node_index_stk, 
+                              Function&& func) const {
+        node_index_stk.clear();
+        node_index_stk.emplace_back(node_index, 1.0);
+
+        // loop root to leaf node
+        while (!node_index_stk.empty()) {
+            IndexInfo node_index_info = node_index_stk.back();
+            node_index_stk.pop_back();
+
+            while (nodes_[node_index_info.index].left_child > 0) {
+                const TreeNode& node = nodes_[node_index_info.index];
+                FeatureType x = X(sample_index, node.feature_index);
+                if (std::isnan(x)) {
+                    // split criterion which includes missing values
+                    // suppose has_missing_value = 0, missing value is at left node
+                    // has_missing_value = 1, missing value is at right node
+                    if (node.has_missing_value == 0) {
+                        node_index_info.index = node.left_child;
+                    }
+                    else if (node.has_missing_value == 1) {
+                        node_index_info.index = node.right_child;
+                    }
+                    else {
+                        // split criterion which does not include missing values
+                        HistogramType num_lefts = get_node_weight(node.left_child, node_weights);
+                        HistogramType num_rights = get_node_weight(node.right_child, node_weights);
+                        node_index_stk.emplace_back(node.right_child, 
+                                                    node_index_info.weight * num_rights / (num_lefts + num_rights));
+                        node_index_info.index = node.left_child;
+                        node_index_info.weight *= num_lefts / (num_lefts + num_rights);
+                    }
+                }
+                else {
+                    node_index_info.index = is_left(node_index_info.index, x) ? node.left_child : node.right_child;
+                }
+            }
+            func(node_index_info.index, node_index_info.weight);
+        }
+    };
+
+    /**
+     * @brief add the probabilities of the leaves reached by sample X[sample_index] 
+     * from node_index to proba, weighted by the weighted number of training 
+     * samples when the sample goes down both children of a node.
+    */
+    template<typename FeatureType>
+    void predict_sample_proba_missing(const BasicDataView<FeatureType>& X, 
+                                      IndexType sample_index, 
+                                      NodeIndexType node_index, 
+                                      std::vector<IndexInfo>& node_index_stk, 
+                                      double* proba) const {
+        const IndexType proba_size = num_outputs_ * max_num_classes_;
+        for_each_sample_leaf(X, sample_index, node_index, nullptr, node_index_stk, 
+                             [&](NodeIndexType leaf_index, double weight) {
+            // add the weighted probabilities of the leaf
+            const double* leaf_proba = &proba_[leaf_index * proba_size];
+            for (IndexType k = 0; k < proba_size; ++k) {
+                proba[k] += weight * leaf_proba[k];
+            }
+        });
+    };
+
+    /**
+     * @brief find the leaves of samples X[begin:end], the samples of the 
+     * block all move down one depth per pass over the block, those which 
+     * reach a leaf drop out of the active list. A sample which misses the 
+     * split feature of a node without missing value direction stops there 
+     * and is flagged in is_split_sample, it has to go down both children 
+     * in predict_sample_proba_missing from node_indices[k].
+    */
+    template<typename FeatureType>
+    void find_block_leaves(const BasicDataView<FeatureType>& X, 
+                           IndexType begin, 
+                           IndexType end, 
+                           NodeIndexType* node_indices, 
+                           bool* is_split_sample) const {
+        IndexType active_samples[NUM_SAMPLES_PER_BLOCK];
+        IndexType num_active_samples = end - begin;
+        for (IndexType k = 0; k < end - begin; ++k) {
+            node_indices[k] = 0;
+            active_samples[k] = k;
+            is_split_sample[k] = false;
+        }
+
+        while (num_active_samples > 0) {
+            IndexType num_next_samples = 0;
+            for (IndexType a = 0; a < num_active_samples; ++a) {
+                IndexType k = active_samples[a];
+                const TreeNode& node = nodes_[node_indices[k]];
+                if (node.left_child == 0) {
+                    continue;
+                }
+
+                FeatureType x = X(begin + k, node.feature_index);
+                if (!std::isnan(x)) {
+                    node_indices[k] = is_left(node_indices[k], x) ? node.left_child : node.right_child;
+                }
+                else if (node.has_missing_value == 0) {
+                    node_indices[k] = node.left_child;
+                }
+                else if (node.has_missing_value == 1) {
+                    node_indices[k] = node.right_child;
+                }
+                else {
+                    is_split_sample[k] = true;
+                    continue;
+                }
+                active_samples[num_next_samples++] = k;
+            }
+            num_active_samples = num_next_samples;
+        }
+    };
+
+    /**
+     * @brief predict probabilities of samples X[begin:end] into proba
+    */
+    template<typename FeatureType>
+    void predict_block_proba(const BasicDataView<FeatureType>& X, 
+                             IndexType begin, 
+                             IndexType end, 
+                             double* proba) const {
+        NodeIndexType node_indices[NUM_SAMPLES_PER_BLOCK];
+        bool is_split_sample[NUM_SAMPLES_PER_BLOCK];
+        std::vector<IndexInfo> node_index_stk;
+        find_block_leaves(X, begin, end, node_indices, is_split_sample);
+
+        const IndexType proba_size = num_outputs_ * max_num_classes_;
+        for (IndexType k = 0; k < end - begin; ++k) {
+            double* sample_proba = &proba[(begin + k) * proba_size];
+            if (is_split_sample[k]) {
+                std::fill_n(sample_proba, proba_size, 0.0);
+                predict_sample_proba_missing(X, 
+                                             begin + k, 
+                                             node_indices[k], 
+                                             node_index_stk, 
+                                             sample_proba);
+            }
+            else {
+                std::copy_n(&proba_[node_indices[k] * proba_size], proba_size, sample_proba);
+            }
+        }
+    };
+
+    /**
+     * @brief predict class labels of samples X[begin:end] into y, the label 
+     * of a sample is the class with the highest probability of its leaf
+    */
+    template<typename FeatureType, typename ClassType>
+    void predict_block_label(const BasicDataView<FeatureType>& X, 
+                             IndexType begin, 
+                             IndexType end, 
+                             ClassType* y) const {
+        NodeIndexType node_indices[NUM_SAMPLES_PER_BLOCK];
+        bool is_split_sample[NUM_SAMPLES_PER_BLOCK];
+        std::vector<IndexInfo> node_index_stk;
+        std::vector<double> split_sample_proba;
+        find_block_leaves(X, begin, end, node_indices, is_split_sample);
+
+        const IndexType proba_size = num_outputs_ * max_num_classes_;
+        for (IndexType k = 0; k < end - begin; ++k) {
+            const double* sample_proba = &proba_[node_indices[k] * proba_size];
+            if (is_split_sample[k]) {
+                split_sample_proba.assign(proba_size, 0.0);
+                predict_sample_proba_missing(X, 
+                                             begin + k, 
+                                             node_indices[k], 
+                                             node_index_stk, 
+                                             split_sample_proba.data());
+                sample_proba = split_sample_proba.data();
+            }
+            for (IndexType o = 0; o < num_outputs_; ++o) {
+                y[(begin + k) * num_outputs_ + o] = argmax<double, ClassType>(
+                    &sample_proba[o * max_num_classes_], num_classes_list_[o]
+                );
+            }
+        }
+    };
+
+    template<typename FeatureType>
+    void check_num_features(const BasicDataView<FeatureType>& X) const {
+        if (X.get_num_features() != num_features_) {
+            throw std::invalid_argument("Number of features of X does not match the tree.");
+        }
+    };
+
+public:
+    TreeView(): num_outputs_(0), 
+        num_features_(0), 
+        max_depth_(0), 
+        node_count_(0), 
+        max_num_classes_(0), 
+        nodes_(nullptr), 
+        impurities_(nullptr), 
+        improvements_(nullptr), 
+        values_(nullptr), 
+        proba_(nullptr), 
+        category_offsets_(nullptr), 
+        categories_(nullptr) {};
+    ~TreeView() {};
+
+    NodeIndexType get_node_count() const {
+        return node_count_;
+    };
+
+    NumOutputsType get_num_outputs() const {
+        return num_outputs_;
+    };
+
+    NumFeaturesType get_num_features() const {
+        return num_features_;
+    };
+
+    const std::vector<NumClassesType>& get_num_classes_list() const {
+        return num_classes_list_;
+    };
+
+    /**
+     * @brief pointer to the weighted histogram of node, of size 
+     * num_outputs * max_num_classes
+    */
+    const HistogramType* get_value(NodeIndexType node_index) const {
+        return &values_[node_index * num_outputs_ * max_num_classes_];
+    };
+
+    const TreeNode& get_node(NodeIndexType node_index) const {
+        return nodes_[node_index];
+    };
+
+    /**
+     * @brief true if a sample whose split feature value x is not missing goes 
+     * to the left child of node: x <= threshold for a numerical split, and 
+     * for a categorical split a single bit lookup of category x in the left 
+     * categories, categories outside the bitset go right.
+    */
+    template<typename FeatureType>
+    bool is_left(NodeIndexType node_index, FeatureType x) const {
+        const TreeNode& node = nodes_[node_index];
+        if (!node.is_categorical) {
+            return x <= node.threshold;
+        }
+        IndexType offset = category_offsets_[node_index];
+        IndexType num_words = category_offsets_[node_index + 1] - offset;
+        if (!(x >= 0) || x >= static_cast<FeatureType>(num_words * 64)) {
+            return false;
+        }
+        IndexType category = static_cast<IndexType>(x);
+        return (categories_[offset + category / 64] >> (category % 64)) & 1;
+    };
+
+    /**
+     * the importances of features is computed as the total improvement 
+     * of criterion brought by the feature.
+    */
+    void compute_feature_importance(std::vector<double>& importances) const {
+        importances.assign(num_features_, 0.0);
+        if (node_count_ == 0) {
+            return;
+        }
         
-        ~TreeNode() {};
+        // loop all node
+        for (IndexType i = 0; i < node_count_; ++i) {
+            // loop all non-leaf node, accumulate improvement per features
+            if (nodes_[i].left_child > 0) {
+                importances[nodes_[i].feature_index] += improvements_[i];
+            }
+        }
+
+        // normalizer
+        double norm_coeff = 0.0;
+        for (IndexType i = 0; i < num_features_; ++i) {
+            norm_coeff += importances[i];
+        }
+        if (norm_coeff > 0.0) {
+            for (IndexType i = 0; i < num_features_; ++i) {
+                importances[i] = importances[i] / norm_coeff;
+            }
+        }
+    };
+
+
+    /**
+     * @brief predict class probabilities of samples X of shape (num_samples, 
+     * num_features), in any layout, into proba of shape (num_samples, 
+     * num_outputs, max_num_classes). Samples are processed in blocks of 
+     * NUM_SAMPLES_PER_BLOCK which all descend the tree one depth at a time. 
+     * The normalized probabilities of a node are computed once in add_node, 
+     * so a sample only copies those of its leaf. 
+     * 
+     * The tree is only read, so concurrent calls on the same view are safe, 
+     * and nothing is allocated unless a sample goes down both children of 
+     * a node.
+     * 
+     * @param thread_pool pool to predict the blocks in parallel on, kept 
+     *      by the caller across calls, if null the blocks are predicted in 
+     *      the calling thread
+    */
+    template<typename FeatureType>
+    void predict_proba(const BasicDataView<FeatureType>& X, 
+                       double* proba, 
+                       ThreadPool* thread_pool = nullptr) const {
+        check_num_features(X);
+        for_each_block(X.get_num_samples(), NUM_SAMPLES_PER_BLOCK, thread_pool, [&](IndexType begin, IndexType end) {
+            predict_block_proba(X, begin, end, proba);
+        });
+    };
+
+    template<typename FeatureType>
+    void predict_proba(const FeatureType* X, 
+                       NumSamplesType num_samples,
+                       double* proba, 
+                       ThreadPool* thread_pool = nullptr) const {
+        predict_proba(BasicDataView<FeatureType>(X, num_samples, num_features_), proba, thread_pool);
+    };
+
+    template<typename FeatureType>
+    void predict_proba(const std::vector<FeatureType>& X, 
+                       NumSamplesType num_samples,
+                       std::vector<double>& proba, 
+                       ThreadPool* thread_pool = nullptr) const {
+        proba.resize(num_samples * num_outputs_ * max_num_classes_);
+        predict_proba(X.data(), num_samples, proba.data(), thread_pool);
+    };
+
+    /**
+     * @brief add node_values[leaf] of the leaf reached by each sample X[begin + k] 
+     * of a block of at most NUM_SAMPLES_PER_BLOCK samples to values[k * stride], 
+     * e.g. the leaf values of a boosted tree. The samples descend the tree as 
+     * in predict_proba, a sample going down both children of a node adds the 
+     * values of its leaves weighted as there.
+     * 
+     * @param node_weights weights of the nodes for the samples going down both 
+     *      children, e.g. the sums of hessians of a boosted tree whose histograms 
+     *      are not counts, if null the weighted numbers of training samples
+    */
+    template<typename FeatureType>
+    void add_block_values(const BasicDataView<FeatureType>& X, 
+                          IndexType begin, 
+                          IndexType end, 
+                          const double* node_values, 
+                          double* values, 
+                          IndexType stride, 
+                          const double* node_weights = nullptr) const {
+        NodeIndexType node_indices[NUM_SAMPLES_PER_BLOCK];
+        bool is_split_sample[NUM_SAMPLES_PER_BLOCK];
+        std::vector<IndexInfo> node_index_stk;
+        find_block_leaves(X, begin, end, node_indices, is_split_sample);
+
+        for (IndexType k = 0; k < end - begin; ++k) {
+            double& value = values[k * stride];
+            if (is_split_sample[k]) {
+                for_each_sample_leaf(X, begin + k, node_indices[k], node_weights, node_index_stk, 
+                                     [&](NodeIndexType leaf_index, double weight) {
+                    value += weight * node_values[leaf_index];
+                });
+            }
+            else {
+                value += node_values[node_indices[k]];
+            }
+        }
+    };
+
+    /**
+     * @brief predict class labels of samples X into y of shape 
+     * (num_samples, num_outputs), same as predict_proba without 
+     * writing the probabilities.
+    */
+    template<typename FeatureType, typename ClassType>
+    void predict(const BasicDataView<FeatureType>& X, 
+                 ClassType* y, 
+                 ThreadPool* thread_pool = nullptr) const {
+        check_num_features(X);
+        for_each_block(X.get_num_samples(), NUM_SAMPLES_PER_BLOCK, thread_pool, [&](IndexType begin, IndexType end) {
+            predict_block_label(X, begin, end, y);
+        });
+    };
+
+    template<typename FeatureType, typename ClassType>
+    void predict(const FeatureType* X, 
+                 NumSamplesType num_samples,
+                 ClassType* y, 
+                 ThreadPool* thread_pool = nullptr) const {
+        predict(BasicDataView<FeatureType>(X, num_samples, num_features_), y, thread_pool);
+    };
+
+    void print_node_info() const {
+        for (IndexType i = 0; i < node_count_; i++) {
+            std::cout << "left child = " << nodes_[i].left_child 
+                      << ", right child = " << nodes_[i].right_child 
+                      << ", feature index = " << nodes_[i].feature_index
+                      << ", threshold = " << nodes_[i].threshold
+                      << ", improvement = " << improvements_[i]
+                      << ", histogram size = (" << num_outputs_ 
+                      << ", " << max_num_classes_ << ")" << std::endl;
+        }
+    };
+
+
+    /**
+     * @brief write the tree section of the binary model format: 
+     * [num_outputs, num_features, max_num_classes, node_count, max_depth, 
+     * num_classes_list, nodes, impurities, improvements, values, proba, 
+     * category_offsets, num_category_words, categories], the categorical 
+     * splits are written since version 2
+    */
+    void serialize(BinaryWriter& writer) const {
+        writer.write<std::uint64_t>(num_outputs_);
+        writer.write<std::uint64_t>(num_features_);
+        writer.write<std::uint64_t>(max_num_classes_);
+        writer.write<std::uint64_t>(node_count_);
+        writer.write<std::uint64_t>(max_depth_);
+        writer.write_array(num_classes_list_.data(), num_outputs_);
+
+        writer.align(alignof(TreeNode));
+        for (IndexType i = 0; i < node_count_; ++i) {
+            writer.write<std::uint64_t>(nodes_[i].left_child);
+            writer.write<std::uint64_t>(nodes_[i].right_child);
+            writer.write<std::uint64_t>(nodes_[i].feature_index);
+            writer.write<double>(nodes_[i].threshold);
+            writer.write<std::int32_t>(nodes_[i].has_missing_value);
+            writer.write<std::int32_t>(nodes_[i].is_categorical);
+        }
+
+        writer.write_array(impurities_, node_count_);
+        writer.write_array(improvements_, node_count_);
+        writer.write_array(values_, node_count_ * num_outputs_ * max_num_classes_);
+        writer.write_array(proba_, node_count_ * num_outputs_ * max_num_classes_);
+        // a tree read from a version 1 file has no categorical split
+        std::vector<IndexType> no_category_offsets;
+        const IndexType* category_offsets = category_offsets_;
+        if (category_offsets == nullptr) {
+            no_category_offsets.assign(node_count_ + 1, 0);
+            category_offsets = no_category_offsets.data();
+        }
+        writer.write_array(category_offsets, node_count_ + 1);
+        writer.write<std::uint64_t>(category_offsets[node_count_]);
+        writer.write_array(categories_, category_offsets[node_count_]);
     };
 
+    /**
+     * @brief read the tree section of the binary model format in place, the 
+     * arrays of the view point into the buffer of reader, storage must keep 
+     * that buffer alive. The children and split features are checked to 
+     * be in range.
+    */
+    static TreeView deserialize(BinaryReader& reader, 
+                                const std::shared_ptr<const void>& storage) {
+        TreeView view;
+        view.num_outputs_ = reader.read<std::uint64_t>();
+        view.num_features_ = reader.read<std::uint64_t>();
+        view.max_num_classes_ = reader.read<std::uint64_t>();
+        view.node_count_ = reader.read<std::uint64_t>();
+        view.max_depth_ = reader.read<std::uint64_t>();
+        const NumClassesType* num_classes_list = reader.read_array<NumClassesType>(view.num_outputs_);
+        view.num_classes_list_.assign(num_classes_list, num_classes_list + view.num_outputs_);
+        for (NumClassesType num_classes : view.num_classes_list_) {
+            if (num_classes > view.max_num_classes_) {
+                throw std::runtime_error("The binary model has an invalid number of classes.");
+            }
+        }
+
+        if (view.node_count_ > 0 && view.max_num_classes_ > 
+                std::numeric_limits<std::uint64_t>::max() / view.node_count_ / std::max<NumOutputsType>(view.num_outputs_, 1)) {
+            throw std::runtime_error("The binary model is truncated.");
+        }
+        IndexType value_size = view.node_count_ * view.num_outputs_ * view.max_num_classes_;
+        view.nodes_ = reader.read_array<TreeNode>(view.node_count_);
+        view.impurities_ = reader.read_array<double>(view.node_count_);
+        view.improvements_ = reader.read_array<double>(view.node_count_);
+        view.values_ = reader.read_array<HistogramType>(value_size);
+        view.proba_ = reader.read_array<double>(value_size);
+        if (reader.get_version() >= 2) {
+            view.category_offsets_ = reader.read_array<IndexType>(view.node_count_ + 1);
+            IndexType num_category_words = reader.read_count(sizeof(std::uint64_t));
+            view.categories_ = reader.read_array<std::uint64_t>(num_category_words);
+            if (view.category_offsets_[0] != 0 || view.category_offsets_[view.node_count_] != num_category_words || 
+                    !std::is_sorted(view.category_offsets_, view.category_offsets_ + view.node_count_ + 1)) {
+                throw std::runtime_error("The binary model has invalid categorical splits.");
+            }
+        }
+        view.storage_ = storage;
+
+        for (IndexType i = 0; i < view.node_count_; ++i) {
+            const TreeNode& node = view.nodes_[i];
+            if (node.left_child >= view.node_count_ || node.right_child >= view.node_count_ || 
+                    ((node.left_child > 0) != (node.right_child > 0)) ||
+                    (node.left_child > 0 && node.feature_index >= view.num_features_) || 
+                    (node.is_categorical != 0 && (node.is_categorical != 1 || view.category_offsets_ == nullptr))) {
+                throw std::runtime_error("The binary model has an invalid node.");
+            }
+        }
+        return view;
+    };
+
+    /**
+     * @brief save the tree to a binary model file
+    */
+    void save(const std::string& path) const {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        if (!os) {
+            throw std::runtime_error("Failed to open '" + path + "'.");
+        }
+        BinaryWriter writer(os);
+        writer.write_header(MODEL_KIND_TREE);
+        serialize(writer);
+    };
+
+    /**
+     * @brief map a binary model file saved by save in memory and serve 
+     * predictions from the mapped pages, nothing is copied
+    */
+    static TreeView load(const std::string& path) {
+        auto mapped_file = std::make_shared<const MappedFile>(path);
+        BinaryReader reader(mapped_file->data(), mapped_file->size());
+        reader.read_header(MODEL_KIND_TREE);
+        return deserialize(reader, mapped_file);
+    };
+};
+
+/**
+ * The binary tree is represented as a number of parallel arrays. The i-th
+ * element of each array holds information about the node `i`. Node 0 is the
+ * tree's root. 
+ * 
+ * nodes_ holds the fields read when traversing the tree, i.e. the children, 
+ * the split feature, threshold and missing value direction, so that the hot 
+ * path stays in cache. The weighted class histogram of node i is stored in 
+ * the flat buffer values_[i * num_outputs * max_num_classes:...] laid out as 
+ * [o * max_num_classes + c], the impurity and improvement are kept in 
+ * arrays of their own. Children of a node are given by left_child and 
+ * right_child, a leaf has left_child = right_child = 0. The left categories 
+ * of the categorical splits are bitsets packed in one array, node i owns 
+ * the words categories_[category_offsets_[i]:category_offsets_[i + 1]], 
+ * none unless it is a categorical split.
+ * 
+ * The tree is read through a TreeView, see get_view.
+*/
+class Tree {
+private:
     NumOutputsType num_outputs_;
     NumFeaturesType num_features_;
     std::vector<NumClassesType> num_classes_list_;
@@ -64,34 +664,65 @@ private:
     NodeIndexType node_count_;
     NumClassesType max_num_classes_;
 
-    friend std::ostream& operator<<(std::ostream& os, const TreeNode& node){
-        return os << "left child = " << node.left_child 
-                  << ", right child = " << node.right_child 
-                  << ", feature index = " << node.feature_index
-                  << ", threshold = " << node.threshold
-                  << ", improvement = " << node.improvement
-                  << ", histogram size = (" << node.histogram.size() 
-                  << ", " << node.histogram[0].size() << ")";
-    }
+    // normalized class probabilities of each node, laid out as values_
+    std::vector<double> proba_;
+
+    // bitsets of the left categories of the categorical splits
+    std::vector<IndexType> category_offsets_;
+    std::vector<std::uint64_t> categories_;
 
 public:
     std::vector<TreeNode> nodes_;
+    std::vector<double> impurities_;
+    std::vector<double> improvements_;
+    std::vector<HistogramType> values_;
 
-    Tree() {};
+    Tree(): category_offsets_(1, 0) {};
     Tree(NumOutputsType num_outputs, 
          NumFeaturesType num_features, 
          std::vector<NumClassesType> num_classes_list): 
             num_outputs_(num_outputs),
             num_features_(num_features),
-            num_classes_list_(num_classes_list) {
+            num_classes_list_(num_classes_list), 
+            category_offsets_(1, 0) {
         max_depth_ = 0;
         node_count_ = 0;
         max_num_classes_ = *std::max_element(std::begin(num_classes_list), std::end(num_classes_list));
     };
+    Tree(const Tree&) = default;
+    Tree(Tree&&) = default;
+    Tree& operator=(const Tree&) = default;
+    Tree& operator=(Tree&&) = default;
     ~Tree() {
         nodes_.clear();
     };
 
+    /**
+     * @brief reserve the arrays for num_nodes nodes
+    */
+    void reserve(NodeIndexType num_nodes) {
+        nodes_.reserve(num_nodes);
+        impurities_.reserve(num_nodes);
+        improvements_.reserve(num_nodes);
+        values_.reserve(num_nodes * num_outputs_ * max_num_classes_);
+        proba_.reserve(num_nodes * num_outputs_ * max_num_classes_);
+        category_offsets_.reserve(num_nodes + 1);
+    };
+
+    void shrink_to_fit() {
+        nodes_.shrink_to_fit();
+        impurities_.shrink_to_fit();
+        improvements_.shrink_to_fit();
+        values_.shrink_to_fit();
+        proba_.shrink_to_fit();
+        category_offsets_.shrink_to_fit();
+        categories_.shrink_to_fit();
+    };
+
+    NodeIndexType get_node_count() const {
+        return node_count_;
+    };
+
     NodeIndexType add_node(bool is_left,
                          TreeDepthType depth, 
                          NodeIndexType parent_index, 
@@ -100,14 +731,43 @@ public:
                          FeatureType threshold, 
                          double impurity, 
                          double improvement, 
-                         const std::vector<std::vector<HistogramType>>& histogram) {
+                         const std::vector<std::vector<HistogramType>>& histogram, 
+                         const std::vector<std::uint64_t>& categories = std::vector<std::uint64_t>()) {
 
+        // a categorical split keeps the bitset of its left categories
         nodes_.emplace_back(0, 0, 
                             feature_index, 
+                            threshold, 
                             has_missing_value, 
-                            threshold, impurity, 
-                            improvement, 
-                            histogram);
+                            categories.empty() ? 0 : 1);
+        categories_.insert(categories_.end(), categories.begin(), categories.end());
+        category_offsets_.push_back(categories_.size());
+        impurities_.push_back(impurity);
+        improvements_.push_back(improvement);
+
+        // copy histogram into the flat value buffer, padded to max_num_classes
+        values_.resize(values_.size() + num_outputs_ * max_num_classes_, 0.0);
+        HistogramType* value = &values_[values_.size() - num_outputs_ * max_num_classes_];
+        for (IndexType o = 0; o < num_outputs_ && o < histogram.size(); ++o) {
+            std::copy_n(histogram[o].begin(), 
+                        std::min<NumClassesType>(histogram[o].size(), max_num_classes_), 
+                        value + o * max_num_classes_);
+        }
+
+        // normalize histogram into class probabilities
+        proba_.resize(proba_.size() + num_outputs_ * max_num_classes_, 0.0);
+        double* proba = &proba_[proba_.size() - num_outputs_ * max_num_classes_];
+        for (IndexType o = 0; o < num_outputs_; ++o) {
+            double norm_coeff = 0.0;
+            for (NumClassesType c = 0; c < num_classes_list_[o]; ++c) {
+                norm_coeff += value[o * max_num_classes_ + c];
+            }
+            if (norm_coeff > 0.0) {
+                for (NumClassesType c = 0; c < num_classes_list_[o]; ++c) {
+                    proba[o * max_num_classes_ + c] = value[o * max_num_classes_ + c] / norm_coeff;
+                }
+            }
+        }
         NodeIndexType node_index = node_count_++;
         
         // not root node
@@ -128,128 +788,84 @@ public:
     }
 
     /**
-     * the importances of features is computed as the total improvement 
-     * of criterion brought by the feature.
+     * @brief a view of the arrays of the tree, it is valid until the tree 
+     * is modified or destroyed unless storage keeps the tree alive.
     */
-    void compute_feature_importance(std::vector<double>& importances) {
-        importances.resize(num_features_, 0.0);
-        if (node_count_ == 0) {
-            return;
-        }
-        
-        // loop all node
-        for (IndexType i = 0; i < node_count_; ++i) {
-            // loop all non-leaf node, accumulate improvement per features
-            if (nodes_[i].left_child > 0) {
-                importances[nodes_[i].feature_index] += nodes_[i].improvement;
-            }
-        }
+    TreeView get_view(const std::shared_ptr<const void>& storage = nullptr) const {
+        TreeView view;
+        view.num_outputs_ = num_outputs_;
+        view.num_features_ = num_features_;
+        view.num_classes_list_ = num_classes_list_;
+        view.max_depth_ = max_depth_;
+        view.node_count_ = node_count_;
+        view.max_num_classes_ = max_num_classes_;
+        view.nodes_ = nodes_.data();
+        view.impurities_ = impurities_.data();
+        view.improvements_ = improvements_.data();
+        view.values_ = values_.data();
+        view.proba_ = proba_.data();
+        view.category_offsets_ = category_offsets_.data();
+        view.categories_ = categories_.data();
+        view.storage_ = storage;
+        return view;
+    };
 
-        // normalizer
-        double norm_coeff = 0.0;
-        for (IndexType i = 0; i < num_features_; ++i) {
-            norm_coeff += importances[i];
-        }
-        if (norm_coeff > 0.0) {
-            for (IndexType i = 0; i < num_features_; ++i) {
-                importances[i] = importances[i] / norm_coeff;
-            }
-        }
+    const HistogramType* get_value(NodeIndexType node_index) const {
+        return &values_[node_index * num_outputs_ * max_num_classes_];
+    };
+
+    void compute_feature_importance(std::vector<double>& importances) const {
+        get_view().compute_feature_importance(importances);
     };
 
+    template<typename FeatureType>
+    void predict_proba(const BasicDataView<FeatureType>& X, 
+                       double* proba, 
+                       ThreadPool* thread_pool = nullptr) const {
+        get_view().predict_proba(X, proba, thread_pool);
+    };
 
+    template<typename FeatureType>
+    void predict_proba(const FeatureType* X, 
+                       NumSamplesType num_samples,
+                       double* proba, 
+                       ThreadPool* thread_pool = nullptr) const {
+        get_view().predict_proba(X, num_samples, proba, thread_pool);
+    };
+
+    template<typename FeatureType>
     void predict_proba(const std::vector<FeatureType>& X, 
                        NumSamplesType num_samples,
-                       std::vector<double>& proba) {
-        proba.resize(num_samples * num_outputs_ * max_num_classes_, 0.0);
-        
-        // loop samples
-        for (IndexType i = 0; i < num_samples; ++i) {
-            std::stack<IndexInfo> node_index_stk;
-            std::stack<IndexInfo> leaf_index_stk;
-
-            // goto root node
-            node_index_stk.emplace(IndexInfo(0, 1.0));
-
-            // loop root to leaf node
-            while (!node_index_stk.empty()) {
-                IndexInfo node_index = node_index_stk.top();
-                node_index_stk.pop();
-
-                while (nodes_[node_index.index].left_child > 0 && nodes_[node_index.index].right_child > 0) {
-                    if (std::isnan(X[i * num_features_ + nodes_[node_index.index].feature_index])) {
-                        // split criterion which includes missing values
-                        // suppose has_missing_value = 0, missing value is at left node
-                        // has_missing_value = 1, missing value is at right node
-                        if (nodes_[node_index.index].has_missing_value == 0) {
-                            node_index.index = nodes_[node_index.index].left_child;
-                        }
-                        else if (nodes_[node_index.index].has_missing_value == 1) {
-                            node_index.index = nodes_[node_index.index].right_child;
-                        }
-                        else {
-                            // split criterion which does not include missing values
-                            IndexInfo node_index2 = node_index;
-                            node_index2.index = nodes_[node_index.index].right_child;
-                            HistogramType num_rights = std::accumulate(nodes_[node_index2.index].histogram[0].begin(),
-                                                                       nodes_[node_index2.index].histogram[0].end(),
-                                                                       0.0);
-
-                            node_index.index = nodes_[node_index.index].left_child;
-                            HistogramType num_lefts = std::accumulate(nodes_[node_index.index].histogram[0].begin(),
-                                                                       nodes_[node_index.index].histogram[0].end(),
-                                                                       0.0);
-                            
-                            node_index.weight *= num_lefts / (num_lefts + num_rights);
-                            node_index2.weight *= num_rights / (num_lefts + num_rights);
-                            node_index_stk.emplace(node_index2);
-                        }
-                    } 
-                    else {
-                        // no missing samples
-                        // if x[i, f_index] is smaller than the partition threshold of current node
-                        // goto left child node, else goto right child node
-                        if (X[i * num_features_ + nodes_[node_index.index].feature_index] <= nodes_[node_index.index].threshold) {
-                            node_index.index = nodes_[node_index.index].left_child;
-                        }
-                        else {
-                            node_index.index = nodes_[node_index.index].right_child;
-                        }
-                    }
-                }
-                // store leaf nodes
-                leaf_index_stk.emplace(node_index);
-            }
-            while (!leaf_index_stk.empty()) {
-                IndexInfo leaf_index = leaf_index_stk.top();
-                leaf_index_stk.pop();
-
-                for (IndexType o = 0; o < num_outputs_; ++o) {
-                    double norm_coeff = 0.0;
-                    for (NumClassesType c = 0; c < num_classes_list_[o]; ++c) {
-                        norm_coeff += nodes_[leaf_index.index].histogram[o][c];
-                        // std::cout << "norm_coeff = " << norm_coeff << std::endl;
-                    }
-                    if (norm_coeff > 0.0) {
-                        for (NumClassesType c = 0; c < num_classes_list_[o]; ++c) {
-                            proba[i * num_outputs_ * max_num_classes_ + o * max_num_classes_ + c] += leaf_index.weight * 
-                                nodes_[leaf_index.index].histogram[o][c] / norm_coeff;
-                        }
-                    }
-                }
-            }
-        }
+                       std::vector<double>& proba, 
+                       ThreadPool* thread_pool = nullptr) const {
+        get_view().predict_proba(X, num_samples, proba, thread_pool);
     };
 
-    void print_node_info() {
-        for (IndexType i = 0; i < nodes_.size(); i++) {
-            std::cout << nodes_[i] << std::endl;
-        }
+    template<typename FeatureType, typename ClassType>
+    void predict(const BasicDataView<FeatureType>& X, 
+                 ClassType* y, 
+                 ThreadPool* thread_pool = nullptr) const {
+        get_view().predict(X, y, thread_pool);
+    };
+
+    template<typename FeatureType, typename ClassType>
+    void predict(const FeatureType* X, 
+                 NumSamplesType num_samples,
+                 ClassType* y, 
+                 ThreadPool* thread_pool = nullptr) const {
+        get_view().predict(X, num_samples, y, thread_pool);
+    };
+
+    void print_node_info() const {
+        get_view().print_node_info();
     };
 
+    void save(const std::string& path) const {
+        get_view().save(path);
+    };
 
 };
 
 } // namespace decision-tree
 
-#endif // CORE_TREE_HPP_
\ No newline at end of file
+#endif // CORE_TREE_HPP_
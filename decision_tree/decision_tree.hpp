@@ -1 +1,3 @@
-#include "algorithm/decision_tree_classifier.hpp"
\ No newline at end of file
+#include "algorithm/decision_tree_classifier.hpp"
+#include "algorithm/gradient_boosting_classifier.hpp"
+#include "algorithm/random_forest_classifier.hpp"
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef UTILITY_ALIGNED_ALLOCATOR_HPP_
+#define UTILITY_ALIGNED_ALLOCATOR_HPP_
+
+#include "common/prereqs.hpp"
+
+#include <stdlib.h>
+
+namespace decisiontree {
+
+/**
+ * @brief allocator of std::vector which aligns the buffer to Alignment bytes, 
+ * by default a cache line, so that the buffer never shares its first cache 
+ * line with another allocation and aligned vector loads can be used on it.
+*/
+template<typename T, std::size_t Alignment = CACHE_LINE_SIZE>
+class AlignedAllocator {
+public:
+    static_assert(Alignment >= alignof(T) && Alignment % sizeof(void*) == 0, 
+                  "Alignment must be a multiple of the pointer size and of the alignment of T");
+
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() {};
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {};
+
+    T* allocate(std::size_t size) {
+        if (size == 0) {
+            return nullptr;
+        }
+        if (size > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        void* ptr = nullptr;
+        if (::posix_memalign(&ptr, Alignment, size * sizeof(T)) != 0) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    };
+
+    void deallocate(T* ptr, std::size_t) {
+        ::free(ptr);
+    };
+};
+
+template<typename T, typename U, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) {
+    return true;
+}
+
+template<typename T, typename U, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) {
+    return false;
+}
+
+} // namespace
+
+#endif // UTILITY_ALIGNED_ALLOCATOR_HPP_
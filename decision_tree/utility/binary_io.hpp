@@ -0,0 +1,233 @@
+#ifndef UTILITY_BINARY_IO_HPP_
+#define UTILITY_BINARY_IO_HPP_
+
+#include "common/prereqs.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "the binary model format is little-endian, big-endian hosts are not supported"
+#endif
+
+namespace decisiontree {
+
+/**
+ * The binary model format, all integers are little-endian unsigned 64-bit
+ * and all floating point values are IEEE 754 doubles. A file starts with
+ * the header [magic, version, kind], followed by the sections of the kind.
+ * Arrays are aligned to their element size from the start of the file, so
+ * that a file mapped in memory can be read in place.
+*/
+const char MODEL_FORMAT_MAGIC[8] = {'D', 'T', 'R', 'E', 'E', 'B', 'I', 'N'};
+const std::uint32_t MODEL_FORMAT_VERSION = 2;
+
+// the oldest version which can still be read, version 1 has no categorical splits
+const std::uint32_t MIN_MODEL_FORMAT_VERSION = 1;
+
+// kinds of model stored in a file, a labeled dataset uses the same format
+const std::uint32_t MODEL_KIND_TREE = 0;
+const std::uint32_t MODEL_KIND_CLASSIFIER = 1;
+const std::uint32_t MODEL_KIND_DATASET = 2;
+
+static_assert(sizeof(unsigned long) == sizeof(std::uint64_t),
+              "the binary model format requires 64-bit unsigned long");
+static_assert(sizeof(double) == sizeof(std::uint64_t),
+              "the binary model format requires 64-bit double");
+
+/**
+ * @brief write values of the binary model format to a stream, keeping
+ * track of the offset to align arrays.
+*/
+class BinaryWriter {
+private:
+    std::ostream& os_;
+    std::size_t offset_;
+
+    void write_bytes(const void* data, std::size_t size) {
+        os_.write(static_cast<const char*>(data), size);
+        if (!os_) {
+            throw std::runtime_error("Failed to write the binary model.");
+        }
+        offset_ += size;
+    };
+
+public:
+    explicit BinaryWriter(std::ostream& os): os_(os), offset_(0) {};
+    ~BinaryWriter() {};
+
+    void align(std::size_t alignment) {
+        const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        while (offset_ % alignment != 0) {
+            write_bytes(padding, std::min<std::size_t>(alignment - offset_ % alignment, sizeof(padding)));
+        }
+    };
+
+    template<typename T>
+    void write(const T& value) {
+        write_bytes(&value, sizeof(T));
+    };
+
+    /**
+     * @brief write size elements of data, aligned to the element size
+    */
+    template<typename T>
+    void write_array(const T* data, std::size_t size) {
+        align(alignof(T));
+        write_bytes(data, size * sizeof(T));
+    };
+
+    void write_string(const std::string& value) {
+        write<std::uint64_t>(value.size());
+        write_bytes(value.data(), value.size());
+    };
+
+    void write_header(std::uint32_t kind) {
+        write_bytes(MODEL_FORMAT_MAGIC, sizeof(MODEL_FORMAT_MAGIC));
+        write<std::uint32_t>(MODEL_FORMAT_VERSION);
+        write<std::uint32_t>(kind);
+    };
+};
+
+/**
+ * @brief read values of the binary model format from a buffer in place,
+ * every read is bounds checked and throws std::runtime_error on a
+ * truncated or malformed buffer.
+*/
+class BinaryReader {
+private:
+    const char* data_;
+    std::size_t size_;
+    std::size_t offset_;
+    std::uint32_t version_;
+
+    const char* read_bytes(std::size_t size) {
+        if (size > size_ - offset_) {
+            throw std::runtime_error("The binary model is truncated.");
+        }
+        const char* bytes = data_ + offset_;
+        offset_ += size;
+        return bytes;
+    };
+
+public:
+    BinaryReader(const char* data, std::size_t size): data_(data),
+        size_(size),
+        offset_(0),
+        version_(MODEL_FORMAT_VERSION) {};
+    ~BinaryReader() {};
+
+    void align(std::size_t alignment) {
+        read_bytes((alignment - offset_ % alignment) % alignment);
+    };
+
+    template<typename T>
+    T read() {
+        T value;
+        std::memcpy(&value, read_bytes(sizeof(T)), sizeof(T));
+        return value;
+    };
+
+    /**
+     * @brief pointer to size elements in the buffer, no copy is made
+    */
+    template<typename T>
+    const T* read_array(std::size_t size) {
+        align(alignof(T));
+        if (size > (size_ - offset_) / sizeof(T)) {
+            throw std::runtime_error("The binary model is truncated.");
+        }
+        return reinterpret_cast<const T*>(read_bytes(size * sizeof(T)));
+    };
+
+    /**
+     * @brief read the number of elements of a sequence which follows, each 
+     * element takes at least min_element_size bytes in the buffer
+    */
+    std::uint64_t read_count(std::size_t min_element_size) {
+        std::uint64_t count = read<std::uint64_t>();
+        if (count > (size_ - offset_) / min_element_size) {
+            throw std::runtime_error("The binary model is truncated.");
+        }
+        return count;
+    };
+
+    std::string read_string() {
+        std::uint64_t size = read<std::uint64_t>();
+        if (size > size_ - offset_) {
+            throw std::runtime_error("The binary model is truncated.");
+        }
+        return std::string(read_bytes(size), size);
+    };
+
+    /**
+     * @brief version of the file given by read_header, the sections added 
+     * by later versions are only read from files which have them
+    */
+    std::uint32_t get_version() const {
+        return version_;
+    };
+
+    void read_header(std::uint32_t kind) {
+        if (std::memcmp(read_bytes(sizeof(MODEL_FORMAT_MAGIC)), MODEL_FORMAT_MAGIC, sizeof(MODEL_FORMAT_MAGIC)) != 0) {
+            throw std::runtime_error("Not a binary model file.");
+        }
+        version_ = read<std::uint32_t>();
+        if (version_ < MIN_MODEL_FORMAT_VERSION || version_ > MODEL_FORMAT_VERSION) {
+            throw std::runtime_error("Unsupported binary model version.");
+        }
+        if (read<std::uint32_t>() != kind) {
+            throw std::runtime_error("The binary model file holds another kind of model.");
+        }
+    };
+};
+
+/**
+ * @brief a read-only memory mapping of a whole file, pages are shared
+ * with the page cache and with other processes mapping the same file.
+*/
+class MappedFile {
+private:
+    void* data_;
+    std::size_t size_;
+
+public:
+    explicit MappedFile(const std::string& path): data_(nullptr), size_(0) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open '" + path + "'.");
+        }
+        struct stat file_stat;
+        if (::fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to read the size of '" + path + "'.");
+        }
+        size_ = static_cast<std::size_t>(file_stat.st_size);
+        data_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data_ == MAP_FAILED) {
+            throw std::runtime_error("Failed to map '" + path + "'.");
+        }
+    };
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        ::munmap(data_, size_);
+    };
+
+    const char* data() const {
+        return static_cast<const char*>(data_);
+    };
+
+    std::size_t size() const {
+        return size_;
+    };
+};
+
+} // namespace
+
+#endif // UTILITY_BINARY_IO_HPP_
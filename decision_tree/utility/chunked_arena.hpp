@@ -0,0 +1,94 @@
+#ifndef UTILITY_CHUNKED_ARENA_HPP_
+#define UTILITY_CHUNKED_ARENA_HPP_
+
+#include "common/prereqs.hpp"
+
+namespace decisiontree {
+
+/**
+ * @brief an append-only array stored in chunks, an element never moves
+ * once added, so growing the arena never copies the existing elements
+ * and references to them stay valid. The first chunk holds
+ * initial_capacity elements and each next chunk doubles the capacity,
+ * the chunks never hold more than max_size elements in total.
+*/
+template<typename T>
+class ChunkedArena {
+private:
+    std::size_t initial_capacity_;
+    std::size_t max_size_;
+    std::size_t size_;
+
+    // chunks_[k] holds the elements from chunk_begins_[k],
+    // each chunk is reserved once and never reallocated
+    std::vector<std::vector<T>> chunks_;
+    std::vector<std::size_t> chunk_begins_;
+
+    /**
+     * @brief index of the chunk holding element i
+    */
+    std::size_t find_chunk(std::size_t i) const {
+        return std::upper_bound(chunk_begins_.begin(), chunk_begins_.end(), i) - chunk_begins_.begin() - 1;
+    };
+
+public:
+    explicit ChunkedArena(std::size_t initial_capacity,
+                          std::size_t max_size = std::numeric_limits<std::size_t>::max()):
+        initial_capacity_(std::max<std::size_t>(initial_capacity, 1)),
+        max_size_(max_size),
+        size_(0) {};
+
+    ChunkedArena(const ChunkedArena&) = delete;
+    ChunkedArena& operator=(const ChunkedArena&) = delete;
+    ~ChunkedArena() {};
+
+    std::size_t size() const {
+        return size_;
+    };
+
+    bool empty() const {
+        return size_ == 0;
+    };
+
+    /**
+     * @brief construct an element at the end, a new chunk is
+     * allocated when the last one is full
+    */
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (chunks_.empty() || chunks_.back().size() == chunks_.back().capacity()) {
+            if (size_ >= max_size_) {
+                throw std::length_error("The chunked arena is full.");
+            }
+            std::size_t capacity = chunks_.empty() ? initial_capacity_ : 2 * chunks_.back().capacity();
+            chunks_.emplace_back();
+            chunks_.back().reserve(std::min(capacity, max_size_ - size_));
+            chunk_begins_.push_back(size_);
+        }
+        chunks_.back().emplace_back(std::forward<Args>(args)...);
+        ++size_;
+        return chunks_.back().back();
+    };
+
+    T& operator[](std::size_t i) {
+        std::size_t k = find_chunk(i);
+        return chunks_[k][i - chunk_begins_[k]];
+    };
+
+    const T& operator[](std::size_t i) const {
+        std::size_t k = find_chunk(i);
+        return chunks_[k][i - chunk_begins_[k]];
+    };
+
+    T& back() {
+        return chunks_.back().back();
+    };
+
+    const T& back() const {
+        return chunks_.back().back();
+    };
+};
+
+} // namespace
+
+#endif // UTILITY_CHUNKED_ARENA_HPP_
@@ -3,10 +3,14 @@
 
 #include "common/prereqs.hpp"
 
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
 namespace decisiontree {
 
 template<typename FeatureType, typename ClassType>
-ClassType argmax(FeatureType* x, unsigned long size) {
+ClassType argmax(const FeatureType* x, unsigned long size) {
     ClassType max_index = 0;
     FeatureType max_value = x[max_index];
 
@@ -19,5 +23,211 @@ ClassType argmax(FeatureType* x, unsigned long size) {
     return max_index;
 };
 
+/**
+ * The reductions below are vectorized with AVX-512 or AVX when the compiler 
+ * targets them, and fall back to scalar loops otherwise. DoubleVector holds 
+ * DOUBLE_VECTOR_SIZE doubles, loads are unaligned so that a kernel can start 
+ * at any row of a histogram slab.
+*/
+#if defined(__AVX512F__)
+using DoubleVector = __m512d;
+const unsigned long DOUBLE_VECTOR_SIZE = 8;
+
+inline DoubleVector vector_zero() { return _mm512_setzero_pd(); }
+inline DoubleVector vector_set(double x) { return _mm512_set1_pd(x); }
+inline DoubleVector vector_load(const double* x) { return _mm512_loadu_pd(x); }
+inline DoubleVector vector_add(DoubleVector x, DoubleVector y) { return _mm512_add_pd(x, y); }
+inline DoubleVector vector_sub(DoubleVector x, DoubleVector y) { return _mm512_sub_pd(x, y); }
+inline DoubleVector vector_mul(DoubleVector x, DoubleVector y) { return _mm512_mul_pd(x, y); }
+inline DoubleVector vector_div(DoubleVector x, DoubleVector y) { return _mm512_div_pd(x, y); }
+inline DoubleVector vector_fmadd(DoubleVector x, DoubleVector y, DoubleVector z) { return _mm512_fmadd_pd(x, y, z); }
+inline double vector_reduce_add(DoubleVector x) { return _mm512_reduce_add_pd(x); }
+
+// keep x where x > 0, and 0 elsewhere
+inline DoubleVector vector_where_positive(DoubleVector x, DoubleVector value) {
+    return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_GT_OQ), value);
+}
+
+// split x into mantissa in [1, 2) and exponent
+inline void vector_frexp(DoubleVector x, DoubleVector& mantissa, DoubleVector& exponent) {
+    mantissa = _mm512_getmant_pd(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_src);
+    exponent = _mm512_getexp_pd(x);
+}
+
+// mantissa / 2 and exponent + 1 where mantissa > threshold
+inline void vector_normalize_mantissa(DoubleVector& mantissa, DoubleVector& exponent, double threshold) {
+    __mmask8 mask = _mm512_cmp_pd_mask(mantissa, _mm512_set1_pd(threshold), _CMP_GT_OQ);
+    mantissa = _mm512_mask_mul_pd(mantissa, mask, mantissa, _mm512_set1_pd(0.5));
+    exponent = _mm512_mask_add_pd(exponent, mask, exponent, _mm512_set1_pd(1.0));
+}
+
+#elif defined(__AVX__)
+using DoubleVector = __m256d;
+const unsigned long DOUBLE_VECTOR_SIZE = 4;
+
+inline DoubleVector vector_zero() { return _mm256_setzero_pd(); }
+inline DoubleVector vector_set(double x) { return _mm256_set1_pd(x); }
+inline DoubleVector vector_load(const double* x) { return _mm256_loadu_pd(x); }
+inline DoubleVector vector_add(DoubleVector x, DoubleVector y) { return _mm256_add_pd(x, y); }
+inline DoubleVector vector_sub(DoubleVector x, DoubleVector y) { return _mm256_sub_pd(x, y); }
+inline DoubleVector vector_mul(DoubleVector x, DoubleVector y) { return _mm256_mul_pd(x, y); }
+inline DoubleVector vector_div(DoubleVector x, DoubleVector y) { return _mm256_div_pd(x, y); }
+#if defined(__FMA__)
+inline DoubleVector vector_fmadd(DoubleVector x, DoubleVector y, DoubleVector z) { return _mm256_fmadd_pd(x, y, z); }
+#else
+inline DoubleVector vector_fmadd(DoubleVector x, DoubleVector y, DoubleVector z) { return _mm256_add_pd(_mm256_mul_pd(x, y), z); }
+#endif
+
+inline double vector_reduce_add(DoubleVector x) {
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+// keep x where x > 0, and 0 elsewhere
+inline DoubleVector vector_where_positive(DoubleVector x, DoubleVector value) {
+    return _mm256_and_pd(_mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GT_OQ), value);
+}
+
+// split x into mantissa in [1, 2) and exponent, x must be positive and normal, 
+// the biased exponent is shifted out with SSE2 since AVX has no 256-bit 
+// integer shift, and turned into a double by adding it to the mantissa of 2^52
+inline void vector_frexp(DoubleVector x, DoubleVector& mantissa, DoubleVector& exponent) {
+    const __m256d mantissa_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL));
+    const __m256d one = _mm256_set1_pd(1.0);
+    mantissa = _mm256_or_pd(_mm256_and_pd(x, mantissa_mask), one);
+
+    const __m128i magic = _mm_set1_epi64x(0x4330000000000000LL);
+    __m256i bits = _mm256_castpd_si256(x);
+    __m128i low = _mm_or_si128(_mm_srli_epi64(_mm256_castsi256_si128(bits), 52), magic);
+    __m128i high = _mm_or_si128(_mm_srli_epi64(_mm256_extractf128_si256(bits, 1), 52), magic);
+    __m256d biased = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_castsi128_pd(low)), 
+                                          _mm_castsi128_pd(high), 1);
+    exponent = _mm256_sub_pd(biased, _mm256_set1_pd(4503599627370496.0 + 1023.0));
+}
+
+// mantissa / 2 and exponent + 1 where mantissa > threshold
+inline void vector_normalize_mantissa(DoubleVector& mantissa, DoubleVector& exponent, double threshold) {
+    __m256d mask = _mm256_cmp_pd(mantissa, _mm256_set1_pd(threshold), _CMP_GT_OQ);
+    mantissa = _mm256_blendv_pd(mantissa, _mm256_mul_pd(mantissa, _mm256_set1_pd(0.5)), mask);
+    exponent = _mm256_add_pd(exponent, _mm256_and_pd(mask, _mm256_set1_pd(1.0)));
+}
+#endif
+
+#if defined(__AVX512F__) || defined(__AVX__)
+/**
+ * @brief log2 of each positive normal element of x, the mantissa m is 
+ * reduced to [sqrt(1/2), sqrt(2)) and ln(m) = 2 atanh(s), s = (m - 1) / (m + 1), 
+ * is evaluated with the odd series of atanh up to s^21. With |s| < 0.172 the 
+ * error is within a few ulp of std::log2.
+*/
+inline DoubleVector vector_log2(DoubleVector x) {
+    DoubleVector mantissa, exponent;
+    vector_frexp(x, mantissa, exponent);
+    vector_normalize_mantissa(mantissa, exponent, 1.4142135623730951);
+
+    const DoubleVector one = vector_set(1.0);
+    DoubleVector s = vector_div(vector_sub(mantissa, one), vector_add(mantissa, one));
+    DoubleVector z = vector_mul(s, s);
+    DoubleVector poly = vector_set(2.0 / 21.0);
+    poly = vector_fmadd(poly, z, vector_set(2.0 / 19.0));
+    poly = vector_fmadd(poly, z, vector_set(2.0 / 17.0));
+    poly = vector_fmadd(poly, z, vector_set(2.0 / 15.0));
+    poly = vector_fmadd(poly, z, vector_set(2.0 / 13.0));
+    poly = vector_fmadd(poly, z, vector_set(2.0 / 11.0));
+    poly = vector_fmadd(poly, z, vector_set(2.0 / 9.0));
+    poly = vector_fmadd(poly, z, vector_set(2.0 / 7.0));
+    poly = vector_fmadd(poly, z, vector_set(2.0 / 5.0));
+    poly = vector_fmadd(poly, z, vector_set(2.0 / 3.0));
+    poly = vector_fmadd(poly, z, vector_set(2.0));
+    // log2(x) = exponent + ln(m) / ln(2)
+    return vector_fmadd(vector_mul(poly, s), vector_set(1.4426950408889634), exponent);
+}
+#endif
+
+/**
+ * @brief sum and sum of squares of x[0:size], and of y[0:size], 
+ * both arrays are reduced in the same pass
+*/
+inline void sum_and_square_sum(const double* x, 
+                               const double* y, 
+                               unsigned long size, 
+                               double& x_sum, 
+                               double& x_square_sum, 
+                               double& y_sum, 
+                               double& y_square_sum) {
+    x_sum = 0.0, x_square_sum = 0.0, y_sum = 0.0, y_square_sum = 0.0;
+    unsigned long i = 0;
+#if defined(__AVX512F__) || defined(__AVX__)
+    if (size >= DOUBLE_VECTOR_SIZE) {
+        DoubleVector x_sum_vec = vector_zero(), x_square_sum_vec = vector_zero();
+        DoubleVector y_sum_vec = vector_zero(), y_square_sum_vec = vector_zero();
+        for (; i + DOUBLE_VECTOR_SIZE <= size; i += DOUBLE_VECTOR_SIZE) {
+            DoubleVector x_vec = vector_load(x + i);
+            DoubleVector y_vec = vector_load(y + i);
+            x_sum_vec = vector_add(x_sum_vec, x_vec);
+            x_square_sum_vec = vector_fmadd(x_vec, x_vec, x_square_sum_vec);
+            y_sum_vec = vector_add(y_sum_vec, y_vec);
+            y_square_sum_vec = vector_fmadd(y_vec, y_vec, y_square_sum_vec);
+        }
+        x_sum = vector_reduce_add(x_sum_vec);
+        x_square_sum = vector_reduce_add(x_square_sum_vec);
+        y_sum = vector_reduce_add(y_sum_vec);
+        y_square_sum = vector_reduce_add(y_square_sum_vec);
+    }
+#endif
+    for (; i < size; ++i) {
+        x_sum += x[i];
+        x_square_sum += x[i] * x[i];
+        y_sum += y[i];
+        y_square_sum += y[i] * y[i];
+    }
+};
+
+/**
+ * @brief sum of x[0:size] and sum of x * log2(x) over the positive 
+ * elements of x, and the same for y, both arrays are reduced in the same pass
+*/
+inline void sum_and_entropy_sum(const double* x, 
+                                const double* y, 
+                                unsigned long size, 
+                                double& x_sum, 
+                                double& x_entropy_sum, 
+                                double& y_sum, 
+                                double& y_entropy_sum) {
+    x_sum = 0.0, x_entropy_sum = 0.0, y_sum = 0.0, y_entropy_sum = 0.0;
+    unsigned long i = 0;
+#if defined(__AVX512F__) || defined(__AVX__)
+    if (size >= DOUBLE_VECTOR_SIZE) {
+        // non positive elements give nan or inf in log2, they are masked out
+        DoubleVector x_sum_vec = vector_zero(), x_entropy_sum_vec = vector_zero();
+        DoubleVector y_sum_vec = vector_zero(), y_entropy_sum_vec = vector_zero();
+        for (; i + DOUBLE_VECTOR_SIZE <= size; i += DOUBLE_VECTOR_SIZE) {
+            DoubleVector x_vec = vector_load(x + i);
+            DoubleVector y_vec = vector_load(y + i);
+            x_sum_vec = vector_add(x_sum_vec, x_vec);
+            x_entropy_sum_vec = vector_add(x_entropy_sum_vec, 
+                vector_where_positive(x_vec, vector_mul(x_vec, vector_log2(x_vec))));
+            y_sum_vec = vector_add(y_sum_vec, y_vec);
+            y_entropy_sum_vec = vector_add(y_entropy_sum_vec, 
+                vector_where_positive(y_vec, vector_mul(y_vec, vector_log2(y_vec))));
+        }
+        x_sum = vector_reduce_add(x_sum_vec);
+        x_entropy_sum = vector_reduce_add(x_entropy_sum_vec);
+        y_sum = vector_reduce_add(y_sum_vec);
+        y_entropy_sum = vector_reduce_add(y_entropy_sum_vec);
+    }
+#endif
+    for (; i < size; ++i) {
+        x_sum += x[i];
+        if (x[i] > 0.0) {
+            x_entropy_sum += x[i] * std::log2(x[i]);
+        }
+        y_sum += y[i];
+        if (y[i] > 0.0) {
+            y_entropy_sum += y[i] * std::log2(y[i]);
+        }
+    }
+};
+
 }
 #endif // UTILITY_MATH_HPP_
\ No newline at end of file
@@ -0,0 +1,171 @@
+#ifndef UTILITY_PROFILER_HPP_
+#define UTILITY_PROFILER_HPP_
+
+#include "common/prereqs.hpp"
+
+#include <chrono>
+
+/**
+ * The training profile is recorded only if DECISIONTREE_PROFILE is defined,
+ * e.g. with -DDECISIONTREE_PROFILE or the ENABLE_PROFILE CMake option, all
+ * translation units of a program must agree on it. Otherwise the profiling
+ * statements are compiled out and the profile of a fit stays empty.
+*/
+#if defined(DECISIONTREE_PROFILE)
+#define DECISIONTREE_PROFILE_TIME(time) decisiontree::ProfileTimer profile_timer(time)
+#define DECISIONTREE_PROFILE_RECORD(statement) statement
+#define DECISIONTREE_PROFILE_SAMPLE(index) decisiontree::SampledPhaseTimer profile_phase_timer(index)
+#define DECISIONTREE_PROFILE_LAP(time) profile_phase_timer.lap(time)
+#else
+// the arguments are only named in an unevaluated sizeof, nothing runs
+#define DECISIONTREE_PROFILE_TIME(time) ((void)sizeof(time))
+#define DECISIONTREE_PROFILE_RECORD(statement) ((void)sizeof((statement), 0))
+#define DECISIONTREE_PROFILE_SAMPLE(index) ((void)sizeof(index))
+#define DECISIONTREE_PROFILE_LAP(time) ((void)sizeof(time))
+#endif
+
+namespace decisiontree {
+
+#if defined(DECISIONTREE_PROFILE)
+const bool PROFILE_ENABLED = true;
+#else
+const bool PROFILE_ENABLED = false;
+#endif
+
+// one candidate threshold in PROFILE_SAMPLING_PERIOD is timed by phase
+const NumSamplesType PROFILE_SAMPLING_PERIOD = 64;
+
+/**
+ * @brief where the time of a fit goes and how much work the split search
+ * does. Times are in seconds, the times of the split search are summed
+ * over the threads searching in parallel, so they may add up to more
+ * than build_time.
+*/
+struct TrainingProfile {
+    // wall clock time of presorting or binning the features and of building the tree
+    double init_features_time;
+    double build_time;
+
+    // split search: copy of the feature values of a node, shifting the samples
+    // with missing values, sorting, updating the histograms of the samples with
+    // missing values, of the bins, of the categories and of the children at each
+    // candidate threshold, evaluating the impurities and the improvements, and
+    // reordering the samples of the node for the split found. The two phases of
+    // the candidate thresholds are timed on one threshold in PROFILE_SAMPLING_PERIOD
+    // and scaled up, timing each threshold would cost more than evaluating it.
+    double gather_time;
+    double missing_partition_time;
+    double sort_time;
+    double histogram_update_time;
+    double impurity_time;
+    double rearrange_time;
+
+    // num_nodes_per_depth[d] is the number of nodes of the tree at depth d
+    std::vector<NumNodesType> num_nodes_per_depth;
+
+    // samples read by the split search summed over the features searched,
+    // and candidate thresholds whose impurity is evaluated
+    NumSamplesType num_samples_touched;
+    NumSamplesType num_thresholds_evaluated;
+
+    TrainingProfile() {
+        clear();
+    };
+    ~TrainingProfile() {};
+
+    void clear() {
+        init_features_time = 0.0;
+        build_time = 0.0;
+        gather_time = 0.0;
+        missing_partition_time = 0.0;
+        sort_time = 0.0;
+        histogram_update_time = 0.0;
+        impurity_time = 0.0;
+        rearrange_time = 0.0;
+        num_nodes_per_depth.clear();
+        num_samples_touched = 0;
+        num_thresholds_evaluated = 0;
+    };
+
+    void add_node(TreeDepthType depth) {
+        if (num_nodes_per_depth.size() <= depth) {
+            num_nodes_per_depth.resize(depth + 1, 0);
+        }
+        num_nodes_per_depth[depth]++;
+    };
+
+    /**
+     * @brief add the times and counters of another profile, e.g. the
+     * profile of a thread splitting nodes of the same tree
+    */
+    void merge(const TrainingProfile& other) {
+        init_features_time += other.init_features_time;
+        build_time += other.build_time;
+        gather_time += other.gather_time;
+        missing_partition_time += other.missing_partition_time;
+        sort_time += other.sort_time;
+        histogram_update_time += other.histogram_update_time;
+        impurity_time += other.impurity_time;
+        rearrange_time += other.rearrange_time;
+        if (num_nodes_per_depth.size() < other.num_nodes_per_depth.size()) {
+            num_nodes_per_depth.resize(other.num_nodes_per_depth.size(), 0);
+        }
+        for (IndexType d = 0; d < other.num_nodes_per_depth.size(); ++d) {
+            num_nodes_per_depth[d] += other.num_nodes_per_depth[d];
+        }
+        num_samples_touched += other.num_samples_touched;
+        num_thresholds_evaluated += other.num_thresholds_evaluated;
+    };
+};
+
+/**
+ * @brief add the time from its construction to its destruction to time
+*/
+class ProfileTimer {
+private:
+    double& time_;
+    std::chrono::steady_clock::time_point start_;
+
+public:
+    explicit ProfileTimer(double& time): time_(time),
+        start_(std::chrono::steady_clock::now()) {};
+    ProfileTimer(const ProfileTimer&) = delete;
+    ProfileTimer& operator=(const ProfileTimer&) = delete;
+    ~ProfileTimer() {
+        time_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    };
+};
+
+/**
+ * @brief time the phases of a candidate threshold of index index if it is 
+ * one in PROFILE_SAMPLING_PERIOD, each lap adds the time since the previous 
+ * lap, or since the construction, scaled by the period. The other thresholds 
+ * read no clock and their phases are estimated by the sampled ones.
+*/
+class SampledPhaseTimer {
+private:
+    bool is_sampled_;
+    std::chrono::steady_clock::time_point start_;
+
+public:
+    explicit SampledPhaseTimer(NumSamplesType index): is_sampled_(index % PROFILE_SAMPLING_PERIOD == 0) {
+        if (is_sampled_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    };
+    SampledPhaseTimer(const SampledPhaseTimer&) = delete;
+    SampledPhaseTimer& operator=(const SampledPhaseTimer&) = delete;
+    ~SampledPhaseTimer() {};
+
+    void lap(double& time) {
+        if (is_sampled_) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            time += PROFILE_SAMPLING_PERIOD * std::chrono::duration<double>(now - start_).count();
+            start_ = now;
+        }
+    };
+};
+
+} // namespace
+
+#endif // UTILITY_PROFILER_HPP_
@@ -47,6 +47,34 @@ public:
         std::uniform_int_distribution<long> dist(low, high - 1);
         return dist(engine_);          
     };
+
+    /**
+     * Provide a double random number from a normal distribution.
+     * @param mean mean of the distribution.
+     * @param stddev standard deviation of the distribution.
+     * @return random number.
+    */
+    double normal(double mean,
+                  double stddev) {
+        std::normal_distribution<double> dist(mean, stddev);
+        return dist(engine_);
+    };
+
+    /**
+     * Derive the seed of the branch of a seed with a splitmix64 step, seeds 
+     * derived along different paths of branches are uncorrelated, and a seed 
+     * only depends on its path, not on the order the seeds are derived in.
+     * @param seed seed of the parent.
+     * @param branch index of the branch.
+     * @return seed of the branch.
+    */
+    static std::uint64_t derive_seed(std::uint64_t seed,
+                                     std::uint64_t branch) {
+        std::uint64_t z = seed + (branch + 1) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    };
 };
 
 } //namespace
@@ -5,52 +5,240 @@
 
 namespace decisiontree {
 
+// ranges up to this size are sorted by insertion sort
+const std::size_t INSERTION_SORT_MAX_SIZE = 32;
+
+// ranges from this size are sorted by radix sort, ranges in between by
+// comparison sort, for which clearing the radix histograms costs too much
+const std::size_t RADIX_SORT_MIN_SIZE = 256;
+
+/**
+ * @brief map a floating point key to an unsigned integer of the same size
+ * whose order is the order of the keys, the sign bit is flipped for
+ * positive keys and all the bits are flipped for negative keys. NaN is
+ * not ordered, -0.0 is placed before 0.0.
+*/
+template<typename KeyType>
+struct RadixKey;
+
+template<>
+struct RadixKey<double> {
+    using BitsType = std::uint64_t;
+
+    static BitsType encode(double key) {
+        BitsType bits;
+        std::memcpy(&bits, &key, sizeof(key));
+        return (bits >> 63) ? ~bits : (bits | (BitsType(1) << 63));
+    };
+};
+
+template<>
+struct RadixKey<float> {
+    using BitsType = std::uint32_t;
+
+    static BitsType encode(float key) {
+        BitsType bits;
+        std::memcpy(&bits, &key, sizeof(key));
+        return (bits >> 31) ? ~bits : (bits | (BitsType(1) << 31));
+    };
+};
+
+/**
+ * @brief scratch memory of sort_by_key, it only grows, so a buffer reused
+ * across calls stops allocating once it has seen the largest range.
+*/
+template<typename KeyType, typename IndexType>
+struct SortBuffer {
+    using BitsType = typename RadixKey<KeyType>::BitsType;
+
+    std::vector<BitsType> bits;
+    std::vector<BitsType> swap_bits;
+    std::vector<IndexType> swap_indices;
+    std::vector<std::pair<KeyType, IndexType>> pairs;
+
+    void reserve(std::size_t size) {
+        if (bits.size() < size) {
+            bits.resize(size);
+            swap_bits.resize(size);
+            swap_indices.resize(size);
+        }
+        pairs.reserve(std::min(size, RADIX_SORT_MIN_SIZE));
+    };
+};
+
+/**
+ * @brief sort keys[0:size] in ascending order and apply the same
+ * permutation to indices[0:size]. Tiny ranges use insertion sort, large
+ * ranges use a stable LSD radix sort on the bits of the keys with one
+ * byte per pass, the passes in which all the keys share the same byte
+ * are skipped. Keys must not be NaN.
+ *
+ * @param keys floating point keys, float or double
+ * @param indices unsigned integer payload
+ * @param buffer scratch memory reused across calls
+*/
+template<typename KeyType, typename IndexType>
+void sort_by_key(KeyType* keys,
+                 IndexType* indices,
+                 std::size_t size,
+                 SortBuffer<KeyType, IndexType>& buffer) {
+    static_assert(std::is_floating_point<KeyType>::value, "sort_by_key requires floating point keys");
+    static_assert(std::is_integral<IndexType>::value && std::is_unsigned<IndexType>::value,
+                  "sort_by_key requires unsigned integer indices");
+    using BitsType = typename RadixKey<KeyType>::BitsType;
+    const std::size_t num_passes = sizeof(BitsType);
+    const std::size_t radix = 256;
+
+    if (size <= INSERTION_SORT_MAX_SIZE) {
+        for (std::size_t i = 1; i < size; ++i) {
+            KeyType key = keys[i];
+            IndexType index = indices[i];
+            std::size_t j = i;
+            while (j > 0 && keys[j - 1] > key) {
+                keys[j] = keys[j - 1];
+                indices[j] = indices[j - 1];
+                --j;
+            }
+            keys[j] = key;
+            indices[j] = index;
+        }
+        return ;
+    }
+
+    if (size < RADIX_SORT_MIN_SIZE) {
+        buffer.pairs.resize(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            buffer.pairs[i] = std::make_pair(keys[i], indices[i]);
+        }
+        std::sort(buffer.pairs.begin(), buffer.pairs.end(),
+                  [](const std::pair<KeyType, IndexType>& left,
+                     const std::pair<KeyType, IndexType>& right) -> bool {
+                        return left.first < right.first;
+                });
+        for (std::size_t i = 0; i < size; ++i) {
+            keys[i] = buffer.pairs[i].first;
+            indices[i] = buffer.pairs[i].second;
+        }
+        return ;
+    }
+
+    // histograms of all the bytes are counted in a single pass over the keys
+    buffer.reserve(size);
+    BitsType* bits = buffer.bits.data();
+    std::size_t counts[num_passes][radix] = {};
+    for (std::size_t i = 0; i < size; ++i) {
+        bits[i] = RadixKey<KeyType>::encode(keys[i]);
+        for (std::size_t pass = 0; pass < num_passes; ++pass) {
+            counts[pass][(bits[i] >> (8 * pass)) & (radix - 1)]++;
+        }
+    }
+
+    BitsType* swap_bits = buffer.swap_bits.data();
+    IndexType* swap_indices = buffer.swap_indices.data();
+    IndexType* sorted_indices = indices;
+    for (std::size_t pass = 0; pass < num_passes; ++pass) {
+        std::size_t* count = counts[pass];
+        // all keys share this byte, the pass would not move them
+        if (count[(bits[0] >> (8 * pass)) & (radix - 1)] == size) {
+            continue;
+        }
+
+        std::size_t offset = 0;
+        for (std::size_t b = 0; b < radix; ++b) {
+            std::size_t num_keys = count[b];
+            count[b] = offset;
+            offset += num_keys;
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            std::size_t position = count[(bits[i] >> (8 * pass)) & (radix - 1)]++;
+            swap_bits[position] = bits[i];
+            swap_indices[position] = sorted_indices[i];
+        }
+        std::swap(bits, swap_bits);
+        // after the first pass, the indices are permuted between the
+        // caller's array and the scratch buffer, never in place
+        if (sorted_indices == indices) {
+            sorted_indices = swap_indices;
+            swap_indices = indices;
+        }
+        else {
+            std::swap(sorted_indices, swap_indices);
+        }
+    }
+
+    // keys are decoded from their bits, which holds the same values in sorted order
+    if (sorted_indices != indices) {
+        std::copy(sorted_indices, sorted_indices + size, indices);
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+        BitsType key_bits = (bits[i] >> (8 * num_passes - 1)) ? (bits[i] & ~(BitsType(1) << (8 * num_passes - 1))) : ~bits[i];
+        std::memcpy(&keys[i], &key_bits, sizeof(KeyType));
+    }
+};
+
+/**
+ * @brief sort x[start:end] and apply the same permutation to y[start:end],
+ * only the range is touched.
+*/
 template <typename DataType, typename IndexType>
-void sort(std::vector<DataType>& x, 
-          std::vector<IndexType>& y, 
-          std::size_t start, 
+void sort(std::vector<DataType>& x,
+          std::vector<IndexType>& y,
+          std::size_t start,
           std::size_t end,
           bool reverse=false) {
-    
+
     if (x.size() != y.size()) {
         throw std::out_of_range("Size of two vector should be equal.");
     }
 
-    // combine x and y into vector pair<x, y>
-    std::vector<std::pair<DataType, IndexType>> combine(x.size());
-    auto x_iter = x.begin();
-    auto y_iter = y.begin();
-    for (auto& xy : combine) {
-        xy.first = *(x_iter++);
-        xy.second = *(y_iter++);
+    // combine x[start:end] and y[start:end] into vector pair<x, y>
+    std::vector<std::pair<DataType, IndexType>> combine(end - start);
+    for (std::size_t i = start; i < end; ++i) {
+        combine[i - start].first = x[i];
+        combine[i - start].second = y[i];
     }
 
     // sort x_y within the range [start:end]
     if (!reverse) {
-        sort(combine.begin() + start, 
-             combine.end() - (combine.size() - end), 
-             [](const std::pair<DataType, IndexType>& left, 
-                const std::pair<DataType, IndexType>& right) -> bool {
-                    return left.first < right.first;
-            });
+        std::sort(combine.begin(),
+                  combine.end(),
+                  [](const std::pair<DataType, IndexType>& left,
+                     const std::pair<DataType, IndexType>& right) -> bool {
+                        return left.first < right.first;
+                });
     }
     else {
-        sort(combine.begin() + start, 
-             combine.end() - (combine.size() - end), 
-             [](const std::pair<DataType, IndexType>& left, 
-                const std::pair<DataType, IndexType>& right) -> bool {
-                    return left.first > right.first;
-            });
+        std::sort(combine.begin(),
+                  combine.end(),
+                  [](const std::pair<DataType, IndexType>& left,
+                     const std::pair<DataType, IndexType>& right) -> bool {
+                        return left.first > right.first;
+                });
     }
 
-    // copy sorted vector pair<x,y> back into x, y
-    x_iter = x.begin();
-    y_iter = y.begin();
-    for (auto& xy : combine) {
-        *(x_iter++) = xy.first;
-        *(y_iter++) = xy.second;
+    // copy sorted vector pair<x,y> back into x[start:end], y[start:end]
+    for (std::size_t i = start; i < end; ++i) {
+        x[i] = combine[i - start].first;
+        y[i] = combine[i - start].second;
+    }
+};
+
+/**
+ * @brief sort x[start:end] in ascending order and apply the same permutation
+ * to y[start:end] with sort_by_key, reusing buffer across calls.
+*/
+template <typename DataType, typename IndexType>
+void sort(std::vector<DataType>& x,
+          std::vector<IndexType>& y,
+          std::size_t start,
+          std::size_t end,
+          SortBuffer<DataType, IndexType>& buffer) {
+
+    if (x.size() != y.size()) {
+        throw std::out_of_range("Size of two vector should be equal.");
     }
+    sort_by_key(x.data() + start, y.data() + start, end - start, buffer);
 };
 
-} // namespace 
-#endif // UTILITY_SORT_HPP_
\ No newline at end of file
+} // namespace
+#endif // UTILITY_SORT_HPP_
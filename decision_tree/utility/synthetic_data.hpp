@@ -0,0 +1,333 @@
+#ifndef UTILITY_SYNTHETIC_DATA_HPP_
+#define UTILITY_SYNTHETIC_DATA_HPP_
+
+#include "common/prereqs.hpp"
+#include "random.hpp"
+
+#include <cstdio>
+
+namespace decisiontree {
+
+/**
+ * @brief seeded generator of synthetic classification data, rows are drawn
+ * one after another from a single random stream, so the same seed gives the
+ * same data whatever the size of the chunks it is generated in. Three kinds
+ * of data are supported:
+ *  - "gaussian_mixture": one gaussian cluster per class around a random
+ *    center, the first output is the class of the cluster a sample is drawn
+ *    from, the other outputs are the classes of their nearest centers
+ *  - "xor": uniform features in [-1, 1), output o is the checkerboard of
+ *    num_classes x num_classes cells of features 2o and 2o + 1, with 2
+ *    classes the XOR of their signs
+ *  - "hyperplane": standard normal features, output o is a noisy projection
+ *    on a random direction quantized into classes of about the same size
+ *
+ * Once the labels are drawn, each value is replaced with duplicate_rate
+ * probability by the value of the same feature in the previous row, which
+ * gives ties and with a rate of 1 constant features, then with missing_rate
+ * probability by NaN.
+*/
+template<typename FeatureType, typename ClassType>
+class BasicSyntheticDataGenerator {
+private:
+    enum class SyntheticKind {gaussian_mixture, xor_pattern, hyperplane};
+
+    NumSamplesType num_samples_;
+    NumFeaturesType num_features_;
+    NumClassesType num_classes_;
+    NumOutputsType num_outputs_;
+    SyntheticKind kind_;
+    double missing_rate_;
+    double duplicate_rate_;
+    unsigned long seed_;
+
+    RandomState random_state_;
+    NumSamplesType num_generated_;
+
+    // gaussian mixture centers of shape (num_outputs, num_classes, num_features),
+    // hyperplane unit directions of shape (num_outputs, num_features)
+    std::vector<double> centers_;
+    std::vector<double> directions_;
+
+    // values of the previous row before missing values are drawn
+    std::vector<FeatureType> previous_row_;
+
+    // spread of the gaussian clusters and noise of the hyperplane projections
+    static constexpr double CLUSTER_STDDEV = 1.0;
+    static constexpr double CENTER_STDDEV = 2.0;
+    static constexpr double HYPERPLANE_NOISE = 0.3;
+
+    static SyntheticKind to_synthetic_kind(const std::string& kind) {
+        if (kind == "gaussian_mixture") {
+            return SyntheticKind::gaussian_mixture;
+        }
+        if (kind == "xor") {
+            return SyntheticKind::xor_pattern;
+        }
+        if (kind == "hyperplane") {
+            return SyntheticKind::hyperplane;
+        }
+        throw std::invalid_argument("Kind of synthetic data must be 'gaussian_mixture', 'xor' or 'hyperplane'.");
+    };
+
+    /**
+     * @brief draw the centers and the directions which the labels depend on
+    */
+    void init_model() {
+        random_state_ = RandomState(seed_);
+        num_generated_ = 0;
+        previous_row_.assign(num_features_, 0.0);
+        centers_.clear();
+        directions_.clear();
+        if (kind_ == SyntheticKind::gaussian_mixture) {
+            centers_.resize(num_outputs_ * num_classes_ * num_features_);
+            for (double& center : centers_) {
+                center = random_state_.normal(0.0, CENTER_STDDEV);
+            }
+        }
+        else if (kind_ == SyntheticKind::hyperplane) {
+            directions_.resize(num_outputs_ * num_features_);
+            for (IndexType o = 0; o < num_outputs_; ++o) {
+                double* direction = &directions_[o * num_features_];
+                double norm = 0.0;
+                for (IndexType f = 0; f < num_features_; ++f) {
+                    direction[f] = random_state_.normal(0.0, 1.0);
+                    norm += direction[f] * direction[f];
+                }
+                norm = std::sqrt(norm);
+                for (IndexType f = 0; f < num_features_; ++f) {
+                    direction[f] /= norm;
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief index of the center of output o nearest to x
+    */
+    ClassType nearest_center(const FeatureType* x, IndexType o) const {
+        ClassType nearest = 0;
+        double min_distance = std::numeric_limits<double>::max();
+        for (NumClassesType c = 0; c < num_classes_; ++c) {
+            const double* center = &centers_[(o * num_classes_ + c) * num_features_];
+            double distance = 0.0;
+            for (IndexType f = 0; f < num_features_; ++f) {
+                distance += (x[f] - center[f]) * (x[f] - center[f]);
+            }
+            if (distance < min_distance) {
+                min_distance = distance;
+                nearest = c;
+            }
+        }
+        return nearest;
+    };
+
+    /**
+     * @brief draw the features x of one sample and its labels y
+    */
+    void generate_row(FeatureType* x, ClassType* y) {
+        switch (kind_) {
+            case SyntheticKind::gaussian_mixture: {
+                NumClassesType c = random_state_.uniform_int(0, num_classes_);
+                const double* center = &centers_[c * num_features_];
+                for (IndexType f = 0; f < num_features_; ++f) {
+                    x[f] = random_state_.normal(center[f], CLUSTER_STDDEV);
+                }
+                y[0] = c;
+                for (IndexType o = 1; o < num_outputs_; ++o) {
+                    y[o] = nearest_center(x, o);
+                }
+                break;
+            }
+            case SyntheticKind::xor_pattern: {
+                for (IndexType f = 0; f < num_features_; ++f) {
+                    x[f] = random_state_.uniform_real(-1.0, 1.0);
+                }
+                for (IndexType o = 0; o < num_outputs_; ++o) {
+                    // cell of features 2o and 2o + 1 in a num_classes x num_classes grid
+                    NumClassesType a = std::min<NumClassesType>((x[(2 * o) % num_features_] + 1.0) / 2.0 * num_classes_, num_classes_ - 1);
+                    NumClassesType b = std::min<NumClassesType>((x[(2 * o + 1) % num_features_] + 1.0) / 2.0 * num_classes_, num_classes_ - 1);
+                    y[o] = (a + b) % num_classes_;
+                }
+                break;
+            }
+            case SyntheticKind::hyperplane: {
+                for (IndexType f = 0; f < num_features_; ++f) {
+                    x[f] = random_state_.normal(0.0, 1.0);
+                }
+                for (IndexType o = 0; o < num_outputs_; ++o) {
+                    // projection on a unit direction is N(0, 1), with noise
+                    // its normal cdf is uniform in [0, 1)
+                    const double* direction = &directions_[o * num_features_];
+                    double score = random_state_.normal(0.0, HYPERPLANE_NOISE);
+                    for (IndexType f = 0; f < num_features_; ++f) {
+                        score += direction[f] * x[f];
+                    }
+                    double scale = std::sqrt(2.0 * (1.0 + HYPERPLANE_NOISE * HYPERPLANE_NOISE));
+                    double cdf = 0.5 * (1.0 + std::erf(score / scale));
+                    y[o] = std::min<NumClassesType>(cdf * num_classes_, num_classes_ - 1);
+                }
+                break;
+            }
+        }
+
+        for (IndexType f = 0; f < num_features_; ++f) {
+            if (duplicate_rate_ > 0.0 && random_state_.uniform_real(0.0, 1.0) < duplicate_rate_) {
+                x[f] = previous_row_[f];
+            }
+            previous_row_[f] = x[f];
+            if (missing_rate_ > 0.0 && random_state_.uniform_real(0.0, 1.0) < missing_rate_) {
+                x[f] = std::numeric_limits<FeatureType>::quiet_NaN();
+            }
+        }
+    };
+
+public:
+    /**
+     * @param num_samples number of rows the generator yields in total
+     * @param kind "gaussian_mixture", "xor" or "hyperplane"
+     * @param missing_rate probability of a value to be NaN
+     * @param duplicate_rate probability of a value to repeat the value of
+     *      the previous row
+    */
+    BasicSyntheticDataGenerator(NumSamplesType num_samples,
+                                NumFeaturesType num_features,
+                                NumClassesType num_classes,
+                                NumOutputsType num_outputs = 1,
+                                std::string kind = "gaussian_mixture",
+                                double missing_rate = 0.0,
+                                double duplicate_rate = 0.0,
+                                unsigned long seed = 0): num_samples_(num_samples),
+        num_features_(num_features),
+        num_classes_(num_classes),
+        num_outputs_(num_outputs),
+        kind_(to_synthetic_kind(kind)),
+        missing_rate_(missing_rate),
+        duplicate_rate_(duplicate_rate),
+        seed_(seed),
+        random_state_(seed) {
+            if (num_features_ == 0 || num_outputs_ == 0) {
+                throw std::invalid_argument("Synthetic data must have at least one feature and one output.");
+            }
+            if (num_classes_ < 2) {
+                throw std::invalid_argument("Synthetic data must have at least two classes.");
+            }
+            if (missing_rate_ < 0.0 || missing_rate_ > 1.0 || duplicate_rate_ < 0.0 || duplicate_rate_ > 1.0) {
+                throw std::invalid_argument("missing_rate and duplicate_rate must be in [0, 1].");
+            }
+            init_model();
+        };
+    ~BasicSyntheticDataGenerator() {};
+
+    /**
+     * @brief start the stream over, the next rows are the first rows again
+    */
+    void reset() {
+        init_model();
+    };
+
+    /**
+     * @brief names "f0", "f1", ... of the features
+    */
+    std::vector<std::string> get_feature_names() const {
+        std::vector<std::string> feature_names;
+        for (IndexType f = 0; f < num_features_; ++f) {
+            feature_names.push_back("f" + std::to_string(f));
+        }
+        return feature_names;
+    };
+
+    /**
+     * @brief labels "0", "1", ... of the classes of each output, the label
+     * of class c is the string of c
+    */
+    std::vector<std::vector<std::string>> get_class_labels() const {
+        std::vector<std::string> labels;
+        for (NumClassesType c = 0; c < num_classes_; ++c) {
+            labels.push_back(std::to_string(c));
+        }
+        return std::vector<std::vector<std::string>>(num_outputs_, labels);
+    };
+
+    NumSamplesType get_num_remaining_samples() const {
+        return num_samples_ - num_generated_;
+    };
+
+    /**
+     * @brief generate the next rows of the stream into the caller-provided
+     * row-major X of shape (chunk_size, num_features) and y of shape
+     * (chunk_size, num_outputs)
+     *
+     * @return number of rows generated, less than chunk_size at the end
+     *      of the stream and 0 once all the rows are generated
+    */
+    NumSamplesType generate(NumSamplesType chunk_size, FeatureType* X, ClassType* y) {
+        NumSamplesType num_rows = std::min(chunk_size, get_num_remaining_samples());
+        for (IndexType i = 0; i < num_rows; ++i) {
+            generate_row(&X[i * num_features_], &y[i * num_outputs_]);
+        }
+        num_generated_ += num_rows;
+        return num_rows;
+    };
+
+    /**
+     * @brief generate all the remaining rows of the stream in memory
+    */
+    void generate(std::vector<FeatureType>& X, std::vector<ClassType>& y) {
+        NumSamplesType num_rows = get_num_remaining_samples();
+        X.resize(num_rows * num_features_);
+        y.resize(num_rows * num_outputs_);
+        generate(num_rows, X.data(), y.data());
+    };
+
+    /**
+     * @brief write the remaining rows of the stream to a CSV file, chunk_size
+     * rows at a time, so data larger than memory can be written. The header
+     * holds the feature names then one column "y0", "y1", ... per output,
+     * missing values are written as "nan" and labels as class labels.
+    */
+    void write_csv(const std::string& path, NumSamplesType chunk_size = 65536) {
+        std::ofstream os(path, std::ios::trunc);
+        if (!os) {
+            throw std::runtime_error("Failed to open '" + path + "'.");
+        }
+        std::vector<std::string> feature_names = get_feature_names();
+        for (IndexType f = 0; f < num_features_; ++f) {
+            os << feature_names[f] << ',';
+        }
+        for (IndexType o = 0; o < num_outputs_; ++o) {
+            os << 'y' << o << (o + 1 < num_outputs_ ? ',' : '\n');
+        }
+
+        chunk_size = std::max<NumSamplesType>(chunk_size, 1);
+        std::vector<FeatureType> X(chunk_size * num_features_);
+        std::vector<ClassType> y(chunk_size * num_outputs_);
+        std::string text;
+        char value[32];
+        NumSamplesType num_rows;
+        while ((num_rows = generate(chunk_size, X.data(), y.data())) > 0) {
+            text.clear();
+            for (IndexType i = 0; i < num_rows; ++i) {
+                for (IndexType f = 0; f < num_features_; ++f) {
+                    // 17 significant digits read back the same double
+                    std::snprintf(value, sizeof(value), "%.17g,", static_cast<double>(X[i * num_features_ + f]));
+                    text += value;
+                }
+                for (IndexType o = 0; o < num_outputs_; ++o) {
+                    text += std::to_string(y[i * num_outputs_ + o]);
+                    text += (o + 1 < num_outputs_) ? ',' : '\n';
+                }
+            }
+            os.write(text.data(), text.size());
+            if (!os) {
+                throw std::runtime_error("Failed to write '" + path + "'.");
+            }
+        }
+    };
+};
+
+using SyntheticDataGenerator = BasicSyntheticDataGenerator<FeatureType, ClassType>;
+
+} // namespace
+
+#endif // UTILITY_SYNTHETIC_DATA_HPP_
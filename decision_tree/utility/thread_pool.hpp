@@ -0,0 +1,217 @@
+#ifndef UTILITY_THREAD_POOL_HPP_
+#define UTILITY_THREAD_POOL_HPP_
+
+#include "common/prereqs.hpp"
+
+namespace decisiontree {
+
+/**
+ * @brief A fixed-size pool of worker threads. The thread calling
+ * parallel_for takes part in the work, so a pool of num_threads
+ * threads only starts num_threads - 1 workers.
+*/
+class ThreadPool {
+private:
+    // state of one parallel_for call, it lives on the stack of the calling 
+    // thread, which returns only once no worker holds it any more. The task 
+    // function is called through a plain function pointer, so a call wraps 
+    // nothing on the heap.
+    struct ParallelForState {
+        std::atomic<IndexType> next_task;
+        IndexType end;
+        const void* func;
+        void (*call)(const void*, IndexType);
+        NumThreadsType num_running_jobs;
+        std::exception_ptr exception;
+        std::mutex mutex;
+        std::condition_variable condition;
+
+        ParallelForState(IndexType begin,
+                         IndexType end,
+                         const void* func, 
+                         void (*call)(const void*, IndexType)): next_task(begin),
+            end(end),
+            func(func),
+            call(call),
+            num_running_jobs(0),
+            exception(nullptr) {};
+        ~ParallelForState() {};
+    };
+
+    std::vector<std::thread> workers_;
+    // jobs not dequeued yet, a job is a parallel_for call a worker joins, 
+    // the vector keeps its capacity, so queuing jobs does not allocate 
+    // once the pool has run a few calls
+    std::vector<ParallelForState*> jobs_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stop_;
+
+    /**
+     * @brief claim and run tasks until no task is left
+    */
+    static void run_tasks(ParallelForState& state) {
+        IndexType task;
+        while ((task = state.next_task++) < state.end) {
+            try {
+                state.call(state.func, task);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (!state.exception) {
+                    state.exception = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void worker_loop() {
+        for (;;) {
+            ParallelForState* state;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+                if (stop_ && jobs_.empty()) {
+                    return ;
+                }
+                state = jobs_.back();
+                jobs_.pop_back();
+                // counted while mutex_ is held, the calling thread sees 
+                // either the job in jobs_ or the job running
+                std::lock_guard<std::mutex> state_lock(state->mutex);
+                state->num_running_jobs++;
+            }
+            run_tasks(*state);
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (--state->num_running_jobs == 0) {
+                state->condition.notify_all();
+            }
+        }
+    }
+
+public:
+    /**
+     * @param num_threads total number of threads including the calling thread,
+     *      if 0, use the number of concurrent threads supported by the hardware
+    */
+    explicit ThreadPool(NumThreadsType num_threads = 0): stop_(false) {
+        if (num_threads == 0) {
+            num_threads = std::max<NumThreadsType>(std::thread::hardware_concurrency(), 1);
+        }
+        jobs_.reserve(num_threads);
+        for (NumThreadsType t = 1; t < num_threads; ++t) {
+            workers_.emplace_back(&ThreadPool::worker_loop, this);
+        }
+    };
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        condition_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    };
+
+    NumThreadsType get_num_threads() const {
+        return workers_.size() + 1;
+    }
+
+    /**
+     * @brief call func(task) for each task in [begin:end] and block until all
+     * tasks are done, tasks are claimed dynamically by the calling thread and
+     * the workers. It is safe to call parallel_for from inside a task, the
+     * calling thread never waits for a task that nobody has claimed. The first
+     * exception thrown by a task is rethrown in the calling thread. Several 
+     * threads may call parallel_for on the same pool concurrently.
+    */
+    template<typename Function>
+    void parallel_for(IndexType begin,
+                      IndexType end,
+                      Function&& func) {
+        if (end <= begin) {
+            return ;
+        }
+        using FunctionType = typename std::remove_reference<Function>::type;
+        ParallelForState state(begin, end, &func, [](const void* f, IndexType task) {
+            (*const_cast<FunctionType*>(static_cast<const FunctionType*>(f)))(task);
+        });
+
+        NumThreadsType num_jobs = std::min<NumThreadsType>(workers_.size(), end - begin - 1);
+        if (num_jobs > 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (NumThreadsType j = 0; j < num_jobs; ++j) {
+                    jobs_.push_back(&state);
+                }
+            }
+            condition_.notify_all();
+        }
+        run_tasks(state);
+
+        // all tasks are claimed, drop the jobs no worker has dequeued 
+        // and wait for the workers still running tasks of this call
+        if (num_jobs > 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                jobs_.erase(std::remove(jobs_.begin(), jobs_.end(), &state), jobs_.end());
+            }
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.condition.wait(lock, [&state] {
+                return state.num_running_jobs == 0;
+            });
+        }
+        if (state.exception) {
+            std::rethrow_exception(state.exception);
+        }
+    }
+};
+
+/**
+ * @brief call func(begin, end) for each block of block_size samples in 
+ * [0:num_samples], in parallel on thread_pool if it is given, otherwise 
+ * in the calling thread. Nothing is allocated by the call.
+*/
+template<typename Function>
+void for_each_block(NumSamplesType num_samples, 
+                    NumSamplesType block_size, 
+                    ThreadPool* thread_pool, 
+                    Function&& func) {
+    IndexType num_blocks = (num_samples + block_size - 1) / block_size;
+    auto block_func = [&](IndexType b) {
+        func(b * block_size, std::min<IndexType>((b + 1) * block_size, num_samples));
+    };
+
+    if (thread_pool != nullptr && thread_pool->get_num_threads() > 1 && num_blocks > 1) {
+        thread_pool->parallel_for(0, num_blocks, block_func);
+    }
+    else {
+        for (IndexType b = 0; b < num_blocks; ++b) {
+            block_func(b);
+        }
+    }
+};
+
+/**
+ * @brief a buffer of at least size values owned by the calling thread, e.g. 
+ * the scratch of the blocks a thread runs in for_each_block. It is reused 
+ * by the next call in the same thread, so a block takes a single buffer, 
+ * and nothing is allocated once the thread has run a block as large.
+*/
+template<typename T>
+T* get_thread_buffer(std::size_t size) {
+    static thread_local std::vector<T> buffer;
+    if (buffer.size() < size) {
+        buffer.resize(size);
+    }
+    return buffer.data();
+};
+
+} // namespace
+
+#endif // UTILITY_THREAD_POOL_HPP_
@@ -0,0 +1,52 @@
+#ifndef TESTS_MAKE_CLASSIFICATION_HPP_
+#define TESTS_MAKE_CLASSIFICATION_HPP_
+
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace testdata {
+
+/**
+ * @brief seeded classification data shared by the tests, standard normal
+ * features, labels from the score x0 + x1 * x2 plus a gaussian noise of
+ * standard deviation noise quantized into 2 or 3 classes, and a fraction
+ * missing_rate of missing values in feature 1.
+*/
+inline void make_classification(unsigned long num_samples, 
+                                unsigned long num_features, 
+                                unsigned long num_classes, 
+                                std::vector<double>& X, 
+                                std::vector<long>& y, 
+                                unsigned int seed, 
+                                double noise = 0.0, 
+                                double missing_rate = 0.05) {
+    std::mt19937 engine(seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    X.resize(num_samples * num_features);
+    y.resize(num_samples);
+    for (unsigned long i = 0; i < num_samples; ++i) {
+        for (unsigned long f = 0; f < num_features; ++f) {
+            X[i * num_features + f] = normal(engine);
+        }
+        double score = X[i * num_features] + X[i * num_features + 1] * X[i * num_features + 2];
+        if (noise > 0.0) {
+            score += noise * normal(engine);
+        }
+        if (num_classes == 2) {
+            y[i] = (score < 0.0) ? 0 : 1;
+        }
+        else {
+            y[i] = (score < -0.5) ? 0 : ((score < 0.5) ? 1 : 2);
+        }
+
+        // a few missing values
+        if (uniform(engine) < missing_rate) {
+            X[i * num_features + 1] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+};
+
+} // namespace testdata
+#endif // TESTS_MAKE_CLASSIFICATION_HPP_
@@ -5,6 +5,7 @@
 #include "decision_tree/utility/random.hpp"
 #include "decision_tree/core/splitter.hpp"
 #include "decision_tree/core/builder.hpp"
+#include "make_classification.hpp"
 
 namespace {
 
@@ -39,6 +40,48 @@ auto init_class_weight = [](unsigned long num_outputs,
     return class_weight;
 };
 
+// data of make_classification without missing values, with the class weights, 
+// the splitters and the trees the builders are compared on
+struct BuilderTestData {
+    unsigned long num_samples;
+    unsigned long num_features;
+    unsigned long num_outputs;
+    unsigned long max_num_classes;
+    std::vector<unsigned long> num_classes_list;
+    std::vector<double> X;
+    std::vector<long> y;
+    std::vector<double> class_weight;
+
+    BuilderTestData(unsigned long num_samples, 
+                    unsigned long num_features, 
+                    unsigned long num_classes, 
+                    unsigned int seed, 
+                    double noise = 0.0): num_samples(num_samples), 
+        num_features(num_features), 
+        num_outputs(1), 
+        max_num_classes(num_classes), 
+        num_classes_list(1, num_classes) {
+        testdata::make_classification(num_samples, num_features, num_classes, X, y, seed, noise, 0.0);
+        class_weight = init_class_weight(num_outputs, num_samples, max_num_classes, y, num_classes_list);
+    }
+
+    // a splitter with gini and random seed 0, max_num_features 0 searches all features
+    decisiontree::Splitter make_splitter(unsigned long max_num_features = 0, 
+                                         const std::string& split_policy = "best", 
+                                         unsigned long num_threads = 1) const {
+        decisiontree::RandomState random_state(0);
+        return decisiontree::Splitter(num_outputs, num_samples, 
+                                      num_features, (max_num_features == 0) ? num_features : max_num_features, 
+                                      max_num_classes, class_weight, 
+                                      num_classes_list, "gini", split_policy, 
+                                      random_state, false, num_threads);
+    }
+
+    decisiontree::Tree make_tree() const {
+        return decisiontree::Tree(num_outputs, num_features, num_classes_list);
+    }
+};
+
 
 class DepthFirstTreeBuilder: public ::testing::Test{    
 public:
@@ -60,7 +103,7 @@ public:
         unsigned long num_outputs = classes.size();
         unsigned long num_samples = y.size() / num_outputs;
         unsigned long num_features = features.size();
-        unsigned long max_num_features = 0;
+        unsigned long max_num_features = num_features;
         unsigned long max_num_classes = *std::max_element(begin(num_classes_list),
                                                           end(num_classes_list));
 
@@ -123,11 +166,190 @@ TEST_F(DepthFirstTreeBuilder, BuildTest) {
     builder->build(X, y, num_samples);
     // builder->tree_.print_node_info();
 
-    std::vector<double> expect = {0, 0, 1, 0};
+    std::vector<double> expect = {0.5, 0.5, 0, 0};
     std::vector<double> f_importances;
     builder->tree_.compute_feature_importance(f_importances);
+    ASSERT_EQ(f_importances.size(), expect.size());
+    for (std::size_t i = 0; i < expect.size(); ++i) {
+        EXPECT_NEAR(f_importances[i], expect[i], 1e-12);
+    }
+
+};
+
+TEST(PresortBuilderTest, BuildTest) {
+    std::vector<std::vector<std::string>> classes = {{"setosa", "versicolor", "virginica"}};
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> X = {5.2, 3.3, 1.2, 0.3,
+                            4.8, nan, 1.6, 0.2,
+                            4.75, 3.1, 1.32, 0.1,
+                            5.9, 2.6, 4.1, 1.2,
+                            5.1, 2.2, 3.3, 1.1,
+                            5.2, 2.7, 4.1, 1.3,
+                            6.6, 3.1, 5.25, 2.2,
+                            6.3, 2.5, 5.1, 2.0,
+                            6.5, 3.1, 5.2, 2.1};
+    std::vector<long> y = {0, 0, 0, 1, 1, 1, 2, 2, 2};
+
+    std::vector<unsigned long> num_classes_list = calculate_num_classes_list(classes);
+    unsigned long num_outputs = classes.size();
+    unsigned long num_samples = y.size() / num_outputs;
+    unsigned long num_features = 4;
+    unsigned long max_num_classes = 3;
+    std::vector<double>  class_weight = init_class_weight(num_outputs, 
+                                                          num_samples, 
+                                                          max_num_classes,
+                                                          y, 
+                                                          num_classes_list);
+
+    std::vector<std::vector<double>> f_importances(2);
+    std::vector<std::vector<double>> proba(2);
+    for (int presort = 0; presort < 2; ++presort) {
+        decisiontree::RandomState random_state(0);
+        decisiontree::Splitter splitter(num_outputs, num_samples, 
+                                        num_features, num_features, 
+                                        max_num_classes, class_weight, 
+                                        num_classes_list, "gini", "best", 
+                                        random_state, presort == 1);
+        decisiontree::Tree tree(num_outputs, num_features, num_classes_list);
+        decisiontree::DepthFirstTreeBuilder builder(4, 2, 1, 0, class_weight, splitter, tree);
+        builder.build(X, y, num_samples);
+        builder.tree_.compute_feature_importance(f_importances[presort]);
+        builder.tree_.predict_proba(X, num_samples, proba[presort]);
+    }
+    EXPECT_THAT(f_importances[1], ::testing::ContainerEq(f_importances[0]));
+    EXPECT_THAT(proba[1], ::testing::ContainerEq(proba[0]));
+};
+
+TEST(ParallelSplitBuilderTest, BuildTest) {
+    // samples enough to search the split features in parallel at the top nodes, 
+    // values rounded to one decimal give ties between features
+    BuilderTestData data(6000, 6, 3, 0, 0.3);
+    for (double& value : data.X) {
+        value = std::round(value * 10.0) / 10.0;
+    }
+
+    std::vector<unsigned long> num_threads = {1, 4};
+    std::vector<std::vector<double>> f_importances(num_threads.size());
+    std::vector<std::vector<double>> proba(num_threads.size());
+    for (std::size_t k = 0; k < num_threads.size(); ++k) {
+        decisiontree::DepthFirstTreeBuilder builder(6, 2, 1, 0, data.class_weight, 
+                                                    data.make_splitter(0, "best", num_threads[k]), 
+                                                    data.make_tree());
+        builder.build(data.X, data.y, data.num_samples);
+        builder.tree_.compute_feature_importance(f_importances[k]);
+        builder.tree_.predict_proba(data.X, data.num_samples, proba[k]);
+    }
+    EXPECT_THAT(f_importances[1], ::testing::ContainerEq(f_importances[0]));
+    EXPECT_THAT(proba[1], ::testing::ContainerEq(proba[0]));
+};
+
+TEST(BreadthFirstTreeBuilderTest, BuildTest) {
+    BuilderTestData data(6000, 6, 3, 1, 0.3);
+
+    // each node has the random state of its path from the root, the trees are 
+    // the same whether all features or a random subset are searched at each 
+    // node and with random thresholds, also for the second tree of a builder
+    std::vector<std::pair<unsigned long, std::string>> params = {
+        {0, "best"}, {2, "best"}, {2, "hist"}, {0, "random"}, {2, "random"}
+    };
+    for (const auto& param : params) {
+        decisiontree::Splitter splitter = data.make_splitter(param.first, param.second);
+        decisiontree::Tree tree = data.make_tree();
+        decisiontree::DepthFirstTreeBuilder depth_first_builder(8, 2, 1, 0, data.class_weight, splitter, tree);
+        decisiontree::BreadthFirstTreeBuilder breadth_first_builder(8, 2, 1, 0, data.class_weight, splitter, tree, 4);
+        std::vector<std::vector<double>> depth_first_proba(2);
+        for (int k = 0; k < 2; ++k) {
+            depth_first_builder.tree_ = tree;
+            breadth_first_builder.tree_ = tree;
+            depth_first_builder.build(data.X, data.y, data.num_samples);
+            breadth_first_builder.build(data.X, data.y, data.num_samples);
+
+            EXPECT_EQ(breadth_first_builder.tree_.nodes_.size(), depth_first_builder.tree_.nodes_.size());
+            std::vector<double> expect, f_importances;
+            depth_first_builder.tree_.compute_feature_importance(expect);
+            breadth_first_builder.tree_.compute_feature_importance(f_importances);
+            EXPECT_THAT(f_importances, ::testing::ContainerEq(expect));
+
+            std::vector<double> proba;
+            depth_first_builder.tree_.predict_proba(data.X, data.num_samples, depth_first_proba[k]);
+            breadth_first_builder.tree_.predict_proba(data.X, data.num_samples, proba);
+            EXPECT_THAT(proba, ::testing::ContainerEq(depth_first_proba[k]));
+        }
+
+        // the next tree of a builder draws other random states
+        if (param.first != 0 || param.second == "random") {
+            EXPECT_NE(depth_first_proba[1], depth_first_proba[0]);
+        }
+    }
+};
+
+TEST(BestFirstTreeBuilderTest, BuildTest) {
+    BuilderTestData data(2000, 4, 3, 2, 0.3);
+    decisiontree::Splitter splitter = data.make_splitter();
+    decisiontree::Tree tree = data.make_tree();
+
+    auto count_leaf_nodes = [](const decisiontree::Tree& tree) {
+        unsigned long num_leaf_nodes = 0;
+        for (const auto& node : tree.nodes_) {
+            num_leaf_nodes += (node.left_child == 0);
+        }
+        return num_leaf_nodes;
+    };
+
+    // the tree stops at max_leaf_nodes leaves
+    decisiontree::BestFirstTreeBuilder small_builder(6, 2, 1, 0, data.class_weight, splitter, tree, 8);
+    small_builder.build(data.X, data.y, data.num_samples);
+    EXPECT_EQ(count_leaf_nodes(small_builder.tree_), 8);
+    EXPECT_EQ(small_builder.tree_.nodes_.size(), 15);
+
+    // with an unreachable budget, the tree is the same as the depth-first one
+    decisiontree::DepthFirstTreeBuilder depth_first_builder(6, 2, 1, 0, data.class_weight, splitter, tree);
+    decisiontree::BestFirstTreeBuilder best_first_builder(6, 2, 1, 0, data.class_weight, splitter, tree, data.num_samples);
+    depth_first_builder.build(data.X, data.y, data.num_samples);
+    best_first_builder.build(data.X, data.y, data.num_samples);
+    EXPECT_EQ(best_first_builder.tree_.nodes_.size(), depth_first_builder.tree_.nodes_.size());
+
+    std::vector<double> expect, f_importances;
+    depth_first_builder.tree_.compute_feature_importance(expect);
+    best_first_builder.tree_.compute_feature_importance(f_importances);
     EXPECT_THAT(f_importances, ::testing::ContainerEq(expect));
 
+    std::vector<double> expect_proba, proba;
+    depth_first_builder.tree_.predict_proba(data.X, data.num_samples, expect_proba);
+    best_first_builder.tree_.predict_proba(data.X, data.num_samples, proba);
+    EXPECT_THAT(proba, ::testing::ContainerEq(expect_proba));
+
+    // the small tree keeps the splits with the highest improvement
+    std::vector<double> small_proba;
+    small_builder.tree_.predict_proba(data.X, data.num_samples, small_proba);
+    EXPECT_EQ(small_builder.tree_.nodes_[0].feature_index, depth_first_builder.tree_.nodes_[0].feature_index);
+    EXPECT_EQ(small_builder.tree_.nodes_[0].threshold, depth_first_builder.tree_.nodes_[0].threshold);
+};
+
+
+TEST(DeepTreeBuilderTest, BuildTest) {
+    // noisy labels grow a deep tree down to pure leaves
+    BuilderTestData data(3000, 3, 2, 3, 1.0);
+    decisiontree::Splitter splitter = data.make_splitter();
+    decisiontree::Tree tree = data.make_tree();
+
+    // the node records grow with the tree, whatever the depth limit
+    std::vector<unsigned long> node_counts;
+    std::vector<std::vector<double>> probas(3);
+    std::vector<unsigned long> max_depths = {40, 64, 1000};
+    for (std::size_t k = 0; k < max_depths.size(); ++k) {
+        decisiontree::DepthFirstTreeBuilder builder(max_depths[k], 2, 1, 0, data.class_weight, splitter, tree);
+        builder.build(data.X, data.y, data.num_samples);
+        node_counts.push_back(builder.tree_.get_node_count());
+        EXPECT_EQ(builder.tree_.nodes_.size(), node_counts.back());
+        EXPECT_EQ(builder.get_node_ranges().size(), node_counts.back());
+        builder.tree_.predict_proba(data.X, data.num_samples, probas[k]);
+    }
+    EXPECT_GT(node_counts[0], NUM_NODES_PER_CHUNK);
+    EXPECT_EQ(node_counts[1], node_counts[0]);
+    EXPECT_EQ(node_counts[2], node_counts[0]);
+    EXPECT_THAT(probas[1], ::testing::ContainerEq(probas[0]));
+    EXPECT_THAT(probas[2], ::testing::ContainerEq(probas[0]));
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "decision_tree/core/criterion/entropy.hpp"
+#include "decision_tree/core/criterion/gini.hpp"
+
+namespace {
+
+TEST(EntropyCriterionTest, ComputeImpurityTest) {
+    // counts are normalized by the total count of the histogram
+    std::vector<double> uniform = {3.0, 3.0, 3.0, 3.0};
+    EXPECT_DOUBLE_EQ(decisiontree::Entropy::compute_impurity(uniform.data(), uniform.size()), 2.0);
+
+    std::vector<double> skewed = {1.0, 3.0, 0.0};
+    double expect = -(0.25 * std::log2(0.25) + 0.75 * std::log2(0.75));
+    EXPECT_DOUBLE_EQ(decisiontree::Entropy::compute_impurity(skewed.data(), skewed.size()), expect);
+
+    std::vector<double> pure = {0.0, 7.0, 0.0};
+    EXPECT_DOUBLE_EQ(decisiontree::Entropy::compute_impurity(pure.data(), pure.size()), 0.0);
+
+    std::vector<double> empty = {0.0, 0.0};
+    EXPECT_DOUBLE_EQ(decisiontree::Entropy::compute_impurity(empty.data(), empty.size()), 0.0);
+}
+
+TEST(EntropyCriterionTest, ComputeImpurityManyClassesTest) {
+    // many classes take the vectorized path, which must agree with 
+    // the definition and evaluate both children at once
+    unsigned long num_classes = 1000;
+    std::vector<double> left(num_classes), right(num_classes);
+    for (unsigned long c = 0; c < num_classes; ++c) {
+        left[c] = static_cast<double>(c % 13);
+        right[c] = 0.5 * static_cast<double>((c * 7) % 29 + 1);
+    }
+    auto entropy = [](const std::vector<double>& histogram) {
+        double sum_cnt = std::accumulate(histogram.begin(), histogram.end(), 0.0);
+        double impurity = 0.0;
+        for (double cnt : histogram) {
+            if (cnt > 0.0) {
+                impurity -= cnt / sum_cnt * std::log2(cnt / sum_cnt);
+            }
+        }
+        return impurity;
+    };
+    auto gini = [](const std::vector<double>& histogram) {
+        double sum_cnt = std::accumulate(histogram.begin(), histogram.end(), 0.0);
+        double impurity = 1.0;
+        for (double cnt : histogram) {
+            impurity -= (cnt / sum_cnt) * (cnt / sum_cnt);
+        }
+        return impurity;
+    };
+
+    double left_impurity, right_impurity;
+    decisiontree::Entropy::compute_impurity(left.data(), right.data(), num_classes, 
+                                            left_impurity, right_impurity);
+    EXPECT_NEAR(left_impurity, entropy(left), 1e-12);
+    EXPECT_NEAR(right_impurity, entropy(right), 1e-12);
+
+    decisiontree::Gini::compute_impurity(left.data(), right.data(), num_classes, 
+                                         left_impurity, right_impurity);
+    EXPECT_NEAR(left_impurity, gini(left), 1e-12);
+    EXPECT_NEAR(right_impurity, gini(right), 1e-12);
+}
+
+} // namespace
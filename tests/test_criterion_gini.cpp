@@ -173,4 +173,27 @@ TEST_F(GiniCriterionTest, ComputeImpurityImprovementTest) {
     EXPECT_PRED_FORMAT2(DoubleLE, impurity, double(2.0/3.0));
 }
 
+TEST_F(GiniCriterionTest, CopyCriterionTest) {
+    std::vector<long> y = {0, 0, 0, 1, 1, 1, 2, 2, 2};
+    unsigned long num_samples = y.size();
+    std::vector<unsigned long> sample_indices(num_samples);
+    std::iota(sample_indices.begin(), sample_indices.end(), 0);
+
+    gini->compute_node_histogram(y, sample_indices, 0, num_samples);
+    gini->init_children_histogram();
+
+    // the copy holds its own histograms, updating it leaves the original unchanged
+    decisiontree::Gini copy(*gini);
+    copy.update_children_histogram(y, sample_indices, 3);
+    EXPECT_THAT(copy.get_node_weighted_histogram(), 
+                ::testing::ContainerEq(gini->get_node_weighted_histogram()));
+    EXPECT_THAT(copy.get_left_weighted_num_samples(), ::testing::ElementsAre(3.0));
+    EXPECT_THAT(gini->get_left_weighted_num_samples(), ::testing::ElementsAre(0.0));
+
+    *gini = copy;
+    EXPECT_THAT(gini->get_left_weighted_histogram(), 
+                ::testing::ContainerEq(copy.get_left_weighted_histogram()));
+    EXPECT_DOUBLE_EQ(gini->compute_impurity_improvement(), copy.compute_impurity_improvement());
+}
+
 } //namespace
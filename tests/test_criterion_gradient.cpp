@@ -0,0 +1,178 @@
+#include <iostream>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "decision_tree/core/criterion/gradient.hpp"
+
+namespace {
+
+// gain of splitting the samples [0:n] at threshold_index with regularization lambda
+auto newton_gain = [](const std::vector<double>& gradients, 
+                      const std::vector<double>& hessians, 
+                      unsigned long threshold_index, 
+                      double lambda) {
+    double left_g = 0.0, left_h = 0.0, right_g = 0.0, right_h = 0.0;
+    for (unsigned long i = 0; i < gradients.size(); ++i) {
+        if (i < threshold_index) {
+            left_g += gradients[i];
+            left_h += hessians[i];
+        }
+        else {
+            right_g += gradients[i];
+            right_h += hessians[i];
+        }
+    }
+    double g = left_g + right_g, h = left_h + right_h;
+    return left_g * left_g / (left_h + lambda) + right_g * right_g / (right_h + lambda) - g * g / (h + lambda);
+};
+
+class GradientCriterionTest : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        gradients = {-0.8, -0.6, -0.7, 0.1, 0.4, 0.5, 0.3, 0.6};
+        hessians = {0.16, 0.24, 0.21, 0.09, 0.24, 0.25, 0.21, 0.24};
+        y = std::vector<long>(gradients.size(), 0);
+        sample_indices.resize(gradients.size());
+        std::iota(sample_indices.begin(), sample_indices.end(), 0);
+    }
+
+    std::vector<double> gradients;
+    std::vector<double> hessians;
+    std::vector<long> y;
+    std::vector<unsigned long> sample_indices;
+};
+
+TEST_F(GradientCriterionTest, ImprovementTest) {
+    const unsigned long num_samples = gradients.size();
+    for (double lambda : {0.0, 1.0}) {
+        decisiontree::GradientCriterion criterion(num_samples, gradients.data(), hessians.data(), lambda);
+        criterion.compute_node_histogram(y, sample_indices, 0, num_samples);
+        criterion.compute_node_impurity();
+        EXPECT_GT(criterion.get_node_impurity(), 0.0);
+        EXPECT_DOUBLE_EQ(criterion.get_node_weighted_num_samples()[0], 
+                         std::accumulate(hessians.begin(), hessians.end(), 0.0));
+
+        // the impurity improvement is the Newton gain, not scaled by the number of samples
+        criterion.init_children_histogram();
+        for (unsigned long threshold_index = 1; threshold_index < num_samples; ++threshold_index) {
+            criterion.update_children_histogram(y, sample_indices, threshold_index);
+            criterion.compute_children_impurity();
+            EXPECT_NEAR(criterion.compute_impurity_improvement(), 
+                        newton_gain(gradients, hessians, threshold_index, lambda), 
+                        1e-12);
+        }
+    }
+};
+
+TEST_F(GradientCriterionTest, BaseReferenceTest) {
+    // the methods called on the base run the statistics and the gain of the criterion
+    const unsigned long num_samples = gradients.size();
+    decisiontree::GradientCriterion criterion(num_samples, gradients.data(), hessians.data(), 1.0);
+    decisiontree::ImpurityCriterion<decisiontree::GradientCriterion>& base = criterion;
+    base.compute_node_histogram(y, sample_indices, 0, num_samples);
+    base.compute_node_impurity();
+    const std::vector<double> node_histogram = base.get_node_weighted_histogram()[0];
+    EXPECT_NEAR(node_histogram[0], std::accumulate(hessians.begin(), hessians.end(), 0.0), 1e-12);
+    EXPECT_NEAR(node_histogram[1], std::accumulate(gradients.begin(), gradients.end(), 0.0), 1e-12);
+    EXPECT_NEAR(base.get_node_weighted_num_samples()[0], node_histogram[0], 1e-12);
+
+    base.init_children_histogram();
+    base.update_children_histogram(y, sample_indices, 3);
+    base.compute_children_impurity();
+    EXPECT_NEAR(base.compute_impurity_improvement(), newton_gain(gradients, hessians, 3, 1.0), 1e-12);
+    EXPECT_EQ(base.get_num_category_orders(), 1);
+};
+
+TEST_F(GradientCriterionTest, BinHistogramTest) {
+    const unsigned long num_samples = gradients.size();
+    decisiontree::GradientCriterion criterion(num_samples, gradients.data(), hessians.data(), 1.0);
+    criterion.compute_node_histogram(y, sample_indices, 0, num_samples);
+    criterion.compute_node_impurity();
+
+    // moving the samples [0:3] as one bin is moving them one range at a time
+    std::vector<double> bin_histogram(decisiontree::NUM_GRADIENT_STATISTICS, 0.0);
+    for (unsigned long i = 0; i < 3; ++i) {
+        criterion.add_sample_to_histogram(y, i, bin_histogram.data());
+    }
+    criterion.init_children_histogram();
+    criterion.update_children_histogram(bin_histogram.data());
+    criterion.compute_children_impurity();
+    double bin_improvement = criterion.compute_impurity_improvement();
+
+    criterion.init_children_histogram();
+    criterion.update_children_histogram(y, sample_indices, 3);
+    criterion.compute_children_impurity();
+    EXPECT_NEAR(bin_improvement, criterion.compute_impurity_improvement(), 1e-12);
+    EXPECT_NEAR(criterion.get_left_weighted_num_samples()[0], 0.16 + 0.24 + 0.21, 1e-12);
+};
+
+TEST_F(GradientCriterionTest, ConstantStepTest) {
+    // all samples share the Newton step -g / h = 2, no split has a gain
+    std::vector<double> constant_gradients = {-0.2, -0.4, -0.5, -0.3};
+    std::vector<double> constant_hessians = {0.1, 0.2, 0.25, 0.15};
+    decisiontree::GradientCriterion criterion(4, constant_gradients.data(), constant_hessians.data(), 0.0);
+    std::vector<unsigned long> indices = {0, 1, 2, 3};
+    std::vector<long> constant_y(4, 0);
+    criterion.compute_node_histogram(constant_y, indices, 0, 4);
+    criterion.compute_node_impurity();
+    criterion.init_children_histogram();
+    for (unsigned long threshold_index = 1; threshold_index < 4; ++threshold_index) {
+        criterion.update_children_histogram(constant_y, indices, threshold_index);
+        criterion.compute_children_impurity();
+        EXPECT_NEAR(criterion.compute_impurity_improvement(), 0.0, 1e-12);
+    }
+    EXPECT_DOUBLE_EQ(decisiontree::GradientCriterion::compute_leaf_value(
+        criterion.get_node_weighted_histogram()[0].data(), 0.0), 2.0);
+};
+
+TEST_F(GradientCriterionTest, TinyHessianTest) {
+    // a confidently misclassified sample has g ~ 1 and h at the floor 1e-15 of 
+    // the classifier, g^2 / h = 1e15 must not swamp the gain of the other samples
+    gradients[3] = 1.0;
+    hessians[3] = 1e-15;
+    const unsigned long num_samples = gradients.size();
+    decisiontree::GradientCriterion criterion(num_samples, gradients.data(), hessians.data(), 1.0);
+    criterion.compute_node_histogram(y, sample_indices, 0, num_samples);
+    criterion.compute_node_impurity();
+    criterion.init_children_histogram();
+    for (unsigned long threshold_index = 1; threshold_index < num_samples; ++threshold_index) {
+        criterion.update_children_histogram(y, sample_indices, threshold_index);
+        criterion.compute_children_impurity();
+        EXPECT_NEAR(criterion.compute_impurity_improvement(), 
+                    newton_gain(gradients, hessians, threshold_index, 1.0), 
+                    1e-12);
+    }
+};
+
+TEST_F(GradientCriterionTest, MissingImprovementTest) {
+    // samples [0:2] have missing values, the others are split at threshold_index
+    const unsigned long num_samples = gradients.size(), missing_value_index = 2;
+    decisiontree::GradientCriterion criterion(num_samples, gradients.data(), hessians.data(), 1.0);
+    criterion.compute_node_histogram(y, sample_indices, 0, num_samples);
+    criterion.compute_node_impurity();
+    criterion.compute_node_histogram_missing(y, sample_indices, missing_value_index);
+    criterion.compute_node_impurity_missing();
+    EXPECT_NEAR(criterion.compute_impurity_improvement_missing(), 
+                newton_gain(gradients, hessians, missing_value_index, 1.0), 
+                1e-12);
+
+    criterion.init_children_histogram_non_missing();
+    for (unsigned long threshold_index = missing_value_index + 1; threshold_index < num_samples; ++threshold_index) {
+        criterion.update_children_histogram(y, sample_indices, threshold_index);
+        criterion.compute_children_impurity_missing();
+        // the missing values going left is the split of the samples in order at threshold_index
+        EXPECT_NEAR(criterion.compute_left_impurity_improvement_missing(), 
+                    newton_gain(gradients, hessians, threshold_index, 1.0), 
+                    1e-12);
+        // and going right is the split of the samples moved after the others
+        std::vector<double> right_gradients(gradients.begin() + missing_value_index, gradients.end());
+        std::vector<double> right_hessians(hessians.begin() + missing_value_index, hessians.end());
+        right_gradients.insert(right_gradients.end(), gradients.begin(), gradients.begin() + missing_value_index);
+        right_hessians.insert(right_hessians.end(), hessians.begin(), hessians.begin() + missing_value_index);
+        EXPECT_NEAR(criterion.compute_right_impurity_improvement_missing(), 
+                    newton_gain(right_gradients, right_hessians, threshold_index - missing_value_index, 1.0), 
+                    1e-12);
+    }
+};
+
+} // namespace
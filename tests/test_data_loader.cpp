@@ -0,0 +1,134 @@
+#include <iostream>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "decision_tree/core/data_loader.hpp"
+#include "decision_tree/algorithm/decision_tree_classifier.hpp"
+#include "decision_tree/utility/synthetic_data.hpp"
+
+namespace {
+
+void write_file(const std::string& path, const std::string& text) {
+    std::ofstream os(path, std::ios::trunc);
+    os << text;
+}
+
+// column-major copy of a view, NaN compares unequal to itself, so the
+// values are compared by their bits
+std::vector<double> get_values(const decisiontree::DataView& X) {
+    std::vector<double> values;
+    for (unsigned long f = 0; f < X.get_num_features(); ++f) {
+        for (unsigned long i = 0; i < X.get_num_samples(); ++i) {
+            values.push_back(X(i, f));
+        }
+    }
+    return values;
+}
+
+bool same_values(const std::vector<double>& x, const std::vector<double>& y) {
+    return x.size() == y.size() && std::memcmp(x.data(), y.data(), x.size() * sizeof(double)) == 0;
+}
+
+TEST(DataLoaderTest, ReadCsvTest) {
+    std::string path = "test_data_loader.csv";
+    write_file(path, "width, species ,height\r\n"
+                     "1.5,\"virginica\",2\r\n"
+                     ",setosa,nan\r\n"
+                     "\r\n"
+                     "-3e2, versicolor ,NaN\r\n"
+                     "4,setosa,0.25");
+    std::vector<std::vector<std::string>> class_labels = {{"setosa", "versicolor", "virginica"}};
+    decisiontree::LabeledData data = decisiontree::LabeledData::read_csv(path, class_labels, {"species"});
+
+    EXPECT_EQ(data.get_num_samples(), 4);
+    EXPECT_THAT(data.get_feature_names(), ::testing::ElementsAre("width", "height"));
+    EXPECT_THAT(data.get_y(), ::testing::ElementsAre(2, 0, 1, 0));
+    decisiontree::DataView X = data.get_X();
+    EXPECT_TRUE(X.is_column_major());
+    EXPECT_EQ(X(0, 0), 1.5);
+    EXPECT_TRUE(std::isnan(X(1, 0)));
+    EXPECT_EQ(X(2, 0), -300.0);
+    EXPECT_EQ(X(3, 0), 4.0);
+    EXPECT_EQ(X(0, 1), 2.0);
+    EXPECT_TRUE(std::isnan(X(1, 1)));
+    EXPECT_TRUE(std::isnan(X(2, 1)));
+    EXPECT_EQ(X(3, 1), 0.25);
+
+    // unknown labels, bad values and ragged rows are rejected
+    write_file(path, "a,y\n1,setosa\n2,rose\n");
+    EXPECT_THROW(decisiontree::LabeledData::read_csv(path, class_labels), std::runtime_error);
+    write_file(path, "a,y\n1x,setosa\n");
+    EXPECT_THROW(decisiontree::LabeledData::read_csv(path, class_labels), std::runtime_error);
+    write_file(path, "a,b,y\n1,setosa\n");
+    EXPECT_THROW(decisiontree::LabeledData::read_csv(path, class_labels), std::runtime_error);
+    write_file(path, "a,y\n1,2,setosa\n");
+    EXPECT_THROW(decisiontree::LabeledData::read_csv(path, class_labels), std::runtime_error);
+    EXPECT_THROW(decisiontree::LabeledData::read_csv(path, class_labels, {"z"}), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(DataLoaderTest, ReadSyntheticCsvTest) {
+    std::string path = "test_data_loader_synthetic.csv";
+    unsigned long num_samples = 3000, num_features = 4, num_outputs = 2;
+    decisiontree::SyntheticDataGenerator generator(num_samples, num_features, 3, num_outputs, "hyperplane", 0.1, 0.1, 7);
+    generator.write_csv(path, 1000);
+    generator.reset();
+    std::vector<double> X;
+    std::vector<long> y;
+    generator.generate(X, y);
+    decisiontree::DataView expected_X(X.data(), num_samples, num_features);
+
+    // small chunks parsed by several threads, by default as many as the 
+    // hardware supports, give the same data as one chunk
+    std::vector<std::vector<std::string>> class_labels(num_outputs, generator.get_class_labels()[0]);
+    for (unsigned long num_threads : {1, 4, 0}) {
+        for (std::size_t chunk_size : {std::size_t(1000), decisiontree::CSV_CHUNK_SIZE}) {
+            decisiontree::LabeledData data = decisiontree::LabeledData::read_csv(path,
+                                                                                 class_labels,
+                                                                                 {},
+                                                                                 num_threads,
+                                                                                 ',',
+                                                                                 chunk_size);
+            EXPECT_EQ(data.get_num_samples(), num_samples);
+            EXPECT_EQ(data.get_feature_names(), generator.get_feature_names());
+            EXPECT_TRUE(same_values(get_values(data.get_X()), get_values(expected_X)));
+            EXPECT_EQ(data.get_y(), y);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST(DataLoaderTest, SaveLoadTest) {
+    std::string csv_path = "test_data_loader_save.csv";
+    std::string path = "test_data_loader.bin";
+    unsigned long num_samples = 2000, num_features = 5;
+    decisiontree::SyntheticDataGenerator generator(num_samples, num_features, 3, 1, "gaussian_mixture", 0.05, 0.0, 3);
+    generator.write_csv(csv_path);
+    decisiontree::LabeledData data = decisiontree::LabeledData::read_csv(csv_path, generator.get_class_labels());
+    data.save(path);
+
+    decisiontree::LabeledData loaded = decisiontree::LabeledData::load(path);
+    EXPECT_EQ(loaded.get_num_samples(), num_samples);
+    EXPECT_EQ(loaded.get_feature_names(), data.get_feature_names());
+    EXPECT_EQ(loaded.get_class_labels(), data.get_class_labels());
+    EXPECT_TRUE(same_values(get_values(loaded.get_X()), get_values(data.get_X())));
+    EXPECT_EQ(loaded.get_y(), data.get_y());
+
+    // the loaded dataset fits the classifier like the parsed one
+    decisiontree::DecisionTreeClassifier clf(data.get_feature_names(), data.get_class_labels(), 0, 6);
+    clf.fit(data.get_X(), data.get_y());
+    decisiontree::DecisionTreeClassifier loaded_clf(loaded.get_feature_names(), loaded.get_class_labels(), 0, 6);
+    loaded_clf.fit(loaded.get_X(), loaded.get_y());
+    std::vector<double> proba(num_samples * 3), loaded_proba(num_samples * 3);
+    clf.predict_proba(data.get_X(), proba.data());
+    loaded_clf.predict_proba(loaded.get_X(), loaded_proba.data());
+    EXPECT_EQ(proba, loaded_proba);
+
+    // another kind of binary file is rejected
+    clf.save(path);
+    EXPECT_THROW(decisiontree::LabeledData::load(path), std::runtime_error);
+    std::remove(csv_path.c_str());
+    std::remove(path.c_str());
+}
+
+} // namespace
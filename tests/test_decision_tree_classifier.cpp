@@ -0,0 +1,248 @@
+#include <iostream>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "decision_tree/algorithm/decision_tree_classifier.hpp"
+#include "make_classification.hpp"
+
+namespace {
+
+TEST(DecisionTreeClassifierTest, SaveLoadTest) {
+    std::vector<std::string> feature_names = {"f0", "f1", "f2", "f3"};
+    std::vector<std::vector<std::string>> class_labels = {{"low", "mid", "high"}};
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(1000, feature_names.size(), 3, X, y, 3);
+
+    decisiontree::DecisionTreeClassifier clf(feature_names, class_labels, 0, 6);
+    EXPECT_THROW(clf.predict(X), std::runtime_error);
+    clf.fit(X, y);
+
+    std::string path = ::testing::TempDir() + "decision_tree_classifier.bin";
+    clf.save(path);
+    const decisiontree::DecisionTreeClassifier loaded_clf = decisiontree::DecisionTreeClassifier::load(path);
+
+    EXPECT_EQ(loaded_clf.get_tree().get_node_count(), clf.get_tree().get_node_count());
+    EXPECT_THAT(loaded_clf.predict_proba(X), ::testing::ContainerEq(clf.predict_proba(X)));
+    EXPECT_THAT(loaded_clf.predict(X), ::testing::ContainerEq(clf.predict(X)));
+    EXPECT_THAT(loaded_clf.compute_feature_importance(), 
+                ::testing::ContainerEq(clf.compute_feature_importance()));
+
+    // the loaded tree stays mapped as long as a view of it is alive
+    decisiontree::TreeView tree = decisiontree::DecisionTreeClassifier::load(path).get_tree();
+    std::vector<long> labels(y.size());
+    tree.predict(X.data(), y.size(), labels.data());
+    EXPECT_THAT(labels, ::testing::ContainerEq(clf.predict(X)));
+
+    std::remove(path.c_str());
+};
+
+TEST(DecisionTreeClassifierTest, LoadInvalidFileTest) {
+    std::vector<std::string> feature_names = {"f0", "f1", "f2", "f3"};
+    std::vector<std::vector<std::string>> class_labels = {{"low", "mid", "high"}};
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(200, feature_names.size(), 3, X, y, 3);
+
+    decisiontree::DecisionTreeClassifier clf(feature_names, class_labels);
+    clf.fit(X, y);
+    std::string path = ::testing::TempDir() + "decision_tree_classifier_invalid.bin";
+    clf.save(path);
+
+    // a truncated file
+    std::ifstream is(path, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    is.close();
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(content.data(), content.size() / 2);
+    EXPECT_THROW(decisiontree::DecisionTreeClassifier::load(path), std::runtime_error);
+
+    // a tree file is not a classifier file
+    clf.get_tree().save(path);
+    EXPECT_THROW(decisiontree::DecisionTreeClassifier::load(path), std::runtime_error);
+    EXPECT_EQ(decisiontree::TreeView::load(path).get_node_count(), clf.get_tree().get_node_count());
+
+    EXPECT_THROW(decisiontree::DecisionTreeClassifier::load(path + ".missing"), std::runtime_error);
+    std::remove(path.c_str());
+};
+
+TEST(DecisionTreeClassifierTest, DataLayoutTest) {
+    std::vector<std::string> feature_names = {"f0", "f1", "f2", "f3"};
+    std::vector<std::vector<std::string>> class_labels = {{"low", "mid", "high"}};
+    unsigned long num_samples = 500, num_features = feature_names.size();
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(num_samples, num_features, 3, X, y, 3);
+
+    // the same matrix in column-major layout, and as a strided slice of a 
+    // wider row-major matrix with an extra column in front
+    std::vector<double> X_column(num_samples * num_features), X_wide(num_samples * (num_features + 1), 0.0);
+    for (unsigned long i = 0; i < num_samples; ++i) {
+        for (unsigned long f = 0; f < num_features; ++f) {
+            X_column[f * num_samples + i] = X[i * num_features + f];
+            X_wide[i * (num_features + 1) + f + 1] = X[i * num_features + f];
+        }
+    }
+    std::vector<decisiontree::DataView> views = {
+        decisiontree::DataView(X.data(), num_samples, num_features), 
+        decisiontree::DataView(X_column.data(), num_samples, num_features, decisiontree::DataLayout::column_major), 
+        decisiontree::DataView(X_wide.data() + 1, num_samples, num_features, num_features + 1, 1)
+    };
+
+    decisiontree::DecisionTreeClassifier clf(feature_names, class_labels, 0, 6);
+    clf.fit(X, y);
+    std::vector<long> expect = clf.predict(X);
+    for (const decisiontree::DataView& view : views) {
+        decisiontree::DecisionTreeClassifier view_clf(feature_names, class_labels, 0, 6);
+        view_clf.fit(view, y);
+        EXPECT_EQ(view_clf.get_tree().get_node_count(), clf.get_tree().get_node_count());
+        EXPECT_THAT(view_clf.compute_feature_importance(), 
+                    ::testing::ContainerEq(clf.compute_feature_importance()));
+
+        std::vector<long> labels(num_samples);
+        clf.predict(view, labels.data());
+        EXPECT_THAT(labels, ::testing::ContainerEq(expect));
+    }
+
+    decisiontree::DataView wrong_view(X.data(), num_samples, num_features - 1);
+    EXPECT_THROW(clf.fit(wrong_view, y), std::invalid_argument);
+    std::vector<long> labels(num_samples);
+    EXPECT_THROW(clf.predict(wrong_view, labels.data()), std::invalid_argument);
+};
+
+TEST(DecisionTreeClassifierTest, FloatFeatureTest) {
+    std::vector<std::string> feature_names = {"f0", "f1", "f2", "f3"};
+    std::vector<std::vector<std::string>> class_labels = {{"low", "mid", "high"}};
+    unsigned long num_samples = 500, num_features = feature_names.size();
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(num_samples, num_features, 3, X, y, 3);
+
+    // the double model is fitted on the values rounded to float, so that 
+    // both models see the same order of the samples on each feature
+    std::vector<float> X_float(X.begin(), X.end());
+    std::vector<std::uint32_t> y_uint32(y.begin(), y.end());
+    X.assign(X_float.begin(), X_float.end());
+
+    decisiontree::DecisionTreeClassifier clf(feature_names, class_labels, 0, 6);
+    clf.fit(X, y);
+    std::vector<long> expect = clf.predict(X);
+
+    decisiontree::BasicDecisionTreeClassifier<float, std::uint32_t, std::uint32_t> float_clf(
+        feature_names, class_labels, 0, 6
+    );
+    float_clf.fit(X_float, y_uint32);
+    EXPECT_EQ(float_clf.get_tree().get_node_count(), clf.get_tree().get_node_count());
+    EXPECT_THAT(float_clf.compute_feature_importance(), 
+                ::testing::ContainerEq(clf.compute_feature_importance()));
+
+    std::vector<std::uint32_t> labels = float_clf.predict(X_float);
+    EXPECT_THAT(std::vector<long>(labels.begin(), labels.end()), ::testing::ContainerEq(expect));
+
+    std::vector<double> proba = float_clf.predict_proba(X_float);
+    EXPECT_THAT(proba, ::testing::ContainerEq(clf.predict_proba(X)));
+};
+
+TEST(DecisionTreeClassifierTest, AdjacentFloatThresholdTest) {
+    // the midpoint of two adjacent floats rounds to one of them, the 
+    // threshold must still send the lower value left and the upper right
+    std::vector<std::string> feature_names = {"f0"};
+    std::vector<std::vector<std::string>> class_labels = {{"lower", "upper"}};
+    float lower = std::nextafter(1000.0f, 2000.0f);
+    float upper = std::nextafter(lower, 2000.0f);
+    std::vector<float> X;
+    std::vector<std::uint32_t> y;
+    for (unsigned long i = 0; i < 20; ++i) {
+        X.push_back(i < 10 ? lower : upper);
+        y.push_back(i < 10 ? 0 : 1);
+    }
+
+    for (std::string split_policy : {"best", "hist"}) {
+        decisiontree::BasicDecisionTreeClassifier<float, std::uint32_t, std::uint32_t> clf(
+            feature_names, class_labels, 0, 4, -1, 2, 1, 0.0, true, "gini", split_policy
+        );
+        clf.fit(X, y);
+        EXPECT_EQ(clf.get_tree().get_node_count(), 3);
+        EXPECT_THAT(clf.predict(X), ::testing::ContainerEq(y));
+    }
+};
+
+TEST(DecisionTreeClassifierTest, ProfileDisabledTest) {
+    std::vector<std::string> feature_names = {"f0", "f1", "f2", "f3"};
+    std::vector<std::vector<std::string>> class_labels = {{"low", "mid", "high"}};
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(1000, feature_names.size(), 3, X, y, 3);
+
+    // without DECISIONTREE_PROFILE the profile is compiled out and stays empty
+    decisiontree::DecisionTreeClassifier clf(feature_names, class_labels, 0, 6);
+    clf.fit(X, y);
+    EXPECT_FALSE(decisiontree::PROFILE_ENABLED);
+    EXPECT_TRUE(clf.get_profile().num_nodes_per_depth.empty());
+    EXPECT_EQ(clf.get_profile().num_thresholds_evaluated, 0);
+    EXPECT_EQ(clf.get_profile().build_time, 0.0);
+};
+
+TEST(DecisionTreeClassifierTest, CategoricalTest) {
+    // the class of a sample is a function of the category of f0 which 
+    // no threshold on the category codes can separate
+    std::vector<std::string> feature_names = {"f0", "f1"};
+    std::vector<std::vector<std::string>> class_labels = {{"a", "b", "c"}};
+    unsigned long num_samples = 2000, num_categories = 100;
+    std::mt19937 engine(5);
+    std::uniform_int_distribution<unsigned long> category_distribution(0, num_categories - 1);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<double> X(num_samples * 2);
+    std::vector<long> y(num_samples);
+    for (unsigned long i = 0; i < num_samples; ++i) {
+        unsigned long category = category_distribution(engine);
+        X[i * 2] = static_cast<double>(category);
+        X[i * 2 + 1] = normal(engine);
+        y[i] = (category * 37 + 11) % 97 % 3;
+        if (i % 50 == 0) {
+            X[i * 2] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    auto compute_accuracy = [&y](const std::vector<long>& labels) {
+        double num_correct = 0.0;
+        for (unsigned long i = 0; i < y.size(); ++i) {
+            num_correct += (labels[i] == y[i]);
+        }
+        return num_correct / y.size();
+    };
+
+    // 2 levels of category sets separate the 3 classes, up to the missing values
+    for (std::string split_policy : {"best", "random", "hist"}) {
+        decisiontree::DecisionTreeClassifier clf(feature_names, class_labels, 0, 2, -1, 2, 1, 0.0, 
+                                                 true, "gini", split_policy, nullptr, false, 1, -1, 
+                                                 {true, false});
+        clf.fit(X, y);
+        EXPECT_GE(compute_accuracy(clf.predict(X)), 0.97);
+    }
+    decisiontree::DecisionTreeClassifier numerical_clf(feature_names, class_labels, 0, 2);
+    numerical_clf.fit(X, y);
+    EXPECT_LT(compute_accuracy(numerical_clf.predict(X)), 0.8);
+
+    // the category sets are saved with the tree
+    decisiontree::DecisionTreeClassifier clf(feature_names, class_labels, 0, 4, -1, 2, 1, 0.0, 
+                                             true, "entropy", "best", nullptr, false, 1, -1, 
+                                             {true, false});
+    clf.fit(X, y);
+    std::string path = ::testing::TempDir() + "decision_tree_classifier_categorical.bin";
+    clf.save(path);
+    const decisiontree::DecisionTreeClassifier loaded_clf = decisiontree::DecisionTreeClassifier::load(path);
+    EXPECT_THAT(loaded_clf.predict_proba(X), ::testing::ContainerEq(clf.predict_proba(X)));
+    std::remove(path.c_str());
+
+    // category codes must be integers in [0, MAX_NUM_CATEGORIES)
+    for (double value : {-1.0, 2.5, static_cast<double>(MAX_NUM_CATEGORIES)}) {
+        std::vector<double> invalid_X = X;
+        invalid_X[2] = value;
+        EXPECT_THROW(clf.fit(invalid_X, y), std::invalid_argument);
+    }
+    decisiontree::DecisionTreeClassifier invalid_clf(feature_names, class_labels, 0, 4, -1, 2, 1, 0.0, 
+                                                     true, "gini", "best", nullptr, false, 1, -1, 
+                                                     {true});
+    EXPECT_THROW(invalid_clf.fit(X, y), std::invalid_argument);
+};
+
+} // namespace
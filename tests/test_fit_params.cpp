@@ -0,0 +1,45 @@
+#include <iostream>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "decision_tree/algorithm/fit_params.hpp"
+
+namespace {
+
+TEST(FitParamsTest, TreeParamsTest) {
+    // -1 gives the default number of features, a larger one is capped
+    decisiontree::TreeParams params = decisiontree::check_tree_params(4, 2, 1, -1, 10, 3);
+    EXPECT_EQ(params.max_depth, 4);
+    EXPECT_EQ(params.min_samples_split, 2);
+    EXPECT_EQ(params.min_samples_leaf, 1);
+    EXPECT_EQ(params.max_num_features, 3);
+    EXPECT_EQ(decisiontree::check_tree_params(4, 2, 1, 20, 10, 3).max_num_features, 10);
+
+    EXPECT_THROW(decisiontree::check_tree_params(-1, 2, 1, -1, 10, 3), std::invalid_argument);
+    EXPECT_THROW(decisiontree::check_tree_params(4, -1, 1, -1, 10, 3), std::invalid_argument);
+    EXPECT_THROW(decisiontree::check_tree_params(4, 2, -1, -1, 10, 3), std::invalid_argument);
+    EXPECT_THROW(decisiontree::check_tree_params(4, 2, 1, 0, 10, 3), std::invalid_argument);
+    EXPECT_THROW(decisiontree::check_num_threads(0), std::invalid_argument);
+    EXPECT_THROW(decisiontree::check_criterion_clf("gradient"), std::invalid_argument);
+};
+
+TEST(FitParamsTest, ClassWeightParamsTest) {
+    // 2 outputs, the first of 2 classes, the second of 3 classes
+    std::vector<long> y = {0, 0, 0, 1, 1, 2, 0, 2};
+    std::vector<unsigned long> num_classes_list = {2, 3};
+    decisiontree::ClassWeightParams params = decisiontree::compute_class_weight_params(
+        y, 2, num_classes_list, 3, true, nullptr, 0.5
+    );
+    EXPECT_THAT(params.class_weight, ::testing::ElementsAre(4.0 / 3 / 2, 4.0 / 1 / 2, 1.0,
+                                                            4.0 / 1 / 3, 4.0 / 1 / 3, 4.0 / 2 / 3));
+    EXPECT_EQ(params.min_weight_leaf, 2);
+
+    auto class_weight_ptr = std::make_shared<std::vector<double>>(std::vector<double>{1.0, 2.0, 0.0, 3.0, 4.0, 6.0});
+    params = decisiontree::compute_class_weight_params(y, 2, num_classes_list, 3, false, class_weight_ptr, 0.5);
+    EXPECT_EQ(params.class_weight, *class_weight_ptr);
+    EXPECT_EQ(params.min_weight_leaf, 8);
+    EXPECT_THROW(decisiontree::compute_class_weight_params(y, 2, num_classes_list, 3, false, nullptr, 0.5),
+                 std::invalid_argument);
+};
+
+} // namespace
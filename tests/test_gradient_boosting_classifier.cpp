@@ -0,0 +1,150 @@
+#include <iostream>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "decision_tree/algorithm/gradient_boosting_classifier.hpp"
+#include "make_classification.hpp"
+
+namespace {
+
+auto log_loss = [](const std::vector<double>& proba, 
+                   const std::vector<long>& y, 
+                   unsigned long num_classes) {
+    double loss = 0.0;
+    for (unsigned long i = 0; i < y.size(); ++i) {
+        loss -= std::log(std::max(proba[i * num_classes + y[i]], 1e-15));
+    }
+    return loss / y.size();
+};
+
+std::vector<std::string> feature_names = {"f0", "f1", "f2", "f3", "f4"};
+
+TEST(GradientBoostingClassifierTest, BinaryTest) {
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(500, feature_names.size(), 2, X, y, 7);
+    std::vector<std::vector<std::string>> class_labels = {{"neg", "pos"}};
+
+    // the training loss goes down with the number of rounds
+    double loss = std::log(2.0);
+    for (int num_estimators : {1, 10, 50}) {
+        decisiontree::GradientBoostingClassifier clf(feature_names, class_labels, num_estimators);
+        clf.fit(X, y);
+        EXPECT_EQ(clf.get_num_trees(), num_estimators);
+        double rounds_loss = log_loss(clf.predict_proba(X), y, 2);
+        EXPECT_LT(rounds_loss, loss);
+        loss = rounds_loss;
+    }
+
+    // 100 rounds fit about 94% of the samples, well above the bound
+    decisiontree::GradientBoostingClassifier clf(feature_names, class_labels, 100);
+    clf.fit(X, y);
+    std::vector<double> proba = clf.predict_proba(X);
+    std::vector<double> scores = clf.decision_function(X);
+    std::vector<long> labels = clf.predict(X);
+    unsigned long num_correct = 0;
+    for (unsigned long i = 0; i < y.size(); ++i) {
+        EXPECT_NEAR(proba[i * 2] + proba[i * 2 + 1], 1.0, 1e-12);
+        EXPECT_NEAR(proba[i * 2 + 1], 1.0 / (1.0 + std::exp(-scores[i])), 1e-12);
+        EXPECT_EQ(labels[i], proba[i * 2 + 1] > proba[i * 2] ? 1 : 0);
+        num_correct += (labels[i] == y[i]);
+    }
+    EXPECT_GT(num_correct, 0.9 * y.size());
+
+    // the informative features are the most important
+    std::vector<double> importances = clf.compute_feature_importance();
+    EXPECT_NEAR(std::accumulate(importances.begin(), importances.end(), 0.0), 1.0, 1e-9);
+    EXPECT_GT(importances[0], importances[3]);
+    EXPECT_GT(importances[0], importances[4]);
+};
+
+TEST(GradientBoostingClassifierTest, MinSplitGainTest) {
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(500, feature_names.size(), 2, X, y, 7);
+    std::vector<std::vector<std::string>> class_labels = {{"neg", "pos"}};
+
+    // the gain of a split is not scaled by the number of samples, the main 
+    // splits of 500 samples gain more than 1
+    decisiontree::GradientBoostingClassifier clf(feature_names, class_labels, 10, 0.1, 3, 0, 
+                                                 -1, 2, 1, 1.0, 1.0);
+    clf.fit(X, y);
+    double prior = std::accumulate(y.begin(), y.end(), 0.0) / y.size();
+    double prior_loss = -(prior * std::log(prior) + (1.0 - prior) * std::log(1.0 - prior));
+    EXPECT_LT(log_loss(clf.predict_proba(X), y, 2), prior_loss - 0.05);
+
+    // no split has the gain, all the samples get the prior
+    decisiontree::GradientBoostingClassifier stump_clf(feature_names, class_labels, 10, 0.1, 3, 0, 
+                                                       -1, 2, 1, 1.0, 1e9);
+    stump_clf.fit(X, y);
+    std::vector<double> proba = stump_clf.predict_proba(X);
+    for (unsigned long i = 0; i < y.size(); ++i) {
+        EXPECT_NEAR(proba[i * 2 + 1], prior, 1e-12);
+    }
+};
+
+TEST(GradientBoostingClassifierTest, MulticlassTest) {
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(500, feature_names.size(), 3, X, y, 7);
+    std::vector<std::vector<std::string>> class_labels = {{"low", "mid", "high"}};
+
+    // one tree per class and per round
+    decisiontree::GradientBoostingClassifier clf(feature_names, class_labels, 30, 0.2);
+    clf.fit(X, y);
+    EXPECT_EQ(clf.get_num_trees(), 90);
+
+    std::vector<double> proba = clf.predict_proba(X);
+    std::vector<long> labels = clf.predict(X);
+    for (unsigned long i = 0; i < y.size(); ++i) {
+        EXPECT_NEAR(proba[i * 3] + proba[i * 3 + 1] + proba[i * 3 + 2], 1.0, 1e-12);
+        long label = std::max_element(&proba[i * 3], &proba[i * 3 + 3]) - &proba[i * 3];
+        EXPECT_EQ(labels[i], label);
+    }
+    EXPECT_LT(log_loss(proba, y, 3), 0.5 * std::log(3.0));
+
+    // the model does not depend on the number of threads
+    for (int num_threads : {2, -1}) {
+        decisiontree::GradientBoostingClassifier threads_clf(feature_names, class_labels, 30, 0.2, 3, 0, 
+                                                             -1, 2, 1, 1.0, 0.0, "hist", num_threads);
+        threads_clf.fit(X, y);
+        EXPECT_THAT(threads_clf.predict_proba(X), ::testing::ContainerEq(proba));
+    }
+
+    // exact thresholds fit as well as the bins
+    decisiontree::GradientBoostingClassifier best_clf(feature_names, class_labels, 30, 0.2, 3, 0, 
+                                                      -1, 2, 1, 1.0, 0.0, "best");
+    best_clf.fit(X, y);
+    EXPECT_LT(log_loss(best_clf.predict_proba(X), y, 3), 0.5 * std::log(3.0));
+};
+
+TEST(GradientBoostingClassifierTest, InvalidParamTest) {
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(100, feature_names.size(), 2, X, y, 7);
+    std::vector<std::vector<std::string>> class_labels = {{"neg", "pos"}};
+
+    decisiontree::GradientBoostingClassifier clf(feature_names, class_labels);
+    EXPECT_THROW(clf.predict(X), std::runtime_error);
+
+    decisiontree::GradientBoostingClassifier zero_clf(feature_names, class_labels, 0);
+    EXPECT_THROW(zero_clf.fit(X, y), std::invalid_argument);
+
+    decisiontree::GradientBoostingClassifier rate_clf(feature_names, class_labels, 10, 0.0);
+    EXPECT_THROW(rate_clf.fit(X, y), std::invalid_argument);
+
+    decisiontree::GradientBoostingClassifier gain_clf(feature_names, class_labels, 10, 0.1, 3, 0, 
+                                                      -1, 2, 1, 1.0, -1.0);
+    EXPECT_THROW(gain_clf.fit(X, y), std::invalid_argument);
+
+    decisiontree::GradientBoostingClassifier output_clf(feature_names, {{"neg", "pos"}, {"a", "b"}});
+    EXPECT_THROW(output_clf.fit(X, y), std::invalid_argument);
+
+    clf.fit(X, y);
+    std::vector<double> wrong_X(100 * (feature_names.size() - 1), 0.0);
+    std::vector<long> labels(100);
+    decisiontree::DataView wrong_view(wrong_X.data(), 100, feature_names.size() - 1);
+    EXPECT_THROW(clf.predict(wrong_view, labels.data()), std::invalid_argument);
+};
+
+} // namespace
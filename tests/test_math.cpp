@@ -13,4 +13,57 @@ TEST(SortTest, Sort2VectorsByFirstVector){
     EXPECT_THAT(max_index, 0);
 };
 
+TEST(ReduceTest, SumAndSquareSumTest) {
+    // the size is not a multiple of the vector size, so the tail is reduced too
+    std::vector<double> x(1003), y(1003);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<double>(i % 17);
+        y[i] = 0.25 * static_cast<double>(i % 5);
+    }
+    double x_sum, x_square_sum, y_sum, y_square_sum;
+    decisiontree::sum_and_square_sum(x.data(), y.data(), x.size(), 
+                                     x_sum, x_square_sum, y_sum, y_square_sum);
+
+    double expect_x_sum = 0.0, expect_x_square_sum = 0.0, expect_y_sum = 0.0, expect_y_square_sum = 0.0;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        expect_x_sum += x[i];
+        expect_x_square_sum += x[i] * x[i];
+        expect_y_sum += y[i];
+        expect_y_square_sum += y[i] * y[i];
+    }
+    EXPECT_NEAR(x_sum, expect_x_sum, 1e-12 * std::abs(expect_x_sum));
+    EXPECT_NEAR(x_square_sum, expect_x_square_sum, 1e-12 * std::abs(expect_x_square_sum));
+    EXPECT_NEAR(y_sum, expect_y_sum, 1e-12 * std::abs(expect_y_sum));
+    EXPECT_NEAR(y_square_sum, expect_y_square_sum, 1e-12 * std::abs(expect_y_square_sum));
+};
+
+TEST(ReduceTest, SumAndEntropySumTest) {
+    // zero and tiny negative counts are skipped in the entropy sum, 
+    // the vectorized sums are reordered so they are compared with a tolerance
+    std::vector<double> x(1003), y(1003);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = (i % 7 == 0) ? 0.0 : 0.37 * static_cast<double>(i);
+        y[i] = (i % 11 == 0) ? -1e-12 : 1.0 / static_cast<double>(i + 1);
+    }
+    double x_sum, x_entropy_sum, y_sum, y_entropy_sum;
+    decisiontree::sum_and_entropy_sum(x.data(), y.data(), x.size(), 
+                                      x_sum, x_entropy_sum, y_sum, y_entropy_sum);
+
+    double expect_x_sum = 0.0, expect_x_entropy_sum = 0.0, expect_y_sum = 0.0, expect_y_entropy_sum = 0.0;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        expect_x_sum += x[i];
+        expect_y_sum += y[i];
+        if (x[i] > 0.0) {
+            expect_x_entropy_sum += x[i] * std::log2(x[i]);
+        }
+        if (y[i] > 0.0) {
+            expect_y_entropy_sum += y[i] * std::log2(y[i]);
+        }
+    }
+    EXPECT_NEAR(x_sum, expect_x_sum, 1e-12 * std::abs(expect_x_sum));
+    EXPECT_NEAR(x_entropy_sum, expect_x_entropy_sum, 1e-12 * std::abs(expect_x_entropy_sum));
+    EXPECT_NEAR(y_sum, expect_y_sum, 1e-12 * std::abs(expect_y_sum));
+    EXPECT_NEAR(y_entropy_sum, expect_y_entropy_sum, 1e-12 * std::abs(expect_y_entropy_sum));
+};
+
 }
\ No newline at end of file
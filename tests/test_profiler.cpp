@@ -0,0 +1,92 @@
+#include <iostream>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "decision_tree/algorithm/decision_tree_classifier.hpp"
+#include "decision_tree/utility/synthetic_data.hpp"
+
+namespace {
+
+TEST(ProfilerTest, MergeTest) {
+    decisiontree::TrainingProfile profile, other;
+    profile.add_node(0);
+    other.add_node(0);
+    other.add_node(2);
+    other.sort_time = 1.5;
+    other.impurity_time = 0.5;
+    other.num_thresholds_evaluated = 7;
+    profile.merge(other);
+    EXPECT_THAT(profile.num_nodes_per_depth, ::testing::ElementsAre(2, 0, 1));
+    EXPECT_DOUBLE_EQ(profile.sort_time, 1.5);
+    EXPECT_DOUBLE_EQ(profile.impurity_time, 0.5);
+    EXPECT_EQ(profile.num_thresholds_evaluated, 7);
+
+    {
+        decisiontree::ProfileTimer timer(profile.build_time);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EXPECT_GT(profile.build_time, 0.001);
+
+    // one threshold in PROFILE_SAMPLING_PERIOD is timed, scaled by the period
+    {
+        decisiontree::SampledPhaseTimer sampled_timer(decisiontree::PROFILE_SAMPLING_PERIOD);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        sampled_timer.lap(profile.histogram_update_time);
+        decisiontree::SampledPhaseTimer skipped_timer(decisiontree::PROFILE_SAMPLING_PERIOD + 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        skipped_timer.lap(profile.sort_time);
+    }
+    EXPECT_GT(profile.histogram_update_time, 0.002 * decisiontree::PROFILE_SAMPLING_PERIOD);
+    EXPECT_DOUBLE_EQ(profile.sort_time, 1.5);
+
+    profile.clear();
+    EXPECT_TRUE(profile.num_nodes_per_depth.empty());
+    EXPECT_EQ(profile.build_time, 0.0);
+}
+
+TEST(ProfilerTest, FitTest) {
+    EXPECT_TRUE(decisiontree::PROFILE_ENABLED);
+    unsigned long num_samples = 2000, num_features = 5;
+    decisiontree::SyntheticDataGenerator generator(num_samples, num_features, 3, 1, "hyperplane", 0.05, 0.0, 0);
+    std::vector<double> X;
+    std::vector<long> y;
+    generator.generate(X, y);
+
+    for (std::string split_policy : {"best", "hist"}) {
+        decisiontree::DecisionTreeClassifier clf(generator.get_feature_names(), 
+                                                 generator.get_class_labels(), 
+                                                 0, 6, -1, 2, 1, 0.0, true, 
+                                                 "gini", split_policy);
+        clf.fit(X, y);
+        const decisiontree::TrainingProfile& profile = clf.get_profile();
+
+        // the nodes per depth add up to the nodes of the tree
+        ASSERT_FALSE(profile.num_nodes_per_depth.empty());
+        EXPECT_EQ(profile.num_nodes_per_depth[0], 1);
+        EXPECT_LE(profile.num_nodes_per_depth.size(), 7);
+        EXPECT_EQ(std::accumulate(profile.num_nodes_per_depth.begin(), profile.num_nodes_per_depth.end(), 0UL), 
+                  clf.get_tree().get_node_count());
+
+        // the root alone reads all samples of all features
+        EXPECT_GE(profile.num_samples_touched, num_samples * num_features);
+        EXPECT_GT(profile.num_thresholds_evaluated, 0);
+        EXPECT_GT(profile.build_time, 0.0);
+        EXPECT_GT(profile.missing_partition_time, 0.0);
+        EXPECT_GT(profile.histogram_update_time, 0.0);
+        EXPECT_GT(profile.impurity_time, 0.0);
+        if (split_policy == "best") {
+            EXPECT_GT(profile.gather_time, 0.0);
+            EXPECT_GT(profile.sort_time, 0.0);
+        }
+        else {
+            EXPECT_GT(profile.init_features_time, 0.0);
+        }
+
+        // a new fit starts a new profile
+        NumSamplesType num_thresholds_evaluated = profile.num_thresholds_evaluated;
+        clf.fit(X, y);
+        EXPECT_EQ(clf.get_profile().num_thresholds_evaluated, num_thresholds_evaluated);
+    }
+}
+
+} // namespace
@@ -0,0 +1,112 @@
+#include <iostream>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "decision_tree/algorithm/decision_tree_classifier.hpp"
+#include "decision_tree/algorithm/random_forest_classifier.hpp"
+#include "make_classification.hpp"
+
+namespace {
+
+std::vector<std::string> feature_names = {"f0", "f1", "f2", "f3", "f4"};
+std::vector<std::vector<std::string>> class_labels = {{"low", "mid", "high"}};
+
+TEST(RandomForestClassifierTest, NumThreadsTest) {
+    unsigned long num_samples = 400;
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(num_samples, feature_names.size(), 3, X, y, 5);
+
+    decisiontree::RandomForestClassifier clf(feature_names, class_labels, 20, 1, 5);
+    clf.fit(X, y);
+    EXPECT_EQ(clf.get_num_trees(), 20);
+    std::vector<double> proba = clf.predict_proba(X);
+
+    // the forest does not depend on the number of threads which grow it
+    for (int num_threads : {2, 4, -1}) {
+        decisiontree::RandomForestClassifier threads_clf(feature_names, class_labels, 20, 1, 5,
+                                                         -1, 2, 1, 0.0, true, "gini", "best",
+                                                         nullptr, true, num_threads);
+        threads_clf.fit(X, y);
+        EXPECT_THAT(threads_clf.predict_proba(X), ::testing::ContainerEq(proba));
+        EXPECT_THAT(threads_clf.compute_feature_importance(),
+                    ::testing::ContainerEq(clf.compute_feature_importance()));
+    }
+
+    // probabilities of each sample sum up to 1, labels are their argmax
+    std::vector<long> labels = clf.predict(X);
+    for (unsigned long i = 0; i < num_samples; ++i) {
+        double sum = proba[i * 3] + proba[i * 3 + 1] + proba[i * 3 + 2];
+        EXPECT_NEAR(sum, 1.0, 1e-12);
+        long label = std::max_element(&proba[i * 3], &proba[i * 3 + 3]) - &proba[i * 3];
+        EXPECT_EQ(labels[i], label);
+    }
+
+    // trees grow on different bootstrap samples
+    std::vector<double> proba_0, proba_1;
+    clf.get_tree(0).predict_proba(X, num_samples, proba_0);
+    clf.get_tree(1).predict_proba(X, num_samples, proba_1);
+    EXPECT_NE(proba_0, proba_1);
+};
+
+TEST(RandomForestClassifierTest, HistNumThreadsTest) {
+    unsigned long num_samples = 400;
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(num_samples, feature_names.size(), 3, X, y, 5);
+
+    // the trees grown concurrently read the bins computed once for the forest
+    std::vector<std::vector<double>> probas;
+    for (int num_threads : {1, 4}) {
+        decisiontree::RandomForestClassifier clf(feature_names, class_labels, 10, 1, 5,
+                                                 -1, 2, 1, 0.0, true, "gini", "hist",
+                                                 nullptr, true, num_threads);
+        clf.fit(X, y);
+        probas.push_back(clf.predict_proba(X));
+    }
+    EXPECT_THAT(probas[1], ::testing::ContainerEq(probas[0]));
+};
+
+TEST(RandomForestClassifierTest, SingleTreeTest) {
+    unsigned long num_samples = 400;
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(num_samples, feature_names.size(), 3, X, y, 5);
+
+    // without bootstrap and with all the features, the tree of the
+    // forest is the tree of a single classifier
+    decisiontree::RandomForestClassifier clf(feature_names, class_labels, 1, 0, 5,
+                                             feature_names.size(), 2, 1, 0.0, true, "gini", "best",
+                                             nullptr, false);
+    clf.fit(X, y);
+    decisiontree::DecisionTreeClassifier tree_clf(feature_names, class_labels, 0, 5);
+    tree_clf.fit(X, y);
+
+    EXPECT_EQ(clf.get_tree(0).get_node_count(), tree_clf.get_tree().get_node_count());
+    EXPECT_THAT(clf.predict(X), ::testing::ContainerEq(tree_clf.predict(X)));
+    EXPECT_THAT(clf.predict_proba(X), ::testing::ContainerEq(tree_clf.predict_proba(X)));
+};
+
+TEST(RandomForestClassifierTest, InvalidParamTest) {
+    std::vector<double> X;
+    std::vector<long> y;
+    testdata::make_classification(100, feature_names.size(), 3, X, y, 5);
+
+    decisiontree::RandomForestClassifier clf(feature_names, class_labels);
+    EXPECT_THROW(clf.predict(X), std::runtime_error);
+
+    decisiontree::RandomForestClassifier zero_clf(feature_names, class_labels, 0);
+    EXPECT_THROW(zero_clf.fit(X, y), std::invalid_argument);
+
+    decisiontree::RandomForestClassifier criterion_clf(feature_names, class_labels, 10, 0, 4,
+                                                       -1, 2, 1, 0.0, true, "mse");
+    EXPECT_THROW(criterion_clf.fit(X, y), std::invalid_argument);
+
+    clf.fit(X, y);
+    std::vector<double> wrong_X(100 * (feature_names.size() - 1), 0.0);
+    std::vector<long> labels(100);
+    decisiontree::DataView wrong_view(wrong_X.data(), 100, feature_names.size() - 1);
+    EXPECT_THROW(clf.predict(wrong_view, labels.data()), std::invalid_argument);
+};
+
+} // namespace
@@ -19,4 +19,55 @@ TEST(SortTest, Sort2VectorsByFirstVector){
     EXPECT_THAT(y, ::testing::ContainerEq(expect2));
 }
 
+TEST(SortTest, SortByKeyTest) {
+    // sizes hit insertion sort, comparison sort and radix sort
+    std::mt19937 engine(0);
+    std::uniform_real_distribution<double> uniform(-1e3, 1e3);
+    decisiontree::SortBuffer<double, std::uint32_t> buffer;
+    for (std::size_t size : {0, 1, 7, 32, 100, 255, 256, 5000}) {
+        std::vector<double> keys(size);
+        std::vector<std::uint32_t> indices(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            // rounded keys give many duplicates
+            keys[i] = (i % 3 == 0) ? std::round(uniform(engine)) : uniform(engine);
+            indices[i] = static_cast<std::uint32_t>(i);
+        }
+        std::vector<double> original = keys;
+
+        decisiontree::sort_by_key(keys.data(), indices.data(), size, buffer);
+
+        std::vector<double> expect = original;
+        std::sort(expect.begin(), expect.end());
+        EXPECT_THAT(keys, ::testing::ContainerEq(expect));
+        for (std::size_t i = 0; i < size; ++i) {
+            EXPECT_EQ(original[indices[i]], keys[i]);
+        }
+    }
+}
+
+TEST(SortTest, SortByKeyRangeTest) {
+    // only x[start:end] and y[start:end] are sorted, float keys with 
+    // special values are ordered as by std::sort
+    std::vector<float> x(600);
+    std::vector<std::uint64_t> y(600);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<float>((i * 7919) % 601) - 300.0f;
+        y[i] = i;
+    }
+    x[10] = std::numeric_limits<float>::infinity();
+    x[11] = -std::numeric_limits<float>::infinity();
+    x[12] = std::numeric_limits<float>::denorm_min();
+    std::vector<float> original_x = x;
+
+    decisiontree::SortBuffer<float, std::uint64_t> buffer;
+    decisiontree::sort(x, y, 5, 590, buffer);
+
+    std::vector<float> expect = original_x;
+    std::sort(expect.begin() + 5, expect.begin() + 590);
+    EXPECT_THAT(x, ::testing::ContainerEq(expect));
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        EXPECT_EQ(original_x[y[i]], x[i]);
+    }
+}
+
 }
@@ -117,7 +117,8 @@ TEST_F(SplitterTest, InitNodeTest) {
     EXPECT_THAT(node_weighted_histogram, ::testing::ContainerEq(expect));
     EXPECT_PRED_FORMAT2(DoubleLE, impurity, double(2.0/3.0));
 
-    splitter->split_node(X, y, feature_index, partition_index, partition_threshold, improvement, has_missing_value);
+    decisiontree::DataView X_view(X.data(), num_samples, 4);
+    splitter->split_node(X_view, y, feature_index, partition_index, partition_threshold, improvement, has_missing_value);
     
     std::cout << "feature_index= " << feature_index << std::endl;
     std::cout << "improvement = " << improvement << std::endl;
@@ -127,5 +128,428 @@ TEST_F(SplitterTest, InitNodeTest) {
 
 } 
 
+TEST(HistSplitterTest, SplitNodeTest) {
+    std::vector<std::vector<std::string>> classes = {{"setosa", "versicolor", "virginica"}};
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> X = {5.2, 3.3, 1.2, 0.3,
+                            4.8, 3.1 , 1.6, 0.2,
+                            4.75, 3.1, 1.32, 0.1,
+                            5.9, 2.6, 4.1, 1.2,
+                            5.1, nan, 3.3, 1.1,
+                            5.2, 2.7, 4.1, 1.3,
+                            6.6, 3.1, 5.25, 2.2,
+                            6.3, 2.5, 5.1, 2.0,
+                            6.5, 3.1, 5.2, 2.1};
+    std::vector<long> y = {0, 0, 0, 1, 1, 1, 2, 2, 2};
+
+    std::vector<unsigned long> num_classes_list = calculate_num_classes_list(classes);
+    unsigned long num_outputs = classes.size();
+    unsigned long num_samples = y.size() / num_outputs;
+    unsigned long num_features = 4;
+    unsigned long max_num_classes = 3;
+    std::vector<double>  class_weight = init_class_weight(num_outputs, 
+                                                          num_samples, 
+                                                          max_num_classes,
+                                                          y, 
+                                                          num_classes_list);
+
+    // with fewer distinct values than bins, hist split is the same as best split
+    std::vector<unsigned long> feature_index(2, 0), partition_index(2, 0);
+    std::vector<double> partition_threshold(2, 0.0), improvement(2, 0.0);
+    std::vector<int> has_missing_value(2, -1);
+    std::vector<std::string> split_policy = {"best", "hist"};
+    for (std::size_t k = 0; k < split_policy.size(); ++k) {
+        decisiontree::RandomState random_state(0);
+        decisiontree::Splitter splitter(num_outputs, num_samples, 
+                                        num_features, num_features, 
+                                        max_num_classes, class_weight, 
+                                        num_classes_list, "gini", 
+                                        split_policy[k], random_state);
+        decisiontree::DataView X_view(X.data(), num_samples, num_features);
+        splitter.init_features(X_view);
+        splitter.init_node(y, 0, num_samples);
+        splitter.split_node(X_view, y, 
+                            feature_index[k], 
+                            partition_index[k], 
+                            partition_threshold[k], 
+                            improvement[k], 
+                            has_missing_value[k]);
+    }
+    EXPECT_EQ(feature_index[1], feature_index[0]);
+    EXPECT_EQ(partition_index[1], partition_index[0]);
+    EXPECT_EQ(has_missing_value[1], has_missing_value[0]);
+    EXPECT_DOUBLE_EQ(partition_threshold[1], partition_threshold[0]);
+    EXPECT_DOUBLE_EQ(improvement[1], improvement[0]);
+}
+
+TEST(HistSplitterTest, InitChildrenTest) {
+    std::vector<std::vector<std::string>> classes = {{"setosa", "versicolor", "virginica"}};
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> X = {5.2, 3.3, 1.2, 0.3,
+                            4.8, 3.1 , 1.6, 0.2,
+                            4.75, 3.1, 1.32, 0.1,
+                            5.9, 2.6, 4.1, 1.2,
+                            5.1, nan, 3.3, 1.1,
+                            5.2, 2.7, 4.1, 1.3,
+                            6.6, 3.1, 5.25, 2.2,
+                            6.3, 2.5, 5.1, 2.0,
+                            6.5, 3.1, 5.2, 2.1};
+    std::vector<long> y = {0, 0, 0, 1, 1, 1, 2, 2, 2};
+
+    std::vector<unsigned long> num_classes_list = calculate_num_classes_list(classes);
+    unsigned long num_outputs = classes.size();
+    unsigned long num_samples = y.size() / num_outputs;
+    unsigned long num_features = 4;
+    unsigned long max_num_classes = 3;
+    std::vector<double>  class_weight = init_class_weight(num_outputs, 
+                                                          num_samples, 
+                                                          max_num_classes,
+                                                          y, 
+                                                          num_classes_list);
+    decisiontree::RandomState random_state(0);
+    decisiontree::Splitter splitter(num_outputs, num_samples, 
+                                    num_features, num_features, 
+                                    max_num_classes, class_weight, 
+                                    num_classes_list, "gini", 
+                                    "hist", random_state);
+    decisiontree::DataView X_view(X.data(), num_samples, num_features);
+    splitter.init_features(X_view);
+    splitter.init_node(y, 0, num_samples);
+
+    unsigned long feature_index = 0, partition_index = 0;
+    double partition_threshold = 0.0, improvement = 0.0;
+    int has_missing_value = -1;
+    splitter.split_node(X_view, y, feature_index, partition_index, partition_threshold, improvement, has_missing_value);
+    decisiontree::Splitter::NodeHistograms left_histograms, right_histograms;
+    splitter.init_children(y, partition_index, true, left_histograms, right_histograms);
+
+    // a child initialized from the derived histograms is the child counted from its samples
+    std::vector<std::pair<unsigned long, unsigned long>> ranges = {{0, partition_index}, {partition_index, num_samples}};
+    std::vector<decisiontree::Splitter::NodeHistograms> histograms = {left_histograms, right_histograms};
+    for (std::size_t k = 0; k < ranges.size(); ++k) {
+        std::vector<unsigned long> child_feature_index(2, 0), child_partition_index(2, 0);
+        std::vector<double> child_partition_threshold(2, 0.0), child_improvement(2, 0.0);
+        std::vector<std::vector<std::vector<double>>> child_histogram(2);
+        for (std::size_t derived = 0; derived < 2; ++derived) {
+            if (derived) {
+                splitter.init_node(y, ranges[k].first, ranges[k].second, std::move(histograms[k]));
+            }
+            else {
+                splitter.init_node(y, ranges[k].first, ranges[k].second);
+            }
+            child_histogram[derived] = splitter.criterion_ptr_->get_node_weighted_histogram();
+            if (ranges[k].second - ranges[k].first < 2) {
+                continue;
+            }
+            splitter.set_random_state(decisiontree::RandomState(0));
+            splitter.split_node(X_view, y, 
+                                child_feature_index[derived], 
+                                child_partition_index[derived], 
+                                child_partition_threshold[derived], 
+                                child_improvement[derived], 
+                                has_missing_value);
+        }
+        EXPECT_EQ(child_histogram[1], child_histogram[0]);
+        EXPECT_EQ(child_feature_index[1], child_feature_index[0]);
+        EXPECT_EQ(child_partition_index[1], child_partition_index[0]);
+        EXPECT_DOUBLE_EQ(child_partition_threshold[1], child_partition_threshold[0]);
+        EXPECT_DOUBLE_EQ(child_improvement[1], child_improvement[0]);
+    }
+}
+
+TEST(SplitterWorkspaceTest, SplitNodeTest) {
+    std::vector<std::vector<std::string>> classes = {{"setosa", "versicolor", "virginica"}};
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> X = {5.2, 3.3, 1.2, 0.3,
+                            4.8, 3.1 , 1.6, 0.2,
+                            4.75, 3.1, 1.32, 0.1,
+                            5.9, 2.6, 4.1, 1.2,
+                            5.1, nan, 3.3, 1.1,
+                            5.2, 2.7, 4.1, 1.3,
+                            6.6, 3.1, 5.25, 2.2,
+                            6.3, 2.5, 5.1, 2.0,
+                            6.5, 3.1, 5.2, 2.1};
+    std::vector<long> y = {0, 0, 0, 1, 1, 1, 2, 2, 2};
+
+    std::vector<unsigned long> num_classes_list = calculate_num_classes_list(classes);
+    unsigned long num_outputs = classes.size();
+    unsigned long num_samples = y.size() / num_outputs;
+    unsigned long num_features = 4;
+    unsigned long max_num_classes = 3;
+    std::vector<double>  class_weight = init_class_weight(num_outputs, 
+                                                          num_samples, 
+                                                          max_num_classes,
+                                                          y, 
+                                                          num_classes_list);
+    decisiontree::DataView X_view(X.data(), num_samples, num_features);
+
+    // a child split in the workspace left by its parent is the child 
+    // split by a new splitter on the same sample order
+    std::vector<std::string> split_policy = {"best", "hist"};
+    for (std::size_t k = 0; k < split_policy.size(); ++k) {
+        decisiontree::RandomState random_state(0);
+        decisiontree::Splitter splitter(num_outputs, num_samples, 
+                                        num_features, num_features, 
+                                        max_num_classes, class_weight, 
+                                        num_classes_list, "gini", 
+                                        split_policy[k], random_state);
+        splitter.init_features(X_view);
+        splitter.init_node(y, 0, num_samples);
+
+        unsigned long feature_index = 0, partition_index = 0;
+        double partition_threshold = 0.0, improvement = 0.0;
+        int has_missing_value = -1;
+        splitter.split_node(X_view, y, feature_index, partition_index, partition_threshold, improvement, has_missing_value);
+        ASSERT_GT(num_samples - partition_index, 1);
+
+        decisiontree::Splitter new_splitter(num_outputs, num_samples, 
+                                            num_features, num_features, 
+                                            max_num_classes, class_weight, 
+                                            num_classes_list, "gini", 
+                                            split_policy[k], random_state);
+        new_splitter.set_sample_indices(splitter.get_sample_indices());
+        new_splitter.init_features(X_view);
+
+        std::vector<unsigned long> child_feature_index(2, 0), child_partition_index(2, 0);
+        std::vector<double> child_partition_threshold(2, 0.0), child_improvement(2, 0.0);
+        std::vector<int> child_has_missing_value(2, -1);
+        std::vector<decisiontree::Splitter*> splitters = {&splitter, &new_splitter};
+        for (std::size_t s = 0; s < splitters.size(); ++s) {
+            splitters[s]->set_random_state(decisiontree::RandomState(0));
+            splitters[s]->init_node(y, partition_index, num_samples);
+            splitters[s]->split_node(X_view, y, 
+                                     child_feature_index[s], 
+                                     child_partition_index[s], 
+                                     child_partition_threshold[s], 
+                                     child_improvement[s], 
+                                     child_has_missing_value[s]);
+        }
+        EXPECT_EQ(child_feature_index[1], child_feature_index[0]);
+        EXPECT_EQ(child_partition_index[1], child_partition_index[0]);
+        EXPECT_EQ(child_has_missing_value[1], child_has_missing_value[0]);
+        EXPECT_DOUBLE_EQ(child_partition_threshold[1], child_partition_threshold[0]);
+        EXPECT_DOUBLE_EQ(child_improvement[1], child_improvement[0]);
+        EXPECT_EQ(new_splitter.get_sample_indices(), splitter.get_sample_indices());
+    }
+}
+
+TEST(SplitterWorkspaceTest, SharedFeatureTablesTest) {
+    std::vector<std::vector<std::string>> classes = {{"setosa", "versicolor", "virginica"}};
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> X = {5.2, 3.3, 1.2, 0.3,
+                            4.8, 3.1 , 1.6, 0.2,
+                            4.75, 3.1, 1.32, 0.1,
+                            5.9, 2.6, 4.1, 1.2,
+                            5.1, nan, 3.3, 1.1,
+                            5.2, 2.7, 4.1, 1.3,
+                            6.6, 3.1, 5.25, 2.2,
+                            6.3, 2.5, 5.1, 2.0,
+                            6.5, 3.1, 5.2, 2.1};
+    std::vector<long> y = {0, 0, 0, 1, 1, 1, 2, 2, 2};
+
+    std::vector<unsigned long> num_classes_list = calculate_num_classes_list(classes);
+    unsigned long num_outputs = classes.size();
+    unsigned long num_samples = y.size() / num_outputs;
+    unsigned long num_features = 4;
+    unsigned long max_num_classes = 3;
+    std::vector<double>  class_weight = init_class_weight(num_outputs, 
+                                                          num_samples, 
+                                                          max_num_classes,
+                                                          y, 
+                                                          num_classes_list);
+    decisiontree::DataView X_view(X.data(), num_samples, num_features);
+    std::vector<unsigned long> draws = {8, 0, 3, 3, 5, 0, 6, 4, 3};
+
+    // a copy of a presorted splitter orders its draws by the order of all 
+    // samples computed once, and splits as a splitter sorting nothing
+    std::vector<unsigned long> feature_index(2, 0), partition_index(2, 0);
+    std::vector<double> partition_threshold(2, 0.0), improvement(2, 0.0);
+    std::vector<int> has_missing_value(2, -1);
+    std::vector<std::vector<unsigned long>> sample_indices(2);
+    for (std::size_t k = 0; k < 2; ++k) {
+        decisiontree::RandomState random_state(0);
+        decisiontree::Splitter prototype(num_outputs, num_samples, 
+                                         num_features, num_features, 
+                                         max_num_classes, class_weight, 
+                                         num_classes_list, "gini", 
+                                         "best", random_state, k == 0);
+        prototype.init_feature_tables(X_view);
+        decisiontree::Splitter splitter(prototype);
+        splitter.set_sample_indices(draws);
+        splitter.init_features(X_view);
+        splitter.init_node(y, 0, num_samples);
+        splitter.split_node(X_view, y, 
+                            feature_index[k], 
+                            partition_index[k], 
+                            partition_threshold[k], 
+                            improvement[k], 
+                            has_missing_value[k]);
+        sample_indices[k] = splitter.get_sample_indices();
+        std::sort(sample_indices[k].begin(), sample_indices[k].begin() + partition_index[k]);
+        std::sort(sample_indices[k].begin() + partition_index[k], sample_indices[k].end());
+    }
+    EXPECT_EQ(feature_index[1], feature_index[0]);
+    EXPECT_EQ(partition_index[1], partition_index[0]);
+    EXPECT_EQ(has_missing_value[1], has_missing_value[0]);
+    EXPECT_DOUBLE_EQ(partition_threshold[1], partition_threshold[0]);
+    EXPECT_DOUBLE_EQ(improvement[1], improvement[0]);
+    EXPECT_EQ(sample_indices[1], sample_indices[0]);
+}
+
+TEST(CategoricalSplitterTest, SplitNodeTest) {
+    // the even and the odd categories of x[0] are interleaved, a threshold 
+    // cannot separate them, a set of categories does in one split
+    std::vector<std::vector<std::string>> classes = {{"even", "odd"}};
+    std::vector<double> X;
+    std::vector<long> y;
+    for (unsigned long i = 0; i < 12; ++i) {
+        X.insert(X.end(), {static_cast<double>(i % 6), static_cast<double>(i % 4)});
+        y.push_back(i % 2);
+    }
+
+    std::vector<unsigned long> num_classes_list = calculate_num_classes_list(classes);
+    unsigned long num_outputs = classes.size();
+    unsigned long num_samples = y.size();
+    unsigned long num_features = 2;
+    unsigned long max_num_classes = 2;
+    std::vector<double>  class_weight = init_class_weight(num_outputs, 
+                                                          num_samples, 
+                                                          max_num_classes,
+                                                          y, 
+                                                          num_classes_list);
+
+    for (std::string split_policy : {"best", "hist"}) {
+        decisiontree::RandomState random_state(0);
+        decisiontree::Splitter splitter(num_outputs, num_samples, 
+                                        num_features, num_features, 
+                                        max_num_classes, class_weight, 
+                                        num_classes_list, "gini", 
+                                        split_policy, random_state);
+        EXPECT_THROW(splitter.set_categorical_features({true}), std::invalid_argument);
+        splitter.set_categorical_features({true, false});
+        decisiontree::DataView X_view(X.data(), num_samples, num_features);
+        splitter.init_features(X_view);
+        splitter.init_node(y, 0, num_samples);
+
+        unsigned long feature_index = 0, partition_index = 0;
+        double partition_threshold = 0.0, improvement = 0.0;
+        int has_missing_value = -1;
+        splitter.split_node(X_view, y, 
+                            feature_index, 
+                            partition_index, 
+                            partition_threshold, 
+                            improvement, 
+                            has_missing_value);
+        EXPECT_EQ(feature_index, 0);
+        EXPECT_EQ(partition_index, 6);
+        EXPECT_DOUBLE_EQ(improvement, splitter.criterion_ptr_->get_node_impurity());
+        EXPECT_TRUE(std::isnan(partition_threshold));
+        ASSERT_EQ(splitter.get_split_categories().size(), 1);
+        std::uint64_t categories = splitter.get_split_categories()[0];
+        EXPECT_TRUE(categories == 0x15 || categories == 0x2a);
+
+        // the samples of the left child are those of the left categories
+        const std::vector<unsigned long>& sample_indices = splitter.get_sample_indices();
+        for (unsigned long i = 0; i < num_samples; ++i) {
+            unsigned long category = sample_indices[i] % 6;
+            EXPECT_EQ(i < partition_index, ((categories >> category) & 1) == 1);
+        }
+    }
+}
+
+TEST(HistSplitterTest, DerivedGradientHistogramsTest) {
+    // gradient statistics are sums of doubles, the child derived as node minus 
+    // sibling matches the child counted from its samples up to rounding
+    unsigned long num_samples = 300, num_features = 3;
+    std::mt19937 engine(11);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<double> X(num_samples * num_features), gradients(num_samples), hessians(num_samples);
+    for (unsigned long i = 0; i < num_samples; ++i) {
+        for (unsigned long f = 0; f < num_features; ++f) {
+            X[i * num_features + f] = normal(engine);
+        }
+        gradients[i] = X[i * num_features] + 0.1 * normal(engine);
+        if (uniform(engine) < 0.05) {
+            X[i * num_features + 1] = std::numeric_limits<double>::quiet_NaN();
+        }
+        hessians[i] = 0.01 + 0.24 * uniform(engine);
+    }
+    std::vector<long> y(num_samples, 0);
+
+    std::vector<unsigned long> num_statistics_list = {decisiontree::NUM_GRADIENT_STATISTICS};
+    std::vector<double> class_weight(decisiontree::NUM_GRADIENT_STATISTICS, 1.0);
+    decisiontree::RandomState random_state(0);
+    decisiontree::Splitter splitter(1, num_samples, 
+                                    num_features, num_features, 
+                                    decisiontree::NUM_GRADIENT_STATISTICS, class_weight, 
+                                    num_statistics_list, "gradient", 
+                                    "hist", random_state);
+    splitter.set_gradients(gradients.data(), hessians.data(), 1.0);
+    decisiontree::DataView X_view(X.data(), num_samples, num_features);
+    splitter.init_features(X_view);
+    splitter.init_node(y, 0, num_samples);
+
+    unsigned long feature_index = 0, partition_index = 0;
+    double partition_threshold = 0.0, improvement = 0.0;
+    int has_missing_value = -1;
+    splitter.split_node(X_view, y, feature_index, partition_index, partition_threshold, improvement, has_missing_value);
+    ASSERT_GT(improvement, 0.0);
+    decisiontree::Splitter::NodeHistograms left_histograms, right_histograms;
+    splitter.init_children(y, partition_index, true, left_histograms, right_histograms);
+
+    std::vector<std::pair<unsigned long, unsigned long>> ranges = {{0, partition_index}, {partition_index, num_samples}};
+    std::vector<decisiontree::Splitter::NodeHistograms> histograms = {left_histograms, right_histograms};
+    for (std::size_t k = 0; k < ranges.size(); ++k) {
+        std::vector<decisiontree::Splitter::NodeHistograms> child_histograms(2);
+        std::vector<double> child_improvement(2, 0.0);
+        for (std::size_t derived = 0; derived < 2; ++derived) {
+            if (derived) {
+                splitter.init_node(y, ranges[k].first, ranges[k].second, std::move(histograms[k]));
+            }
+            else {
+                splitter.init_node(y, ranges[k].first, ranges[k].second);
+            }
+            unsigned long child_feature_index = 0, child_partition_index = 0;
+            double child_partition_threshold = 0.0;
+            splitter.split_node(X_view, y, 
+                                child_feature_index, 
+                                child_partition_index, 
+                                child_partition_threshold, 
+                                child_improvement[derived], 
+                                has_missing_value);
+
+            // splitting at the end of the child hands its own histograms to the left
+            decisiontree::Splitter::NodeHistograms empty_histograms;
+            splitter.init_children(y, ranges[k].second, true, child_histograms[derived], empty_histograms);
+        }
+
+        const decisiontree::Splitter::NodeHistograms& counted = child_histograms[0];
+        const decisiontree::Splitter::NodeHistograms& derived = child_histograms[1];
+        ASSERT_EQ(derived.statistics.size(), counted.statistics.size());
+        for (std::size_t i = 0; i < counted.statistics.size(); ++i) {
+            EXPECT_NEAR(derived.statistics[i], counted.statistics[i], 1e-9);
+        }
+        ASSERT_FALSE(counted.bin_histograms.empty());
+        ASSERT_EQ(derived.bin_histograms.size(), counted.bin_histograms.size());
+        for (std::size_t i = 0; i < counted.bin_histograms.size(); ++i) {
+            EXPECT_NEAR(derived.bin_histograms[i], counted.bin_histograms[i], 1e-9);
+        }
+        EXPECT_EQ(derived.bin_num_samples, counted.bin_num_samples);
+        EXPECT_NEAR(child_improvement[1], child_improvement[0], 1e-12);
+    }
+}
+
+TEST(SplitterParamTest, UnknownNameTest) {
+    std::vector<unsigned long> num_classes_list = {2};
+    std::vector<double> class_weight(2, 1.0);
+    decisiontree::RandomState random_state(0);
+    EXPECT_THROW(decisiontree::Splitter(1, 4, 2, 2, 2, class_weight, num_classes_list, 
+                                        "mse", "best", random_state), 
+                 std::invalid_argument);
+    EXPECT_THROW(decisiontree::Splitter(1, 4, 2, 2, 2, class_weight, num_classes_list, 
+                                        "gini", "exact", random_state), 
+                 std::invalid_argument);
+}
 
 } // namespace
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "decision_tree/utility/synthetic_data.hpp"
+
+namespace {
+
+// NaN compares unequal to itself, compare the bits of the values
+bool same_values(const std::vector<double>& x, const std::vector<double>& y) {
+    return x.size() == y.size() && std::memcmp(x.data(), y.data(), x.size() * sizeof(double)) == 0;
+}
+
+TEST(SyntheticDataTest, ChunkTest) {
+    // the rows do not depend on the size of the chunks they are generated in
+    for (std::string kind : {"gaussian_mixture", "xor", "hyperplane"}) {
+        decisiontree::SyntheticDataGenerator generator(1000, 5, 3, 2, kind, 0.1, 0.1, 42);
+        std::vector<double> X;
+        std::vector<long> y;
+        generator.generate(X, y);
+        EXPECT_EQ(generator.get_num_remaining_samples(), 0);
+
+        generator.reset();
+        std::vector<double> chunk_X(X.size());
+        std::vector<long> chunk_y(y.size());
+        unsigned long num_rows = 0, chunk_size = 7;
+        unsigned long num_chunk_rows;
+        while ((num_chunk_rows = generator.generate(chunk_size, &chunk_X[num_rows * 5], &chunk_y[num_rows * 2])) > 0) {
+            num_rows += num_chunk_rows;
+            chunk_size = chunk_size * 2 + 1;
+        }
+        EXPECT_EQ(num_rows, 1000);
+        EXPECT_TRUE(same_values(chunk_X, X)) << kind;
+        EXPECT_THAT(chunk_y, ::testing::ContainerEq(y));
+
+        // labels are in [0, num_classes) and each class is drawn
+        std::vector<unsigned long> counts(3, 0);
+        for (long label : y) {
+            ASSERT_GE(label, 0);
+            ASSERT_LT(label, 3);
+            counts[label]++;
+        }
+        for (unsigned long count : counts) {
+            EXPECT_GT(count, 50) << kind;
+        }
+    }
+}
+
+TEST(SyntheticDataTest, MissingAndDuplicateTest) {
+    unsigned long num_samples = 20000, num_features = 4;
+    decisiontree::SyntheticDataGenerator generator(num_samples, num_features, 2, 1, "hyperplane", 0.2, 0.5, 0);
+    std::vector<double> X;
+    std::vector<long> y;
+    generator.generate(X, y);
+    unsigned long num_missing = 0;
+    for (double value : X) {
+        num_missing += std::isnan(value);
+    }
+    EXPECT_NEAR(static_cast<double>(num_missing) / X.size(), 0.2, 0.01);
+
+    // with a duplicate rate of 1 every feature is constant
+    decisiontree::SyntheticDataGenerator constant_generator(100, num_features, 2, 1, "xor", 0.0, 1.0, 0);
+    constant_generator.generate(X, y);
+    for (unsigned long i = 1; i < 100; ++i) {
+        for (unsigned long f = 0; f < num_features; ++f) {
+            EXPECT_EQ(X[i * num_features + f], X[f]);
+        }
+    }
+}
+
+TEST(SyntheticDataTest, WriteCsvTest) {
+    decisiontree::SyntheticDataGenerator generator(100, 3, 2, 2, "gaussian_mixture", 0.1, 0.0, 0);
+    std::vector<double> X;
+    std::vector<long> y;
+    generator.generate(X, y);
+    generator.reset();
+    std::string path = ::testing::TempDir() + "synthetic_data.csv";
+    generator.write_csv(path, 16);
+
+    std::ifstream is(path);
+    std::string line;
+    std::getline(is, line);
+    EXPECT_EQ(line, "f0,f1,f2,y0,y1");
+    std::vector<double> csv_X;
+    std::vector<long> csv_y;
+    while (std::getline(is, line)) {
+        std::stringstream ss(line);
+        std::string cell;
+        for (unsigned long k = 0; std::getline(ss, cell, ','); ++k) {
+            if (k < 3) {
+                csv_X.push_back(std::strtod(cell.c_str(), nullptr));
+            }
+            else {
+                csv_y.push_back(std::stol(cell));
+            }
+        }
+    }
+    std::remove(path.c_str());
+    EXPECT_TRUE(same_values(csv_X, X));
+    EXPECT_THAT(csv_y, ::testing::ContainerEq(y));
+}
+
+TEST(SyntheticDataTest, UnknownKindTest) {
+    EXPECT_THROW(decisiontree::SyntheticDataGenerator(10, 2, 2, 1, "spiral"), std::invalid_argument);
+    EXPECT_THROW(decisiontree::SyntheticDataGenerator(10, 2, 1, 1), std::invalid_argument);
+    EXPECT_THROW(decisiontree::SyntheticDataGenerator(10, 2, 2, 1, "xor", 1.5), std::invalid_argument);
+}
+
+} // namespace
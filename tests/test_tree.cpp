@@ -67,4 +67,159 @@ TEST_F(TreeTest, AddNodeTest) {
     EXPECT_EQ(node_index, 0);
 };
 
-} // namespace
\ No newline at end of file
+TEST_F(TreeTest, NodeValueTest) {
+    tree_->add_node(false, 0, 0, 2, -1, 2.45, 0.666667, 0.333333, {{3.0, 3.0, 3.0}});
+    tree_->add_node(true, 1, 0, 0, -1, 0.0, 0.0, 0.0, {{3.0, 0.0, 0.0}});
+    tree_->add_node(false, 1, 0, 0, -1, 0.0, 0.5, 0.0, {{0.0, 3.0, 3.0}});
+
+    EXPECT_EQ(tree_->get_node_count(), 3);
+    EXPECT_EQ(tree_->nodes_[0].left_child, 1);
+    EXPECT_EQ(tree_->nodes_[0].right_child, 2);
+    EXPECT_EQ(tree_->values_.size(), 9);
+
+    const HistogramType* value = tree_->get_value(2);
+    std::vector<double> expect = {0.0, 3.0, 3.0};
+    EXPECT_THAT(std::vector<double>(value, value + 3), ::testing::ContainerEq(expect));
+    EXPECT_EQ(tree_->improvements_[0], 0.333333);
+    EXPECT_EQ(tree_->impurities_[2], 0.5);
+
+    // sample with x[2] = 5.0 goes to the right leaf
+    std::vector<double> X = {6.5, 3.1, 5.0, 2.1};
+    std::vector<double> proba;
+    tree_->predict_proba(X, 1, proba);
+    std::vector<double> expect_proba = {0.0, 0.5, 0.5};
+    EXPECT_THAT(proba, ::testing::ContainerEq(expect_proba));
+};
+
+TEST_F(TreeTest, PredictProbaTest) {
+    tree_->add_node(false, 0, 0, 2, -1, 2.45, 0.666667, 0.333333, {{3.0, 3.0, 3.0}});
+    tree_->add_node(true, 1, 0, 0, -1, 0.0, 0.0, 0.0, {{3.0, 0.0, 0.0}});
+    tree_->add_node(false, 1, 0, 3, 1, 1.5, 0.5, 0.25, {{0.0, 3.0, 3.0}});
+    tree_->add_node(true, 2, 2, 0, -1, 0.0, 0.0, 0.0, {{0.0, 3.0, 0.0}});
+    tree_->add_node(false, 2, 2, 0, -1, 0.0, 0.0, 0.0, {{0.0, 0.0, 3.0}});
+
+    // missing x[2] goes down both children weighted by 3 / 9 and 6 / 9, 
+    // missing x[3] goes to the right child
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<std::vector<double>> samples = {{5.2, 3.3, 1.2, 0.3}, 
+                                                {5.9, 2.6, 4.1, 1.2}, 
+                                                {6.6, 3.1, 5.25, nan}, 
+                                                {5.9, 2.6, nan, 1.2}};
+    std::vector<std::vector<double>> expect_probas = {{1.0, 0.0, 0.0}, 
+                                                      {0.0, 1.0, 0.0}, 
+                                                      {0.0, 0.0, 1.0}, 
+                                                      {1.0 / 3.0, 2.0 / 3.0, 0.0}};
+
+    // a batch of several blocks, predicted with 1 and 4 threads
+    unsigned long num_samples = 1000;
+    std::vector<double> X;
+    std::vector<double> expect;
+    for (unsigned long i = 0; i < num_samples; ++i) {
+        X.insert(X.end(), samples[i % 4].begin(), samples[i % 4].end());
+        expect.insert(expect.end(), expect_probas[i % 4].begin(), expect_probas[i % 4].end());
+    }
+
+    decisiontree::ThreadPool thread_pool(4);
+    for (decisiontree::ThreadPool* pool : {static_cast<decisiontree::ThreadPool*>(nullptr), &thread_pool}) {
+        std::vector<double> proba;
+        tree_->predict_proba(X, num_samples, proba, pool);
+        ASSERT_EQ(proba.size(), expect.size());
+        for (unsigned long k = 0; k < expect.size(); ++k) {
+            EXPECT_NEAR(proba[k], expect[k], 1e-12);
+        }
+    }
+};
+
+TEST_F(TreeTest, BlockValuesTest) {
+    tree_->add_node(false, 0, 0, 2, -1, 2.45, 0.666667, 0.333333, {{3.0, 3.0, 3.0}});
+    tree_->add_node(true, 1, 0, 0, -1, 0.0, 0.0, 0.0, {{3.0, 0.0, 0.0}});
+    tree_->add_node(false, 1, 0, 3, 1, 1.5, 0.5, 0.25, {{0.0, 3.0, 3.0}});
+    tree_->add_node(true, 2, 2, 0, -1, 0.0, 0.0, 0.0, {{0.0, 3.0, 0.0}});
+    tree_->add_node(false, 2, 2, 0, -1, 0.0, 0.0, 0.0, {{0.0, 0.0, 3.0}});
+
+    // the samples of PredictProbaTest reach the leaves 1, 3, 4 and both 1 and 3
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> X = {5.2, 3.3, 1.2, 0.3, 
+                             5.9, 2.6, 4.1, 1.2, 
+                             6.6, 3.1, 5.25, nan, 
+                             5.9, 2.6, nan, 1.2};
+    decisiontree::DataView view(X.data(), 4, 4);
+    std::vector<double> node_values = {0.0, 10.0, 0.0, 30.0, 40.0};
+
+    // the values are added to every other entry, a sample going down both 
+    // children is weighted by 3 / 9 and 6 / 9 as for the probabilities
+    std::vector<double> values(8, 1.0);
+    tree_->get_view().add_block_values(view, 0, 4, node_values.data(), values.data(), 2);
+    std::vector<double> expect = {11.0, 1.0, 31.0, 1.0, 41.0, 1.0, 1.0 + 10.0 / 3.0 + 20.0, 1.0};
+    for (unsigned long k = 0; k < expect.size(); ++k) {
+        EXPECT_NEAR(values[k], expect[k], 1e-12);
+    }
+
+    // or by the weights of the nodes if given
+    std::vector<double> node_weights = {4.0, 1.0, 3.0, 3.0, 0.0};
+    std::vector<double> weighted_values(4, 0.0);
+    tree_->get_view().add_block_values(view, 0, 4, node_values.data(), weighted_values.data(), 1, node_weights.data());
+    std::vector<double> weighted_expect = {10.0, 30.0, 40.0, 10.0 / 4.0 + 30.0 * 3.0 / 4.0};
+    for (unsigned long k = 0; k < weighted_expect.size(); ++k) {
+        EXPECT_NEAR(weighted_values[k], weighted_expect[k], 1e-12);
+    }
+};
+
+TEST_F(TreeTest, CategoricalPredictTest) {
+    // categories {1, 3, 70} of x[1] go to the left child, missing x[1] goes right
+    std::vector<std::uint64_t> categories = {(1ul << 1) | (1ul << 3), 1ul << (70 - 64)};
+    tree_->add_node(false, 0, 0, 1, 1, 0.0, 0.666667, 0.333333, {{3.0, 0.0, 3.0}}, categories);
+    tree_->add_node(true, 1, 0, 0, -1, 0.0, 0.0, 0.0, {{3.0, 0.0, 0.0}});
+    tree_->add_node(false, 1, 0, 0, -1, 0.0, 0.0, 0.0, {{0.0, 0.0, 3.0}});
+
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> values = {1.0, 3.0, 70.0, 0.0, 2.0, 64.0, 200.0, -1.0, nan};
+    std::vector<long> expect = {0, 0, 0, 2, 2, 2, 2, 2, 2};
+    std::vector<double> X;
+    for (double value : values) {
+        X.insert(X.end(), {5.0, value, 1.0, 0.5});
+    }
+    std::vector<long> labels(values.size(), -1);
+    tree_->predict(X.data(), values.size(), labels.data());
+    EXPECT_THAT(labels, ::testing::ContainerEq(expect));
+};
+
+TEST_F(TreeTest, ConcurrentPredictTest) {
+    tree_->add_node(false, 0, 0, 2, -1, 2.45, 0.666667, 0.333333, {{3.0, 3.0, 3.0}});
+    tree_->add_node(true, 1, 0, 0, -1, 0.0, 0.0, 0.0, {{3.0, 0.0, 0.0}});
+    tree_->add_node(false, 1, 0, 3, -1, 1.5, 0.5, 0.25, {{0.0, 3.0, 3.0}});
+    tree_->add_node(true, 2, 2, 0, -1, 0.0, 0.0, 0.0, {{0.0, 3.0, 0.0}});
+    tree_->add_node(false, 2, 2, 0, -1, 0.0, 0.0, 0.0, {{0.0, 0.0, 3.0}});
+
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<std::vector<double>> samples = {{5.2, 3.3, 1.2, 0.3}, 
+                                                {5.9, 2.6, 4.1, 1.2}, 
+                                                {6.6, 3.1, 5.25, 2.2}, 
+                                                {5.9, 2.6, nan, 1.2}};
+    std::vector<long> expect_labels = {0, 1, 2, 1};
+    unsigned long num_samples = 500;
+    std::vector<double> X;
+    std::vector<long> expect;
+    for (unsigned long i = 0; i < num_samples; ++i) {
+        X.insert(X.end(), samples[i % 4].begin(), samples[i % 4].end());
+        expect.push_back(expect_labels[i % 4]);
+    }
+
+    // threads share the const tree, each writes into a buffer of its own
+    const decisiontree::Tree& tree = *tree_;
+    std::vector<std::vector<long>> labels(4, std::vector<long>(num_samples, -1));
+    std::vector<std::thread> threads;
+    for (unsigned long t = 0; t < labels.size(); ++t) {
+        threads.emplace_back([&tree, &X, &labels, num_samples, t] {
+            tree.predict(X.data(), num_samples, labels[t].data());
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& label : labels) {
+        EXPECT_THAT(label, ::testing::ContainerEq(expect));
+    }
+};
+
+} // namespace